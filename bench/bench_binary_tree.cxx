@@ -0,0 +1,98 @@
+#include <iostream>
+#include "bench_util.h"
+#include "binary_tree.h"
+
+int main(int argc, char** argv)
+{
+  bench_util::init("binary_tree", argc, argv);
+  bench_util::rng gen;
+
+  // Level-order insertion of binary_tree is linear per insert.
+  const size_t bt_cap = 10000;
+  // Search trees allocate a node per value, which bounds the input size.
+  const size_t st_cap = 1000000;
+
+  for (size_t n = bench_util::first(); n; n = bench_util::next(n)) {
+    dyn_array<int> vals(0, n);
+    for (size_t i = 0; i < n; ++i)
+      vals[i] = static_cast<int>(gen.below(1000000000));
+    size_t found = 0;
+
+    if (!bench_util::skip("binary_tree<int, 0>", n, bt_cap)) {
+      binary_tree<int, false>* bt = nullptr;
+      bench_util::run("binary_tree<int, 0>::insert", n, n,
+        [&]() {delete bt; bt = binary_tree<int, false>::STANDARD(vals[0]);},
+        [&]() {
+          for (size_t i = 1; i < n; ++i)
+            bt->insert(vals[i]);
+        });
+      bench_util::run("binary_tree<int, 0>::search", n, n,
+        [&]() {found = 0;},
+        [&]() {
+          for (size_t i = 0; i < n; ++i)
+            found += bt->search(vals[i]) != nullptr;
+        });
+      bench_util::keep(found);
+      delete bt;
+    }
+
+    if (bench_util::skip("search trees", n, st_cap))
+      continue;
+
+    binary_search_tree<int, false>* bst = nullptr;
+    bench_util::run("binary_search_tree<int, 0>::insert", n, n,
+      [&]() {delete bst; bst = binary_tree<int, false>::SEARCH(vals[0]);},
+      [&]() {
+        for (size_t i = 1; i < n; ++i)
+          bst->insert(vals[i]);
+      });
+    bench_util::run("binary_search_tree<int, 0>::search", n, n,
+      [&]() {found = 0;},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          found += bst->search(vals[i]) != nullptr;
+      });
+    bench_util::keep(found);
+    delete bst;
+
+    avl_tree<int, false>* avl = nullptr;
+    bench_util::run("avl_tree<int, 0>::insert", n, n,
+      [&]() {delete avl; avl = binary_tree<int, false>::AVL(vals[0]);},
+      [&]() {
+        for (size_t i = 1; i < n; ++i)
+          avl = avl->insert(vals[i]);
+      });
+    bench_util::run("avl_tree<int, 0>::search", n, n,
+      [&]() {found = 0;},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          found += avl->search(vals[i]) != nullptr;
+      });
+    bench_util::keep(found);
+    delete avl;
+
+    red_black_tree<int>* rb = nullptr;
+    bench_util::run("red_black_tree<int>::insert", n, n,
+      [&]() {delete rb; rb = binary_tree<int, true>::RED_BLACK(vals[0]);},
+      [&]() {
+        for (size_t i = 1; i < n; ++i)
+          rb = rb->insert(vals[i]);
+      });
+    bench_util::run("red_black_tree<int>::search", n, n,
+      [&]() {found = 0;},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          found += rb->search(vals[i]) != nullptr;
+      });
+    bench_util::keep(found);
+    // Walks every adjacency list, which graph_node keeps inline.
+    bench_util::run("red_black_tree<int>::breadth_first_traverse", n, n,
+      [&]() {found = 0;},
+      [&]() {found += rb->breadth_first_traverse().size();});
+    bench_util::keep(found);
+    delete rb;
+  }
+
+  bench_util::print_summary();
+  return 0;
+}
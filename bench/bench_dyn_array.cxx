@@ -0,0 +1,376 @@
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "dyn_array.h"
+#include "dyn_view.h"
+#include "mapped_array.h"
+
+// Builds n rows of 8 integers and returns them by value, the way traversals
+// and permutations hand over their results.
+dyn_array<dyn_array<int> > make_rows(size_t n)
+{
+  dyn_array<dyn_array<int> > rows;
+  for (size_t i = 0; i < n; ++i)
+    rows.emplace(static_cast<int>(i), 8);
+  return rows;
+}
+
+int main(int argc, char** argv)
+{
+  bench_util::init("dyn_array", argc, argv);
+  bench_util::rng gen;
+  std::vector<thread_pool*> pools;
+  size_t hw = std::thread::hardware_concurrency();
+  for (size_t t = 1; t < 2 * hw; t *= 2)
+    pools.push_back(new thread_pool(t < hw ? t : hw));
+  if (pools.empty())
+    pools.push_back(new thread_pool(1));
+  std::cout << "Hardware threads: " << hw << std::endl;
+
+  for (size_t n = bench_util::first(); n; n = bench_util::next(n)) {
+    dyn_array<int> arr;
+    bench_util::run("dyn_array<int>::add", n, n,
+      [&]() {arr.clear();},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          arr.add(static_cast<int>(i));
+      });
+    bench_util::keep(arr.size());
+
+    dyn_array<int> src(0, n);
+    for (size_t i = 0; i < n; ++i)
+      src[i] = static_cast<int>(gen.below(1000000000));
+
+    dyn_array<int> buf;
+    bench_util::run("dyn_array<int>::quick_sort", n, n,
+      [&]() {buf = src;},
+      [&]() {buf.quick_sort();});
+    bench_util::keep(buf[0]);
+
+    bench_util::run("dyn_array<int>::intro_sort", n, n,
+      [&]() {buf = src;},
+      [&]() {buf.intro_sort();});
+    bench_util::keep(buf[0]);
+
+    bench_util::run("dyn_array<int>::merge_sort", n, n,
+      [&]() {buf = src;},
+      [&]() {buf.merge_sort();});
+    bench_util::keep(buf[0]);
+
+    dyn_array<int> out;
+    bench_util::run("dyn_array<int>::radix_sort", n, n,
+      [&]() {buf = src;},
+      [&]() {out = buf.radix_sort();});
+    bench_util::keep(out[0]);
+
+    dyn_array<double> dsrc(0.0, n);
+    for (size_t i = 0; i < n; ++i)
+      dsrc[i] = static_cast<double>(gen.below(1000000000)) / 7.0;
+    dyn_array<double> dbuf;
+    bench_util::run("dyn_array<double>::quick_sort", n, n,
+      [&]() {dbuf = dsrc;},
+      [&]() {dbuf.quick_sort();});
+    bench_util::keep(dbuf[0]);
+    dyn_array<double> dout;
+    bench_util::run("dyn_array<double>::radix_sort", n, n,
+      [&]() {dbuf = dsrc;},
+      [&]() {dout = dbuf.radix_sort();});
+    bench_util::keep(dout[0]);
+
+    // Inputs that defeat quicksort pivots, or that they handle poorly. Middle
+    // pivots make quick_sort quadratic on the organ pipe, so it is capped.
+    const char* shapes[] = {"sorted", "reversed", "all equal", "organ pipe",
+                            "sawtooth", "few distinct"};
+    for (int shape = 0; shape < 6; ++shape) {
+      dyn_array<int> adv(0, n);
+      for (size_t i = 0; i < n; ++i) {
+        int vals[] = {static_cast<int>(i), static_cast<int>(n - i), 5,
+                      static_cast<int>(i < n / 2 ? i : n - i),
+                      static_cast<int>(i % 1000), src[i] % 4};
+        adv[i] = vals[shape];
+      }
+      std::string on = std::string(" ") + shapes[shape];
+      size_t cap = shape == 3 ? 100000 : n;
+      if (!bench_util::skip("dyn_array<int>::quick_sort" + on, n, cap)) {
+        bench_util::run("dyn_array<int>::quick_sort" + on, n, n,
+          [&]() {buf = adv;},
+          [&]() {buf.quick_sort();});
+        bench_util::keep(buf[0]);
+      }
+      bench_util::run("dyn_array<int>::intro_sort" + on, n, n,
+        [&]() {buf = adv;},
+        [&]() {buf.intro_sort();});
+      bench_util::keep(buf[0]);
+    }
+
+    // Parallel sorts run on pools of every power-of-two size up to the
+    // number of hardware threads.
+    for (size_t t = 0; t < pools.size(); ++t) {
+      thread_pool* pool = pools[t];
+      std::string on = " " + std::to_string(pool->size()) + " threads";
+      bench_util::run("dyn_array<int>::par_merge_sort" + on, n, n,
+        [&]() {buf = src;},
+        [&]() {buf.par_merge_sort(true, pool);});
+      bench_util::keep(buf[0]);
+      bench_util::run("dyn_array<int>::sample_sort" + on, n, n,
+        [&]() {buf = src;},
+        [&]() {buf.sample_sort(true, pool);});
+      bench_util::keep(buf[0]);
+      bench_util::run("dyn_array<int>::par_radix_sort" + on, n, n,
+        [&]() {buf = src;},
+        [&]() {out = buf.par_radix_sort(true, pool);});
+      bench_util::keep(out[0]);
+      bench_util::run("dyn_array<double>::sample_sort" + on, n, n,
+        [&]() {dbuf = dsrc;},
+        [&]() {dbuf.sample_sort(true, pool);});
+      bench_util::keep(dbuf[0]);
+    }
+
+    // Strings are longer than any small string buffer, so every copy of one
+    // allocates, while moves and growth of the array don't.
+    const std::string word(40, 'w');
+    dyn_array<std::string> strs;
+    bench_util::run("dyn_array<string>::add copy", n, n,
+      [&]() {strs.clear();},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          strs.add(word);
+      });
+    bench_util::keep(strs.size());
+
+    dyn_array<std::string> pool;
+    bench_util::run("dyn_array<string>::add move", n, n,
+      [&]() {strs.clear(); pool = dyn_array<std::string>(word, n);},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          strs.add(std::move(pool[i]));
+      });
+    bench_util::keep(strs.size());
+
+    bench_util::run("dyn_array<string>::emplace", n, n,
+      [&]() {strs.clear();},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          strs.emplace(40, 'w');
+      });
+    bench_util::keep(strs.size());
+
+    dyn_array<std::string> strs2;
+    bench_util::run("dyn_array<string> move assign", n, 1,
+      [&]() {strs2.clear();},
+      [&]() {strs2 = std::move(strs);});
+    bench_util::keep(strs2.size());
+
+    dyn_array<dyn_array<int> > rows;
+    dyn_array<int> row(1, 8);
+    bench_util::run("dyn_array<dyn_array<int>>::add copy", n, n,
+      [&]() {rows.clear();},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          rows.add(row);
+      });
+    bench_util::keep(rows.size());
+
+    bench_util::run("dyn_array<dyn_array<int>> return", n, n,
+      [&]() {rows.clear();},
+      [&]() {rows = make_rows(n);});
+    bench_util::keep(rows.size());
+
+    // Linear scans run once per instruction set the machine supports. The
+    // searched value is missing, so every search scans the whole array.
+    dyn_array<float> fsrc(0.0f, n);
+    for (size_t i = 0; i < n; ++i)
+      fsrc[i] = static_cast<float>(gen.below(1000000)) / 8.0f;
+    dyn_array<float> fcopy = fsrc;
+    const char* levels[] = {"scalar", "SSE2", "AVX2"};
+    for (int lvl = simd::SCALAR; lvl <= simd::detect(); ++lvl) {
+      simd::limit(static_cast<simd::Level>(lvl));
+      std::string on = std::string(" [") + levels[lvl] + "]";
+      size_t hits = 0;
+      bench_util::run("dyn_array<float>::search" + on, n, n,
+        [&]() {hits = 0;},
+        [&]() {hits += fsrc.search(-1.0f).size();});
+      bench_util::keep(hits);
+      float ext = 0.0f;
+      bench_util::run("dyn_array<float>::min" + on, n, n,
+        [&]() {ext = 0.0f;},
+        [&]() {ext += fsrc.min();});
+      bench_util::keep(ext);
+      bench_util::run("dyn_array<float>::max" + on, n, n,
+        [&]() {ext = 0.0f;},
+        [&]() {ext += fsrc.max();});
+      bench_util::keep(ext);
+      bench_util::run("dyn_array<float>::operator ==" + on, n, n,
+        [&]() {hits = 0;},
+        [&]() {hits += fsrc == fcopy;});
+      bench_util::keep(hits);
+    }
+    simd::limit(simd::AVX2);
+
+    // Deduplication passes over ids, a tenth of which are distinct. The
+    // values are hashed unless the array is sorted.
+    dyn_array<long long> idsrc(0, n);
+    for (size_t i = 0; i < n; ++i)
+      idsrc[i] = static_cast<long long>(gen.below(n / 10 + 1) * 2654435761ULL);
+    dyn_array<long long> idbuf;
+    size_t uniq = 0;
+    bench_util::run("dyn_array<long long>::unique", n, n,
+      [&]() {uniq = 0;},
+      [&]() {uniq += idsrc.unique().size();});
+    bench_util::keep(uniq);
+    bench_util::run("dyn_array<long long>::unique_cnt", n, n,
+      [&]() {idbuf = idsrc;},
+      [&]() {uniq += idbuf.unique_cnt().size();});
+    bench_util::keep(uniq);
+    dyn_array<long long> idsorted = idsrc.radix_sort();
+    bench_util::run("dyn_array<long long>::unique_cnt sorted", n, n,
+      [&]() {idbuf = idsorted;},
+      [&]() {uniq += idbuf.unique_cnt().size();});
+    bench_util::keep(uniq);
+
+    // File-backed arrays, against the heap arrays above. Every repetition
+    // starts from a new file, which grows by remapping.
+    const char* map_path = "bench_dyn_array_mapped.bin";
+    std::unique_ptr<mapped_array<long long> > mids;
+    bench_util::run("mapped_array<long long>::add", n, n,
+      [&]() {
+        mids.reset();
+        std::remove(map_path);
+        mids.reset(new mapped_array<long long>(map_path));
+      },
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          mids->add(idsrc[i]);
+      });
+    bench_util::keep(mids->size());
+    bench_util::run("mapped_array<long long>::intro_sort", n, n,
+      [&]() {*mids = idsrc;},
+      [&]() {mids->advise(file_map::SEQUENTIAL).intro_sort();});
+    bench_util::keep(mids->size());
+    // Reopening a sorted file binary searches it without sorting again.
+    mids.reset();
+    mapped_array<long long> reopened(map_path);
+    size_t found = 0;
+    reopened.advise(file_map::RANDOM);
+    bench_util::run("mapped_array<long long>::search reopened", n, n,
+      [&]() {found = 0;},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          found += reopened.search(idsrc[i]).size();
+      });
+    bench_util::keep(found);
+    reopened.clear();
+    std::remove(map_path);
+
+    // Cold starts, rebuilding arrays from text against binary loads. Views
+    // only check the header, or the row offsets of nested arrays.
+    std::string text;
+    bench_util::run("dyn_array<long long> text write", n, n,
+      [&]() {text.clear();},
+      [&]() {
+        std::ostringstream os;
+        os << idsrc;
+        text = os.str();
+      });
+    dyn_array<long long> loaded;
+    bench_util::run("dyn_array<long long> text read", n, n,
+      [&]() {loaded.clear();},
+      [&]() {
+        std::istringstream is(text);
+        long long v;
+        while (is >> v)
+          loaded.add(v);
+      });
+    bench_util::keep(loaded.size());
+    std::string bin;
+    bench_util::run("dyn_array<long long>::serialize", n, n,
+      [&]() {bin.clear();},
+      [&]() {
+        std::ostringstream os;
+        idsrc.serialize(os);
+        bin = os.str();
+      });
+    bench_util::run("dyn_array<long long>::deserialize", n, n,
+      [&]() {loaded.clear();},
+      [&]() {
+        std::istringstream is(bin);
+        loaded.deserialize(is);
+      });
+    bench_util::keep(loaded.size());
+    dyn_array<std::uint64_t> words(0, bin.size() / 8 + 1);
+    std::memcpy(&words[0], bin.data(), bin.size());
+    dyn_view<long long> view;
+    bench_util::run("dyn_view<long long>::load", n, n,
+      [&]() {view = dyn_view<long long>();},
+      [&]() {view.load(&words[0], bin.size());});
+    bench_util::keep(view.size());
+
+    std::ostringstream rows_os;
+    make_rows(n).serialize(rows_os);
+    std::string rows_bin = rows_os.str();
+    dyn_array<dyn_array<int> > rows_loaded;
+    bench_util::run("dyn_array<dyn_array<int>>::deserialize", n, n,
+      [&]() {rows_loaded.clear();},
+      [&]() {
+        std::istringstream is(rows_bin);
+        rows_loaded.deserialize(is);
+      });
+    bench_util::keep(rows_loaded.size());
+    dyn_array<std::uint64_t> rows_words(0, rows_bin.size() / 8 + 1);
+    std::memcpy(&rows_words[0], rows_bin.data(), rows_bin.size());
+    dyn_view<dyn_array<int> > rows_view;
+    bench_util::run("dyn_view<dyn_array<int>>::load", n, n,
+      [&]() {rows_view = dyn_view<dyn_array<int> >();},
+      [&]() {rows_view.load(&rows_words[0], rows_bin.size());});
+    bench_util::keep(rows_view.size());
+
+    // Permutations of the k elements with the largest k! that fits in n, one
+    // operation per permutation.
+    size_t pk = 1, pn = 1;
+    while (pn * (pk + 1) <= n)
+      pn *= ++pk;
+    dyn_array<char> pvals(0, pk);
+    for (size_t i = 0; i < pk; ++i)
+      pvals[i] = static_cast<char>(i);
+    dyn_array<dyn_array<char> > pall;
+    bench_util::run("dyn_array<char>::permutations", n, pn,
+      [&]() {pall.clear();},
+      [&]() {pall = pvals.permutations();});
+    bench_util::keep(pall.size());
+    long long psum = 0;
+    bench_util::run("perm_gen<char>::next", n, pn,
+      [&]() {psum = 0;},
+      [&]() {
+        perm_gen<char> gen_perm(pvals);
+        while (gen_perm.next())
+          psum += gen_perm.current()[0];
+      });
+    bench_util::keep(psum);
+    for (size_t t = 0; t < pools.size(); ++t) {
+      thread_pool* pool = pools[t];
+      std::string on = " " + std::to_string(pool->size()) + " threads";
+      std::atomic<long long> pcnt(0);
+      bench_util::run("dyn_array<char>::par_permutations" + on, n, pn,
+        [&]() {pcnt = 0;},
+        [&]() {
+          pvals.par_permutations([&](const dyn_array<char>& perm) {
+            if (perm[0] == 0)
+              pcnt++;
+            return true;
+          }, pool);
+        });
+      bench_util::keep(pcnt.load());
+    }
+  }
+
+  for (size_t t = 0; t < pools.size(); ++t)
+    delete pools[t];
+  bench_util::print_summary();
+  return 0;
+}
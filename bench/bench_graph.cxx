@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <iostream>
+#include "bench_util.h"
+#include "csr_graph.h"
+#include "graph.h"
+
+int main(int argc, char** argv)
+{
+  bench_util::init("graph", argc, argv);
+  bench_util::rng gen;
+
+  // Dense N x N edge matrix makes larger graphs impractical to construct.
+  const size_t cap = 10000;
+  // Sparse edge storage is only limited by per-node allocations.
+  const size_t sparse_cap = 1000000;
+  // Average number of outgoing edges per node.
+  const size_t deg = 4;
+
+  for (size_t n = bench_util::first(); n; n = bench_util::next(n)) {
+    // Chain all nodes to keep the graph connected, then add random edges.
+    // Both directions of every undirected edge go into the edge list.
+    dyn_array<size_t> from, to;
+    dyn_array<int> weights;
+    for (size_t e = 0; e < n * deg / 2; ++e) {
+      size_t i = (e + 1 < n) ? e : gen.below(n);
+      size_t j = (e + 1 < n) ? e + 1 : gen.below(n);
+      int w = 1 + static_cast<int>(gen.below(100));
+      if (i == j)
+        continue;
+      from.add(i).add(j);
+      to.add(j).add(i);
+      weights.add(w).add(w);
+    }
+
+    if (!bench_util::skip("graph<int>", n, cap)) {
+      bench_util::run("graph<int>::add_node", n, n,
+        [&]() {
+          graph<int> h;
+          for (size_t i = 0; i < n; ++i)
+            h.add_node(0);
+          bench_util::keep(h.size());
+        });
+
+      graph<int> g(dyn_array<int>(0, n));
+      for (size_t e = 0; e < from.size(); e += 2)
+        g.add_edgew_undir(from[e], to[e], weights[e]);
+
+      dyn_array<int> dists;
+      bench_util::run("graph<int>::shortest_dists", n, n,
+        [&]() {dists = g.shortest_dists(0);});
+      bench_util::keep(dists[n-1]);
+
+      dyn_array<dyn_array<int> > paths;
+      bench_util::run("graph<int>::dijkstra", n, n,
+        [&]() {paths = g.dijkstra(0);});
+      bench_util::keep(paths[n-1].size());
+
+      dyn_array<size_t> order;
+      bench_util::run("graph<int>::breadth_first_traverse", n, n,
+        [&]() {order = g.breadth_first_traverse(0);});
+      bench_util::keep(order.size());
+
+      // Keeping only edges towards higher indices makes the graph acyclic.
+      graph<int> dag(dyn_array<int>(0, n));
+      for (size_t e = 0; e < from.size(); e += 2)
+        dag.add_edge(std::min(from[e], to[e]), std::max(from[e], to[e]));
+
+      bool cyc = false;
+      bench_util::run("graph<int>(DAG)::has_cycle", n, n,
+        [&]() {cyc = dag.has_cycle();});
+      bench_util::keep(cyc);
+
+      dyn_array<int> sorted;
+      bench_util::run("graph<int>(DAG)::topological_sort", n, n,
+        [&]() {sorted = dag.topological_sort();});
+      bench_util::keep(sorted.size());
+
+      bench_util::run("graph<int>::depth_first_traverse", n, n,
+        [&]() {order = g.depth_first_traverse(0);});
+      bench_util::keep(order.size());
+
+      dyn_array<int> labels;
+      bench_util::run("graph<int>::weakly_conn_comp", n, n,
+        [&]() {labels = g.weakly_conn_comp();});
+      bench_util::keep(labels[n-1]);
+
+      bench_util::run("csr_graph<int> from graph<int>", n, n,
+        [&]() {bench_util::keep(csr_graph<int>(g).num_edges());});
+    }
+
+    if (!bench_util::skip("graph<int>(sparse)", n, sparse_cap)) {
+      bench_util::run("graph<int>(sparse)::add_node", n, n,
+        [&]() {
+          graph<int> h(EdgeStorage::SPARSE);
+          for (size_t i = 0; i < n; ++i)
+            h.add_node(0);
+          bench_util::keep(h.size());
+        });
+
+      graph<int> g(dyn_array<int>(0, n), EdgeStorage::SPARSE);
+      bench_util::run("graph<int>(sparse)::add_edgew_undir", n,
+        from.size() / 2,
+        [&]() {g.clear_edges();},
+        [&]() {
+          for (size_t e = 0; e < from.size(); e += 2)
+            g.add_edgew_undir(from[e], to[e], weights[e]);
+        });
+      bench_util::keep(g.num_edges());
+
+      dyn_array<int> dists;
+      bench_util::run("graph<int>(sparse)::shortest_dists", n, n,
+        [&]() {dists = g.shortest_dists(0);});
+      bench_util::keep(dists[n-1]);
+
+      dyn_array<size_t> order;
+      bench_util::run("graph<int>(sparse)::breadth_first_traverse", n, n,
+        [&]() {order = g.breadth_first_traverse(0);});
+      bench_util::keep(order.size());
+
+      dyn_array<dyn_array<int> > levels;
+      bench_util::run("graph<int>(sparse)::par_breadth_first", n, n,
+        [&]() {levels = g.par_breadth_first(0);});
+      bench_util::keep(levels[0][n-1]);
+    }
+
+    // Same edges in CSR form, which scales past the dense matrix cap.
+    csr_graph<int> csr;
+    bench_util::run("csr_graph<int> from edge list", n, n,
+      [&]() {csr = csr_graph<int>(dyn_array<int>(0, n), from, to, weights);});
+    bench_util::keep(csr.num_edges());
+
+    dyn_array<int> dists;
+    bench_util::run("csr_graph<int>::shortest_dists", n, n,
+      [&]() {dists = csr.shortest_dists(0);});
+    bench_util::keep(dists[n-1]);
+
+    dyn_array<size_t> order;
+    bench_util::run("csr_graph<int>::breadth_first_traverse", n, n,
+      [&]() {order = csr.breadth_first_traverse(0);});
+    bench_util::keep(order.size());
+
+    bench_util::run("csr_graph<int>::depth_first_traverse", n, n,
+      [&]() {order = csr.depth_first_traverse(0);});
+    bench_util::keep(order.size());
+
+    dyn_array<int> labels;
+    bench_util::run("csr_graph<int>::weakly_conn_comp", n, n,
+      [&]() {labels = csr.weakly_conn_comp();});
+    bench_util::keep(labels[n-1]);
+
+    dyn_array<dyn_array<size_t> > comps;
+    bench_util::run("csr_graph<int>::strongly_conn_comp", n, n,
+      [&]() {comps = csr.strongly_conn_comp();});
+    bench_util::keep(comps.size());
+  }
+
+  bench_util::print_summary();
+  return 0;
+}
@@ -0,0 +1,167 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <cstdint>
+#include "bench_util.h"
+#include "hash_table.h"
+#include "binary_tree.h"
+
+// Hash value of a container computed the way hash_fn used to: by streaming
+// the container into a string and running the rolling polynomial over it.
+template <class K>
+size_t stream_hash(const K& key, size_t size)
+{
+  std::stringstream ss;
+  ss << key;
+  return hash_fn<std::string>::poly_roll(ss.str(), size);
+}
+
+// Prints how evenly hash values of the keys fill a power-of-two table that
+// indexes buckets with their low bits, as open_hash_table-like tables do.
+// Reports the largest bucket and the chi-squared statistic divided by its
+// expected value, which is close to 1 for a uniformly distributing hash.
+template <class K>
+void distribution(const std::string& name, const hash_fn<K>& hash,
+                  const dyn_array<K>& keys)
+{
+  size_t buckets = 1;
+  while (buckets < keys.size())
+    buckets <<= 1;
+  dyn_array<size_t> counts(0, buckets);
+  for (size_t i = 0; i < keys.size(); ++i)
+    counts[hash.run(keys[i]) & (buckets - 1)]++;
+  double expected = static_cast<double>(keys.size()) / buckets;
+  double chi2 = 0;
+  size_t max_load = 0;
+  for (size_t b = 0; b < buckets; ++b) {
+    double diff = static_cast<double>(counts[b]) - expected;
+    chi2 += diff * diff / expected;
+    max_load = counts[b] > max_load ? counts[b] : max_load;
+  }
+  std::cout << std::left << std::setw(42) << name << std::right
+            << std::setw(10) << keys.size() << "   max bucket "
+            << std::setw(8) << max_load << "   chi2 ratio " << std::fixed
+            << std::setprecision(2) << std::setw(10)
+            << chi2 / static_cast<double>(buckets - 1) << std::endl;
+}
+
+// Times hashing every key once with the given hash function.
+template <class K>
+void throughput(const std::string& name, const hash_fn<K>& hash,
+                const dyn_array<K>& keys)
+{
+  size_t sum = 0;
+  bench_util::run(name, keys.size(), keys.size(),
+    [&]() {sum = 0;},
+    [&]() {
+      for (size_t i = 0; i < keys.size(); ++i)
+        sum += hash.run(keys[i]);
+    });
+  bench_util::keep(sum);
+}
+
+int main(int argc, char** argv)
+{
+  bench_util::init("hash_fn", argc, argv);
+  bench_util::rng gen;
+
+  // Streaming large containers for every hash makes bigger keys impractical.
+  const size_t key_cap = 100000;
+  // Each container case hashes its key repeatedly, about this many elements.
+  const size_t total = 1000000;
+  // Same 64-bit prime modulus that hash tables construct hash_fn with.
+  const size_t size = sizeof(size_t) >= 8
+      ? static_cast<size_t>(18446744073709551557ULL) : 4294967291UL;
+
+  for (size_t n = bench_util::first(); n; n = bench_util::next(n)) {
+    // Sequential IDs, IDs with a stride of 1024, addresses of 32-byte heap
+    // blocks and short generated names are the most common key patterns.
+    dyn_array<int> ids(0, n);
+    dyn_array<int> strided(0, n);
+    dyn_array<uintptr_t> addrs(0, n);
+    dyn_array<std::string> names(std::string(), n);
+    for (size_t i = 0; i < n; ++i) {
+      ids[i] = static_cast<int>(i);
+      strided[i] = static_cast<int>(i << 10);
+      addrs[i] = static_cast<uintptr_t>(0x7f0000000000ULL + (i << 5));
+      names[i] = "user_" + std::to_string(i);
+    }
+    hash_fn<int> int_classic(size);
+    hash_fn<int> int_wide(size, FNV, WIDE, gen.next());
+    hash_fn<uintptr_t> ptr_fnv(size, FNV);
+    hash_fn<uintptr_t> ptr_jenkins(size, JENKINS);
+    hash_fn<uintptr_t> ptr_murmur(size, MURMUR);
+    hash_fn<uintptr_t> ptr_wide(size, FNV, WIDE, gen.next());
+    hash_fn<std::string> str_classic(size);
+    hash_fn<std::string> str_wide(size, FNV, WIDE, gen.next());
+
+    throughput("hash_fn<int> CLASSIC", int_classic, ids);
+    throughput("hash_fn<int> WIDE", int_wide, ids);
+    throughput("hash_fn<uintptr_t> FNV", ptr_fnv, addrs);
+    throughput("hash_fn<uintptr_t> JENKINS", ptr_jenkins, addrs);
+    throughput("hash_fn<uintptr_t> MURMUR", ptr_murmur, addrs);
+    throughput("hash_fn<uintptr_t> WIDE", ptr_wide, addrs);
+    throughput("hash_fn<string> CLASSIC", str_classic, names);
+    throughput("hash_fn<string> WIDE", str_wide, names);
+
+    distribution("int CLASSIC sequential", int_classic, ids);
+    distribution("int WIDE sequential", int_wide, ids);
+    distribution("int CLASSIC stride 1024", int_classic, strided);
+    distribution("int WIDE stride 1024", int_wide, strided);
+    distribution("uintptr_t FNV", ptr_fnv, addrs);
+    distribution("uintptr_t JENKINS", ptr_jenkins, addrs);
+    distribution("uintptr_t MURMUR", ptr_murmur, addrs);
+    distribution("uintptr_t WIDE", ptr_wide, addrs);
+    distribution("string CLASSIC", str_classic, names);
+    distribution("string WIDE", str_wide, names);
+
+    if (bench_util::skip("container keys", n, key_cap))
+      continue;
+    size_t reps = n < total ? total / n : 1;
+    size_t sum = 0;
+
+    dyn_array<int> arr(0, n);
+    for (size_t i = 0; i < n; ++i)
+      arr[i] = static_cast<int>(gen.below(1000000000));
+    hash_fn<dyn_array<int> > arr_hash(size);
+    bench_util::run("dyn_array<int> stream hash", n, reps,
+      [&]() {sum = 0;},
+      [&]() {
+        for (size_t r = 0; r < reps; ++r)
+          sum += stream_hash(arr, size);
+      });
+    bench_util::keep(sum);
+    bench_util::run("dyn_array<int> structural hash", n, reps,
+      [&]() {sum = 0;},
+      [&]() {
+        for (size_t r = 0; r < reps; ++r)
+          sum += arr_hash.run(arr);
+      });
+    bench_util::keep(sum);
+
+    binary_search_tree<int, false>* bst =
+        binary_tree<int, false>::SEARCH(arr[0]);
+    for (size_t i = 1; i < n; ++i)
+      bst->insert(arr[i]);
+    hash_fn<binary_search_tree<int, false> > bst_hash(size);
+    bench_util::run("binary_search_tree<int, 0> stream hash", n, reps,
+      [&]() {sum = 0;},
+      [&]() {
+        for (size_t r = 0; r < reps; ++r)
+          sum += stream_hash(*bst, size);
+      });
+    bench_util::keep(sum);
+    bench_util::run("binary_search_tree<int, 0> structural hash", n, reps,
+      [&]() {sum = 0;},
+      [&]() {
+        for (size_t r = 0; r < reps; ++r)
+          sum += bst_hash.run(*bst);
+      });
+    bench_util::keep(sum);
+    delete bst;
+  }
+
+  bench_util::print_summary();
+  return 0;
+}
@@ -0,0 +1,169 @@
+#include <iostream>
+#include <string>
+#include "bench_util.h"
+#include "hash_table.h"
+#include "open_hash_table.h"
+
+int main(int argc, char** argv)
+{
+  bench_util::init("hash_table", argc, argv);
+  bench_util::rng gen;
+
+  for (size_t n = bench_util::first(); n; n = bench_util::next(n)) {
+    dyn_array<int> keys(0, n);
+    for (size_t i = 0; i < n; ++i)
+      keys[i] = static_cast<int>(gen.next() & 0x7fffffff);
+    size_t hits = 0;
+
+    open_hash_table<int, int>* oh = nullptr;
+    bench_util::run("open_hash_table<int, int>::insert", n, n,
+      [&]() {delete oh; oh = new open_hash_table<int, int>();},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          oh->insert(keys[i], static_cast<int>(i));
+      });
+    bench_util::run("open_hash_table<int, int>::contains", n, n,
+      [&]() {hits = 0;},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          hits += oh->contains(keys[i]);
+      });
+    bench_util::keep(hits);
+    bench_util::run("open_hash_table<int, int>::contains miss", n, n,
+      [&]() {hits = 0;},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          hits += oh->contains(-1 - static_cast<int>(i));
+      });
+    bench_util::keep(hits);
+    dyn_array<bool> found(false, n);
+    bench_util::run("open_hash_table<int, int>::contains_many", n, n,
+      [&]() {hits = 0;},
+      [&]() {hits = oh->contains_many(keys, found);});
+    bench_util::keep(hits);
+    delete oh;
+
+    hash_table<int, int>* ht = nullptr;
+    bench_util::run("hash_table<int, int>::insert", n, n,
+      [&]() {delete ht; ht = new hash_table<int, int>();},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          ht->insert(keys[i], static_cast<int>(i));
+      });
+
+    bench_util::run("hash_table<int, int>::contains", n, n,
+      [&]() {hits = 0;},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          hits += ht->contains(keys[i]);
+      });
+    bench_util::keep(hits);
+
+    bench_util::run("hash_table<int, int>::contains miss", n, n,
+      [&]() {hits = 0;},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          hits += ht->contains(-1 - static_cast<int>(i));
+      });
+    bench_util::keep(hits);
+
+    // Batch lookups write into preallocated outputs, so they don't allocate.
+    bench_util::run("hash_table<int, int>::contains_many", n, n,
+      [&]() {hits = 0;},
+      [&]() {hits = ht->contains_many(keys, found);});
+    bench_util::keep(hits);
+
+    dyn_array<int*> vals(nullptr, n);
+    bench_util::run("hash_table<int, int>::find_many", n, n,
+      [&]() {hits = 0;},
+      [&]() {hits = ht->find_many(keys, vals);});
+    bench_util::keep(hits);
+
+    // Full scans, as done by periodic expiry sweeps over the whole table.
+    long long total = 0;
+    bench_util::run("hash_table<int, int> scan keys()", n, n,
+      [&]() {total = 0;},
+      [&]() {
+        dyn_array<int*> all = ht->keys();
+        for (size_t i = 0; i < all.size(); ++i)
+          total += *all[i];
+      });
+    bench_util::keep(total);
+    bench_util::run("hash_table<int, int> scan iterator", n, n,
+      [&]() {total = 0;},
+      [&]() {
+        for (const hash_node<int, int>& hn : *ht)
+          total += hn.key_;
+      });
+    bench_util::keep(total);
+    bench_util::run("hash_table<int, int> scan visit", n, n,
+      [&]() {total = 0;},
+      [&]() {ht->visit([&total](const int& key, int&) {total += key;});});
+    bench_util::keep(total);
+    delete ht;
+
+    // Churn removes every key and inserts a replacement, which recycles
+    // entries in a pooled table instead of going through the heap. Keys are
+    // scrambled with an odd multiplier, which keeps them distinct.
+    dyn_array<int> uniq(0, n);
+    for (size_t i = 0; i < n; ++i)
+      uniq[i] = static_cast<int>((i * 2654435761ULL) & 0x7fffffff);
+    for (int pooled = 0; pooled < 2; ++pooled) {
+      std::string name = pooled ? "hash_table<int, int> pooled" :
+                                  "hash_table<int, int> heap";
+      hash_table<int, int>* hp = nullptr;
+      bench_util::run(name + "::insert", n, n,
+        [&]() {
+          delete hp;
+          hp = new hash_table<int, int>();
+          hp->use_pool(pooled != 0);
+        },
+        [&]() {
+          for (size_t i = 0; i < n; ++i)
+            hp->insert(uniq[i], static_cast<int>(i));
+        });
+      bench_util::run(name + " churn", n, 2 * n,
+        [&]() {
+          hp->clear();
+          for (size_t i = 0; i < n; ++i)
+            hp->insert(uniq[i], static_cast<int>(i));
+        },
+        [&]() {
+          for (size_t i = 0; i < n; ++i) {
+            hp->remove(uniq[i]);
+            hp->insert(-1 - uniq[i], static_cast<int>(i));
+          }
+        });
+      bench_util::run(name + "::clear", n, n,
+        [&]() {
+          hp->clear();
+          for (size_t i = 0; i < n; ++i)
+            hp->insert(uniq[i], static_cast<int>(i));
+        },
+        [&]() {hp->clear();});
+      delete hp;
+    }
+
+    dyn_array<std::string> words(std::string(), n);
+    for (size_t i = 0; i < n; ++i)
+      words[i] = "key_" + std::to_string(gen.next());
+    hash_table<std::string, int>* hs = nullptr;
+    bench_util::run("hash_table<string, int>::insert", n, n,
+      [&]() {delete hs; hs = new hash_table<std::string, int>();},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          hs->insert(words[i], static_cast<int>(i));
+      });
+    bench_util::run("hash_table<string, int>::contains", n, n,
+      [&]() {hits = 0;},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          hits += hs->contains(words[i]);
+      });
+    bench_util::keep(hits);
+    delete hs;
+  }
+
+  bench_util::print_summary();
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include "bench_util.h"
+#include "heap.h"
+
+int main(int argc, char** argv)
+{
+  bench_util::init("heap", argc, argv);
+  bench_util::rng gen;
+
+  for (size_t n = bench_util::first(); n; n = bench_util::next(n)) {
+    dyn_array<int> vals(0, n);
+    for (size_t i = 0; i < n; ++i)
+      vals[i] = static_cast<int>(gen.below(1000000000));
+
+    heap<int> min_heap(false);
+    bench_util::run("heap<int>::insert", n, n,
+      [&]() {min_heap.clear();},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          min_heap.insert(vals[i]);
+      });
+
+    long long sum = 0;
+    bench_util::run("heap<int>::remove", n, n,
+      [&]() {
+        min_heap.clear();
+        for (size_t i = 0; i < n; ++i)
+          min_heap.insert(vals[i]);
+      },
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          sum += min_heap.remove();
+      });
+    bench_util::keep(sum);
+
+    heap<int> built(false);
+    bench_util::run("heap<int>::operator= (heapify)", n, n,
+      [&]() {built.clear();},
+      [&]() {built = vals;});
+    bench_util::keep(built.size());
+
+    index_heap<int> ih(n);
+    bench_util::run("index_heap<int>::insert", n, n,
+      [&]() {ih.clear();},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          ih.insert(i, vals[i]);
+      });
+
+    // Halve every key, as relaxations on a Dijkstra frontier would.
+    bench_util::run("index_heap<int>::decrease_key", n, n,
+      [&]() {
+        ih.clear();
+        for (size_t i = 0; i < n; ++i)
+          ih.insert(i, vals[i]);
+      },
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          ih.decrease_key(i, vals[i] / 2);
+      });
+
+    bench_util::run("index_heap<int>::remove", n, n,
+      [&]() {
+        ih.clear();
+        for (size_t i = 0; i < n; ++i)
+          ih.insert(i, vals[i]);
+      },
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          sum += ih.remove();
+      });
+    bench_util::keep(sum);
+  }
+
+  bench_util::print_summary();
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "sharded_hash_table.h"
+
+// hash_table wrapped in a single mutex, the usual way to share one between
+// threads, as a baseline for the sharded table.
+template <class K, class V>
+class locked_hash_table
+{
+  public:
+    locked_hash_table(): table_(4288) {}
+    bool contains(const K& key) const
+    {
+      std::lock_guard<std::mutex> guard(this->lock_);
+      return this->table_.contains(key);
+    }
+    void insert(const K& key, const V& val)
+    {
+      std::lock_guard<std::mutex> guard(this->lock_);
+      this->table_.insert(key, val);
+    }
+    void clear() {this->table_.clear();}
+  private:
+    mutable std::mutex lock_;
+    hash_table<K, V> table_;
+};
+
+// Splits ops operations over the given number of threads. Each thread draws
+// keys uniformly from [0, 2n), which the table holds half of, and looks them
+// up with probability read_pct percent, otherwise inserts or updates them.
+template <class Table>
+void mixed(Table& table, size_t n, size_t ops, int threads, int read_pct)
+{
+  std::vector<std::thread> workers;
+  std::vector<size_t> hits(static_cast<size_t>(threads), 0);
+  for (int t = 0; t < threads; ++t) {
+    workers.push_back(std::thread([&table, &hits, n, ops, threads, read_pct,
+                                   t]() {
+      bench_util::rng gen(88172645463325252ULL + static_cast<unsigned>(t));
+      size_t share = ops / static_cast<size_t>(threads);
+      size_t found = 0;
+      for (size_t i = 0; i < share; ++i) {
+        int key = static_cast<int>(gen.below(2 * n));
+        if (static_cast<int>(gen.below(100)) < read_pct)
+          found += table.contains(key);
+        else
+          table.insert(key, t);
+      }
+      hits[static_cast<size_t>(t)] = found;
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); ++t)
+    workers[t].join();
+  size_t sum = 0;
+  for (size_t t = 0; t < hits.size(); ++t)
+    sum += hits[t];
+  bench_util::keep(sum);
+}
+
+int main(int argc, char** argv)
+{
+  bench_util::init("sharded_hash_table", argc, argv);
+
+  // Tables are refilled for every repetition, which makes bigger ones slow.
+  const size_t key_cap = 1000000;
+  // Every case runs at least this many operations to amortize thread startup.
+  const size_t min_ops = 1000000;
+  const int thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+  const int read_pcts[] = {50, 90, 100};
+  std::cout << "Hardware threads: " << std::thread::hardware_concurrency()
+            << std::endl;
+
+  for (size_t n = bench_util::first(); n; n = bench_util::next(n)) {
+    if (bench_util::skip("sharded_hash_table<int, int>", n, key_cap))
+      continue;
+    size_t ops = n > min_ops ? n : min_ops;
+    locked_hash_table<int, int> locked;
+    sharded_hash_table<int, int> sharded;
+
+    for (size_t r = 0; r < sizeof(read_pcts) / sizeof(int); ++r) {
+      int pct = read_pcts[r];
+      for (size_t c = 0; c < sizeof(thread_counts) / sizeof(int); ++c) {
+        int threads = thread_counts[c];
+        std::string mix = " " + std::to_string(pct) + "% reads " +
+                          std::to_string(threads) + " threads";
+        bench_util::run("mutex hash_table" + mix, n, ops,
+          [&]() {
+            locked.clear();
+            for (size_t i = 0; i < 2 * n; i += 2)
+              locked.insert(static_cast<int>(i), 0);
+          },
+          [&]() {mixed(locked, n, ops, threads, pct);});
+        bench_util::run("sharded_hash_table" + mix, n, ops,
+          [&]() {
+            sharded.clear();
+            for (size_t i = 0; i < 2 * n; i += 2)
+              sharded.insert(static_cast<int>(i), 0);
+          },
+          [&]() {mixed(sharded, n, ops, threads, pct);});
+      }
+    }
+  }
+
+  bench_util::print_summary();
+  return 0;
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <string>
+#include "bench_util.h"
+#include "trie.h"
+
+int main(int argc, char** argv)
+{
+  bench_util::init("trie", argc, argv);
+  bench_util::rng gen;
+
+  // Each character costs a heap-allocated node, which bounds the input size.
+  const size_t cap = 1000000;
+  // Number of autocomplete queries per measurement.
+  const size_t queries = 1000;
+
+  for (size_t n = bench_util::first(); n; n = bench_util::next(n)) {
+    if (bench_util::skip("trie", n, cap))
+      continue;
+    dyn_array<std::string> words(std::string(), n);
+    for (size_t i = 0; i < n; ++i) {
+      size_t len = 4 + gen.below(7);
+      std::string w(len, 'a');
+      for (size_t c = 0; c < len; ++c)
+        w[c] = static_cast<char>('a' + gen.below(26));
+      words[i] = w;
+    }
+
+    trie* tr = nullptr;
+    bench_util::run("trie::insert", n, n,
+      [&]() {delete tr; tr = trie::create();},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          tr->insert(words[i]);
+      });
+
+    size_t found = 0;
+    bench_util::run("trie::search", n, n,
+      [&]() {found = 0;},
+      [&]() {
+        for (size_t i = 0; i < n; ++i)
+          found += tr->search(words[i]).size();
+      });
+    bench_util::keep(found);
+
+    bench_util::run("trie::autocomplete", n, queries,
+      [&]() {found = 0;},
+      [&]() {
+        for (size_t q = 0; q < queries; ++q)
+          found += tr->autocomplete(words[q % n].substr(0, 3)).size();
+      });
+    bench_util::keep(found);
+    delete tr;
+  }
+
+  bench_util::print_summary();
+  return 0;
+}
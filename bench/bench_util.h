@@ -0,0 +1,233 @@
+#ifndef data_bench_util_h_
+#define data_bench_util_h_
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Benchmark counterpart of test_util.h, shared by all executables in bench/.
+// Each benchmark executable is a single translation unit that includes this
+// header exactly once, which allows it to replace the global allocation
+// functions below and count every heap allocation made by the library.
+//
+// Command line options accepted by all benchmark executables:
+//   --min N   Smallest input size, defaults to 1e3.
+//   --max N   Largest input size, defaults to 1e7.
+//   --reps R  Repetitions per measurement, best one is reported. Defaults to 3.
+//   --out F   Machine-readable CSV output file, defaults to <suite>.csv.
+// Input sizes are powers of 10 between min and max. Individual cases can
+// impose lower caps on top of these when their complexity or memory use would
+// make larger inputs impractical, and report such sizes as skipped.
+//
+// Every measurement is printed to stdout in human-readable form and appended
+// to the CSV file as a single row with the following fields:
+//   suite,case,n,ops,ns_per_op,allocs_per_op,bytes_per_op,ops_per_sec
+// Rows are written in a deterministic order so that runs can be diffed.
+namespace bench_util {
+  namespace {
+    std::atomic<size_t> alloc_count(0);
+    std::atomic<size_t> alloc_bytes(0);
+    std::atomic<bool> counting(false);
+    std::string suite_name;
+    std::ofstream csv;
+    size_t min_size = 1000;
+    size_t max_size = 10000000;
+    int reps = 3;
+    int run_count = 0;
+    int skip_count = 0;
+    // Target of the stores made by keep.
+    volatile char sink = 0;
+  }
+
+  // Records an allocation made by the replaced global operator new.
+  inline void count_alloc(size_t bytes)
+  {
+    if (counting.load(std::memory_order_relaxed)) {
+      alloc_count.fetch_add(1, std::memory_order_relaxed);
+      alloc_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+  }
+
+  // Parses command line options and opens the CSV output file.
+  void init(const std::string& suite, int argc, char** argv)
+  {
+    suite_name = suite;
+    std::string out = suite + ".csv";
+    for (int i = 1; i + 1 < argc; i += 2) {
+      std::string opt = argv[i];
+      if (opt == "--min")
+        min_size = static_cast<size_t>(std::atof(argv[i+1]));
+      else if (opt == "--max")
+        max_size = static_cast<size_t>(std::atof(argv[i+1]));
+      else if (opt == "--reps")
+        reps = std::atoi(argv[i+1]) > 0 ? std::atoi(argv[i+1]) : 1;
+      else if (opt == "--out")
+        out = argv[i+1];
+      else
+        std::cerr << "Warning: Unrecognized option " << opt << std::endl;
+    }
+    csv.open(out.c_str());
+    csv << "suite,case,n,ops,ns_per_op,allocs_per_op,bytes_per_op,ops_per_sec";
+    csv << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << "BENCHMARK SUITE: " << suite << std::endl;
+    std::cout << "Writing results to " << out << std::endl;
+    std::cout << std::left << std::setw(42) << "case" << std::right
+              << std::setw(10) << "n" << std::setw(12) << "ns/op"
+              << std::setw(12) << "allocs/op" << std::setw(12) << "bytes/op"
+              << std::setw(14) << "ops/s" << std::endl;
+  }
+
+  // Returns the next input size in the sequence, or 0 past the last one.
+  // Usage: for (size_t n = first(); n; n = next(n))
+  inline size_t first() {return min_size <= max_size ? min_size : 0;}
+  inline size_t next(size_t n) {return n * 10 <= max_size ? n * 10 : 0;}
+
+  // Prevents the compiler from optimizing away a computed value.
+  template <class T>
+  inline void keep(const T& val)
+  {
+    sink = *reinterpret_cast<const volatile char*>(&val);
+  }
+
+  // Reports a case that was not run because n exceeds its cap.
+  // Returns true if the caller should skip the measurement.
+  bool skip(const std::string& name, size_t n, size_t cap)
+  {
+    if (n <= cap)
+      return false;
+    std::cout << std::left << std::setw(42) << name << std::right
+              << std::setw(10) << n << "   skipped (case capped at " << cap
+              << ")" << std::endl;
+    skip_count++;
+    return true;
+  }
+
+  // Runs setup then times body reps times, keeping the fastest repetition.
+  // Body is expected to execute ops operations on an input of size n.
+  // Allocations are only counted while body runs.
+  template <class Setup, class Body>
+  void run(const std::string& name, size_t n, size_t ops,
+           Setup&& setup, Body&& body)
+  {
+    double best_ns = -1.0;
+    size_t best_allocs = 0;
+    size_t best_bytes = 0;
+    for (int r = 0; r < reps; ++r) {
+      setup();
+      alloc_count.store(0);
+      alloc_bytes.store(0);
+      counting.store(true);
+      std::chrono::steady_clock::time_point t0 =
+          std::chrono::steady_clock::now();
+      body();
+      std::chrono::steady_clock::time_point t1 =
+          std::chrono::steady_clock::now();
+      counting.store(false);
+      double ns = static_cast<double>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+      if (best_ns < 0 || ns < best_ns) {
+        best_ns = ns;
+        best_allocs = alloc_count.load();
+        best_bytes = alloc_bytes.load();
+      }
+    }
+    double div = static_cast<double>(ops > 0 ? ops : 1);
+    double ns_op = best_ns / div;
+    double allocs_op = static_cast<double>(best_allocs) / div;
+    double bytes_op = static_cast<double>(best_bytes) / div;
+    double ops_sec = best_ns > 0 ? div * 1e9 / best_ns : 0.0;
+    std::cout << std::left << std::setw(42) << name << std::right
+              << std::setw(10) << n << std::fixed << std::setprecision(2)
+              << std::setw(12) << ns_op << std::setw(12) << allocs_op
+              << std::setw(12) << bytes_op << std::setprecision(0)
+              << std::setw(14) << ops_sec << std::endl;
+    csv << suite_name << "," << name << "," << n << "," << ops << ","
+        << std::fixed << std::setprecision(3) << ns_op << "," << allocs_op
+        << "," << bytes_op << "," << std::setprecision(0) << ops_sec
+        << std::endl;
+    run_count++;
+  }
+
+  // Overload for cases that need no untimed setup.
+  template <class Body>
+  void run(const std::string& name, size_t n, size_t ops, Body&& body)
+  {
+    run(name, n, ops, []() {}, body);
+  }
+
+  // Deterministic xorshift generator so that inputs are identical across runs.
+  class rng
+  {
+    public:
+      rng(unsigned long long seed = 88172645463325252ULL): state_(seed) {}
+      unsigned long long next()
+      {
+        this->state_ ^= this->state_ << 13;
+        this->state_ ^= this->state_ >> 7;
+        this->state_ ^= this->state_ << 17;
+        return this->state_;
+      }
+      // Uniform value in [0, bound).
+      size_t below(size_t bound) {return static_cast<size_t>(next() % bound);}
+    private:
+      unsigned long long state_;
+  };
+
+  void print_summary()
+  {
+    csv.close();
+    std::cout << "----------------------------------------------" << std::endl;
+    std::cout << "|  " << std::setw(3) << run_count << " measurements, "
+              << std::setw(3) << skip_count << " skipped";
+    std::cout << "               |" << std::endl;
+    std::cout << "----------------------------------------------" << std::endl;
+  }
+}
+
+// Replacement global allocation functions that count every allocation made
+// while a measurement is running. They are kept out of line, so that new and
+// delete expressions are never paired with inlined malloc and free calls,
+// which the compiler would flag as mismatched.
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void* operator new(size_t bytes)
+{
+  bench_util::count_alloc(bytes);
+  void* p = std::malloc(bytes > 0 ? bytes : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+BENCH_NOINLINE void* operator new[](size_t bytes)
+{
+  bench_util::count_alloc(bytes);
+  void* p = std::malloc(bytes > 0 ? bytes : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+BENCH_NOINLINE void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+BENCH_NOINLINE void operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef csr_graph_h_
+#define csr_graph_h_
+
+#include <iostream>
+#include <cassert>
+#include <functional>
+#include "dyn_array.h"
+#include "graph.h"
+
+// Immutable graph in compressed sparse row (CSR) format for large sparse
+// graphs with directed or undirected, weighted or unweighted edges.
+// Edges are stored in three flat dyn_array members: the targets of all edges
+// grouped by source node, an offset array of N+1 elements that marks where
+// the edges of each node start, and the edge weights in the same order as
+// the targets. Edges of each node are sorted by target index.
+// This takes O(N+E) memory instead of the O(N^2) adjacency/weight matrix of
+// graph<T>, and neighbors of a node are read from a single contiguous range,
+// so graphs with millions of nodes fit in memory and are traversed with
+// sequential memory accesses.
+//
+// Built in O(N+E) from a graph<T>, whose edges and weights it copies from
+// node adjacency lists in either storage mode, or from an edge list of source
+// and target indices with optional weights, which may hold parallel edges.
+// Every stored edge is directed. Graphs built from a graph<T> inherit both
+// directions of its undirected edges, whereas edge lists are taken as they
+// are, so callers building undirected graphs from them have to list both
+// directions of every edge. Unweighted graphs built from edge lists keep no
+// weight array, and all their edges weigh 1.
+// Nodes and edges can't be added or removed after construction.
+//
+// Algorithms mirror their graph<T> counterparts and return the same index-
+// based result types. Since graph<T> visits neighbors in adjacency list order
+// and csr_graph<T> in index order, traversal orders only match on graphs
+// whose adjacency lists are sorted, such as graphs built from matrices.
+// Traversals and Tarjan's algorithm run on explicit stacks rather than
+// recursion, and track visited nodes with flat index arrays, so long paths
+// can't overflow the call stack.
+//
+// Assumes T is default-constructable and has equality operators, and that
+// node indices and edge weights fit in 32 bits for dijkstra.
+template <class T>
+class csr_graph
+{
+  public:
+    csr_graph() {}
+    // Builds from the adjacency lists and weights of a graph. O(N+E) | O(N+E)
+    csr_graph(const graph<T>& source);
+    // Builds from node values and an edge list, where edge e goes from node
+    // from[e] to node to[e] with weight weights[e], or 1 if weights is empty.
+    // Undirected edges have to be listed in both directions.
+    // Fails with an error message and builds an empty graph if the arrays
+    // have different sizes or an index is out of bounds. O(N+E) | O(N+E)
+    csr_graph(const dyn_array<T>& node_vals, const dyn_array<size_t>& from,
+              const dyn_array<size_t>& to,
+              const dyn_array<int>& weights = dyn_array<int>());
+
+    // Read-only access to node value using its index. O(1) | O(1)
+    const T& operator () (size_t ind) const;
+    // Converts indices to node values, skips if out-of-bounds. O(N) | O(N)
+    dyn_array<T> operator [] (const dyn_array<size_t>& inds) const;
+
+    // Checks if the graph has no nodes. O(1) | O(1)
+    bool is_empty() const {return this->vals_.is_empty();}
+    // Returns the number of nodes. O(1) | O(1)
+    size_t size() const {return this->vals_.size();}
+    // Returns the number of stored edges. O(1) | O(1)
+    size_t num_edges() const {return this->tgts_.size();}
+    // Returns the number of outgoing edges of a node. O(1) | O(1)
+    size_t degree(size_t ind) const;
+    // Returns dyn_array of neighbors of the node at index ind. O(A) | O(A)
+    dyn_array<size_t> neighbors(size_t ind) const;
+    // Binary searches the edges of node i for node j. O(logA) | O(1)
+    bool has_edge(size_t i, size_t j) const;
+    // Weight of the e-th edge in target order. O(1) | O(1)
+    int weight(size_t e) const;
+    // Read-only access to the CSR arrays. Edges of node i are the elements
+    // [offsets()[i], offsets()[i+1]) of targets() and weights(), and weights()
+    // is empty for unweighted graphs. O(1) | O(1)
+    const dyn_array<size_t>& offsets() const {return this->offs_;}
+    const dyn_array<size_t>& targets() const {return this->tgts_;}
+    const dyn_array<int>& weights() const {return this->wgts_;}
+
+    // Iterative depth-first traverse. O(N+E) | O(N)
+    dyn_array<size_t> depth_first_traverse(size_t from_ind,
+                                        std::ostream* os_ptr = nullptr) const;
+    // Breadth-first traverse. O(N+E) | O(N)
+    dyn_array<size_t> breadth_first_traverse(size_t from_ind,
+                                        std::ostream* os_ptr = nullptr) const;
+    // Depth-first search. O(N_D+E_D) average, O(N+E) worst | O(N)
+    dyn_array<size_t> depth_first_search(size_t from_ind, const T& val,
+                                        std::ostream* os_ptr = nullptr) const;
+    // Breadth-first search. O(N_D+E_D) average, O(N+E) worst | O(N)
+    dyn_array<size_t> breadth_first_search(size_t from_ind, const T& val,
+                                        std::ostream* os_ptr = nullptr) const;
+
+    // Returns all the nodes with no incoming edges. O(N+E) | O(N)
+    dyn_array<size_t> find_roots() const;
+    // Kahn's algorithm for topological sorting and cycle detection. Returns
+    // topologically sorted indices, incomplete if cycles exist. O(N+E) | O(N)
+    dyn_array<size_t> kahn() const;
+    // Finds strongly-connected components of a directed graph. O(N+E) | O(N)
+    dyn_array<dyn_array<size_t> > strongly_conn_comp() const;
+    // Finds weakly-connected components using union-find to return
+    // contiguous labels in index order. O(N+E) | O(N)
+    dyn_array<int> weakly_conn_comp() const;
+    // Finds all cut-edges, which are edges whose deletion would increase the
+    // graph's number of connected components. O(N+E) | O(N)
+    dyn_array<dyn_array<size_t> > bridges() const;
+    // Finds all cut-vertices, whose deletion together with their edges would
+    // increase the graph's number of connected components. O(N+E) | O(N)
+    dyn_array<size_t> articulation_points() const;
+    // Finds shortest distances by edge weight from src. O((N+E)*logN) | O(N)
+    dyn_array<int> shortest_dists(size_t src) const;
+    // Dijkstra's algorithm either finds shortest paths or minimum distances
+    // from src to all other nodes, depending on the accumulate arg provided.
+    // When it's false, returns only distances at index 0 of the 2D dyn_array.
+    // For unreachable nodes, returns -1 distance. O((N+E)*logN) | O(N*D)
+    dyn_array<dyn_array<int> > dijkstra(size_t src, bool accumulate = 1) const;
+    // Tarjan's algorithm with 3 different modes for finding strongly connected
+    // components, bridges and articulation points, on an explicit stack.
+    // O(N+E) | O(N)
+    void tarjan(size_t ind, tarjan_bundle& tbun) const;
+
+  private:
+    // Shared construction engine that sorts an edge list into CSR arrays.
+    bool build(const dyn_array<size_t>& from, const dyn_array<size_t>& to,
+               const dyn_array<int>& weights);
+    // Iterative depth-first engine that visits nodes in the same order as
+    // recursion would. Returns the path to the first node check accepts, or
+    // the full traversal path if there is none. O(N+E) | O(N)
+    dyn_array<size_t> dft(size_t from_ind,
+                          const std::function<bool(size_t)>& check,
+                          std::ostream* os_ptr) const;
+    // Breadth-first engine with the same return values as dft. O(N+E) | O(N)
+    dyn_array<size_t> bft(size_t from_ind,
+                          const std::function<bool(size_t)>& check,
+                          std::ostream* os_ptr) const;
+    // Follows parent indices back from ind to the node that is its own
+    // parent, and returns the path in forward order. O(D) | O(D)
+    dyn_array<size_t> trace_path(size_t ind,
+                                 const dyn_array<size_t>& parent) const;
+
+    // Node values in index order.
+    dyn_array<T> vals_;
+    // Start of the edges of each node in tgts_, followed by num_edges().
+    dyn_array<size_t> offs_;
+    // Edge targets grouped by source, in increasing order per source.
+    dyn_array<size_t> tgts_;
+    // Edge weights in the order of tgts_, empty if all edges weigh 1.
+    dyn_array<int> wgts_;
+};
+
+// Templated class method implementations need to be accessible at the
+// point of instantiation
+#include "csr_graph.tpp"
+
+#endif
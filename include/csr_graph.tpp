@@ -0,0 +1,545 @@
+// The header is included primarily to get rid of IntelliSense squigglies.
+// The class should build and run properly without it. Header guard protection
+// prevents the apparent circular inclusion from causing any problems.
+#include "csr_graph.h"
+#include "heap.h"
+
+//======================================================================//
+//                                                                      //
+//                         csr_graph<T> methods                         //
+//                                                                      //
+//======================================================================//
+
+template <class T>
+csr_graph<T>::csr_graph(const graph<T>& source)
+{
+  size_t num_nodes = source.size();
+  this->vals_ = source.node_vals();
+  // Collect edges and their weights from adjacency list slots.
+  dyn_array<size_t> from, to;
+  dyn_array<int> weights;
+  for (size_t u = 0; u < num_nodes; ++u) {
+    const graph_node<T>& node_u = source[u];
+    for (size_t n = 0; n < node_u.capacity(); ++n) {
+      if (!node_u[n])
+        continue;
+      size_t v = node_u[n]->ind();
+      from.add(u);
+      to.add(v);
+      weights.add(source.slot_w(u, n));
+    }
+  }
+  this->build(from, to, weights);
+}
+
+template <class T>
+csr_graph<T>::csr_graph(const dyn_array<T>& node_vals,
+                        const dyn_array<size_t>& from,
+                        const dyn_array<size_t>& to,
+                        const dyn_array<int>& weights)
+  : vals_(node_vals)
+{
+  if (!this->build(from, to, weights))
+    this->vals_.clear();
+}
+
+template <class T>
+const T& csr_graph<T>::operator () (size_t ind) const
+{
+  assert(ind < this->size() && "node index out of csr_graph<T> bounds");
+  return this->vals_[ind];
+}
+
+template <class T>
+dyn_array<T> csr_graph<T>::operator [] (const dyn_array<size_t>& inds) const
+{
+  dyn_array<T> ret;
+  for (size_t i = 0; i < inds.size(); ++i)
+    if (inds[i] < this->size())
+      ret.add(this->vals_[inds[i]]);
+  return ret;
+}
+
+template <class T>
+size_t csr_graph<T>::degree(size_t ind) const
+{
+  assert(ind < this->size() && "node index out of csr_graph<T> bounds");
+  return this->offs_[ind+1] - this->offs_[ind];
+}
+
+template <class T>
+dyn_array<size_t> csr_graph<T>::neighbors(size_t ind) const
+{
+  assert(ind < this->size() && "node index out of csr_graph<T> bounds");
+  dyn_array<size_t> ret(0, this->degree(ind));
+  for (size_t e = this->offs_[ind]; e < this->offs_[ind+1]; ++e)
+    ret[e - this->offs_[ind]] = this->tgts_[e];
+  return ret;
+}
+
+template <class T>
+bool csr_graph<T>::has_edge(size_t i, size_t j) const
+{
+  if (i >= this->size() || j >= this->size())
+    return false;
+  size_t lo = this->offs_[i], hi = this->offs_[i+1];
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (this->tgts_[mid] < j)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo < this->offs_[i+1] && this->tgts_[lo] == j;
+}
+
+template <class T>
+int csr_graph<T>::weight(size_t e) const
+{
+  assert(e < this->num_edges() && "edge index out of csr_graph<T> bounds");
+  return this->wgts_.is_empty() ? 1 : this->wgts_[e];
+}
+
+template <class T>
+dyn_array<size_t> csr_graph<T>::depth_first_traverse(size_t from_ind,
+                                                     std::ostream* os_ptr) const
+{
+  assert(from_ind < this->size() && "node index out of csr_graph<T> bounds");
+  auto check_none = [](size_t) -> bool {return false;};
+  return this->dft(from_ind, check_none, os_ptr);
+}
+
+template <class T>
+dyn_array<size_t> csr_graph<T>::breadth_first_traverse(size_t from_ind,
+                                                     std::ostream* os_ptr) const
+{
+  assert(from_ind < this->size() && "node index out of csr_graph<T> bounds");
+  auto check_none = [](size_t) -> bool {return false;};
+  return this->bft(from_ind, check_none, os_ptr);
+}
+
+template <class T>
+dyn_array<size_t> csr_graph<T>::depth_first_search(size_t from_ind,
+                                                   const T& val,
+                                                   std::ostream* os_ptr) const
+{
+  assert(from_ind < this->size() && "node index out of csr_graph<T> bounds");
+  auto check_val = [this, &val](size_t ind) -> bool {
+    return this->vals_[ind] == val;
+  };
+  return this->dft(from_ind, check_val, os_ptr);
+}
+
+template <class T>
+dyn_array<size_t> csr_graph<T>::breadth_first_search(size_t from_ind,
+                                                     const T& val,
+                                                     std::ostream* os_ptr) const
+{
+  assert(from_ind < this->size() && "node index out of csr_graph<T> bounds");
+  auto check_val = [this, &val](size_t ind) -> bool {
+    return this->vals_[ind] == val;
+  };
+  return this->bft(from_ind, check_val, os_ptr);
+}
+
+template <class T>
+dyn_array<size_t> csr_graph<T>::find_roots() const
+{
+  // Mark every node that is the target of an edge.
+  dyn_array<bool> has_incoming(false, this->size());
+  for (size_t e = 0; e < this->num_edges(); ++e)
+    has_incoming[this->tgts_[e]] = true;
+  dyn_array<size_t> root_nodes;
+  for (size_t u = 0; u < this->size(); ++u)
+    if (!has_incoming[u])
+      root_nodes.add(u);
+  return root_nodes;
+}
+
+template <class T>
+dyn_array<size_t> csr_graph<T>::kahn() const
+{
+  dyn_array<size_t> ret;
+  if (this->is_empty())
+    return ret;
+  size_t num_nodes = this->size();
+  dyn_array<size_t> in_degree(0, num_nodes);
+  for (size_t e = 0; e < this->num_edges(); ++e)
+    in_degree[this->tgts_[e]]++;
+  // Dequeued nodes stay in the array, which ends up topologically sorted.
+  ret.realloc(num_nodes);
+  for (size_t u = 0; u < num_nodes; ++u)
+    if (in_degree[u] == 0)
+      ret.add(u);
+  for (size_t head = 0; head < ret.size(); ++head) {
+    size_t u = ret[head];
+    for (size_t e = this->offs_[u]; e < this->offs_[u+1]; ++e)
+      if (--in_degree[this->tgts_[e]] == 0)
+        ret.add(this->tgts_[e]);
+  }
+  return ret;
+}
+
+template <class T>
+dyn_array<dyn_array<size_t> > csr_graph<T>::strongly_conn_comp() const
+{
+  if (this->is_empty())
+    return dyn_array<dyn_array<size_t> >();
+  size_t num_nodes = this->size();
+  // Initialize tbun with strongly-connected component mode.
+  tarjan_bundle tbun(SCC, num_nodes);
+  // Depth-first traverse from each unvisited node with Tarjan's algorithm.
+  for (size_t u = 0; u < num_nodes; ++u)
+    if (tbun.disc[u] == -1)
+      this->tarjan(u, tbun);
+  return tbun.scc_arr;
+}
+
+template <class T>
+dyn_array<int> csr_graph<T>::weakly_conn_comp() const
+{
+  if (this->is_empty())
+    return dyn_array<int>();
+  size_t num_nodes = this->size();
+  // Union the endpoints of every edge, regardless of its direction.
+  union_find uf(static_cast<int>(num_nodes));
+  for (size_t u = 0; u < num_nodes; ++u)
+    for (size_t e = this->offs_[u]; e < this->offs_[u+1]; ++e)
+      uf.union_sets(static_cast<int>(u), static_cast<int>(this->tgts_[e]));
+  // Map roots to contiguous labels in order of their first node.
+  dyn_array<int> ret(-1, num_nodes);
+  dyn_array<int> root_map(-1, num_nodes);
+  int label = 0;
+  for (size_t i = 0; i < num_nodes; ++i) {
+    size_t r = static_cast<size_t>(uf.find(static_cast<int>(i)));
+    if (root_map[r] == -1)
+      root_map[r] = label++;
+    ret[i] = root_map[r];
+  }
+  return ret;
+}
+
+template <class T>
+dyn_array<dyn_array<size_t> > csr_graph<T>::bridges() const
+{
+  if (this->is_empty())
+    return dyn_array<dyn_array<size_t> >();
+  size_t num_nodes = this->size();
+  // Initialize tbun with bridge detection mode.
+  tarjan_bundle tbun(BRIDGE, num_nodes);
+  // Depth-first traverse from each unvisited node with Tarjan's algorithm.
+  for (size_t u = 0; u < num_nodes; ++u)
+    if (tbun.disc[u] == -1)
+      this->tarjan(u, tbun);
+  return tbun.bridges;
+}
+
+template <class T>
+dyn_array<size_t> csr_graph<T>::articulation_points() const
+{
+  if (this->is_empty())
+    return dyn_array<size_t>();
+  size_t num_nodes = this->size();
+  // Initialize tbun with articulation point finder mode.
+  tarjan_bundle tbun(ARTICULATION, num_nodes);
+  // Depth-first traverse from each unvisited node with Tarjan's algorithm.
+  for (size_t u = 0; u < num_nodes; ++u)
+    if (tbun.disc[u] == -1)
+      this->tarjan(u, tbun);
+  return tbun.art_pts.search(true);
+}
+
+template <class T>
+dyn_array<int> csr_graph<T>::shortest_dists(size_t src) const
+{
+  return this->dijkstra(src, false)[0];
+}
+
+template <class T>
+dyn_array<dyn_array<int> > csr_graph<T>::dijkstra(size_t src,
+                                                  bool accumulate) const
+{
+  assert(src < this->size() && "dijkstra's src out of csr_graph<T> bounds");
+  // Initialize distance vector with -1 values, set src distance to 0.
+  dyn_array<int> dist(-1, this->size());
+  dist[src] = 0;
+  // Initialize predecessor vector with -1 values.
+  dyn_array<int> pred(-1, this->size());
+  // Pack (distance, index) pairs into the high and low halves of a single
+  // integer, which orders them the same way without allocating per pair.
+  heap<long long> min_heap(false);
+  min_heap.insert(static_cast<long long>(src));
+  while (!min_heap.is_empty()) {
+    long long pair = min_heap.remove();
+    size_t u = static_cast<size_t>(pair & 0xFFFFFFFFLL);
+    int dist_u = static_cast<int>(pair >> 32);
+    // Skip stale entries of nodes that were reached again at less distance.
+    if (dist_u > dist[u])
+      continue;
+    for (size_t e = this->offs_[u]; e < this->offs_[u+1]; ++e) {
+      size_t v = this->tgts_[e];
+      // Update distance to v if a shorter distance is found through u.
+      int dist_v = dist_u + this->weight(e);
+      if (dist[v] == -1 || dist_v < dist[v]) {
+        dist[v] = dist_v;
+        pred[v] = static_cast<int>(u);
+        min_heap.insert((static_cast<long long>(dist_v) << 32) |
+                        static_cast<long long>(v));
+      }
+    }
+  }
+  // Return only distances at index 0 if accumulate is set to false.
+  if (!accumulate) {
+    dyn_array<dyn_array<int> > ret(dist);
+    return ret;
+  }
+  // Reconstruct paths using predecessors if accumulate is set to true.
+  dyn_array<dyn_array<int> > ret(dyn_array<int>(-1), this->size());
+  for (size_t i = 0; i < this->size(); ++i) {
+    if (dist[i] == -1)
+      continue;
+    dyn_array<int> path;
+    int cur = static_cast<int>(i);
+    while (cur != static_cast<int>(src)) {
+      path.add(cur);
+      cur = pred[cur];
+    }
+    path.add(cur);
+    ret[i] = path.reverse();
+  }
+  return ret;
+}
+
+template <class T>
+void csr_graph<T>::tarjan(size_t ind, tarjan_bundle& tbun) const
+{
+  // Each frame of the explicit stack holds a node, its next edge and
+  // whether the edge back to its parent is yet to be skipped. Only one such
+  // edge is the tree edge, others are parallel edges that count as back edges.
+  dyn_array<size_t> nodes, edges;
+  dyn_array<bool> up;
+  int children = 0;
+  tbun.disc[ind] = tbun.low[ind] = tbun.timestamp();
+  if (tbun.mode() == SCC) {
+    tbun.push(ind);
+    tbun.on_stack[ind] = true;
+  }
+  nodes.add(ind);
+  edges.add(this->offs_[ind]);
+  up.add(false);
+  while (!nodes.is_empty()) {
+    size_t u = nodes.last();
+    size_t e = edges.last();
+    if (e < this->offs_[u+1]) {
+      edges[edges.size()-1]++;
+      size_t v = this->tgts_[e];
+      // Descend into each unvisited neighbor of the node on top.
+      if (tbun.disc[v] == -1) {
+        if (u == ind)
+          children++;
+        if (tbun.mode() == BRIDGE || tbun.mode() == ARTICULATION)
+          tbun.parent[v] = static_cast<int>(u);
+        tbun.disc[v] = tbun.low[v] = tbun.timestamp();
+        if (tbun.mode() == SCC) {
+          tbun.push(v);
+          tbun.on_stack[v] = true;
+        }
+        nodes.add(v);
+        edges.add(this->offs_[v]);
+        up.add(true);
+      }
+      // If neighbor is already visited, handle back edges.
+      else {
+        if (tbun.mode() == SCC)
+          if (tbun.on_stack[v])
+            if (tbun.disc[v] < tbun.low[u])
+              tbun.low[u] = tbun.disc[v];
+        // In bridge or articulation mode, skip one edge back to the parent.
+        if (tbun.mode() == BRIDGE || tbun.mode() == ARTICULATION) {
+          if (up.last() && static_cast<int>(v) == tbun.parent[u])
+            up[up.size()-1] = false;
+          else if (tbun.disc[v] < tbun.low[u])
+            tbun.low[u] = tbun.disc[v];
+        }
+      }
+      continue;
+    }
+    // All edges of u are done. Pop its component if u is its root.
+    if (tbun.mode() == SCC && tbun.low[u] == tbun.disc[u]) {
+      dyn_array<size_t> scc;
+      while (!tbun.is_empty()) {
+        size_t scc_node = tbun.pop();
+        tbun.on_stack[scc_node] = false;
+        scc.add(scc_node);
+        if (scc_node == u)
+          break;
+      }
+      tbun.scc_arr.add(scc);
+    }
+    nodes.remove();
+    edges.remove();
+    up.remove();
+    if (nodes.is_empty())
+      break;
+    // Return to the parent p and propagate the lowest discovery time up.
+    size_t p = nodes.last();
+    if (tbun.low[u] < tbun.low[p])
+      tbun.low[p] = tbun.low[u];
+    if (tbun.mode() == BRIDGE && tbun.low[u] > tbun.disc[p]) {
+      dyn_array<size_t> br_edge;
+      (p < u) ? (br_edge = {p, u}) : (br_edge = {u, p});
+      tbun.bridges.add(br_edge);
+    }
+    if (tbun.mode() == ARTICULATION)
+      if (tbun.parent[p] != -1 && tbun.low[u] >= tbun.disc[p])
+        tbun.art_pts[p] = true;
+  }
+  // Root with children is an articulation point.
+  if (tbun.mode() == ARTICULATION)
+    if (tbun.parent[ind] == -1 && children > 1)
+      tbun.art_pts[ind] = true;
+}
+
+template <class T>
+bool csr_graph<T>::build(const dyn_array<size_t>& from,
+                         const dyn_array<size_t>& to,
+                         const dyn_array<int>& weights)
+{
+  size_t num_nodes = this->size();
+  size_t num_edges = from.size();
+  bool is_valid = to.size() == num_edges;
+  is_valid = is_valid && (weights.is_empty() || weights.size() == num_edges);
+  for (size_t e = 0; is_valid && e < num_edges; ++e)
+    is_valid = from[e] < num_nodes && to[e] < num_nodes;
+  if (!is_valid) {
+    std::cerr << "ERROR! Edge list has to hold matching arrays of node ";
+    std::cerr << "indices within graph bounds." << std::endl;
+    this->offs_.clear();
+    this->tgts_.clear();
+    this->wgts_.clear();
+    return false;
+  }
+  // Counting sort edges by target first, then stably by source, which
+  // leaves the edges of each source in increasing target order.
+  dyn_array<size_t> cnt(0, num_nodes + 1);
+  for (size_t e = 0; e < num_edges; ++e)
+    cnt[to[e]+1]++;
+  for (size_t u = 0; u < num_nodes; ++u)
+    cnt[u+1] += cnt[u];
+  dyn_array<size_t> by_tgt(0, num_edges);
+  for (size_t e = 0; e < num_edges; ++e)
+    by_tgt[cnt[to[e]]++] = e;
+  this->offs_ = dyn_array<size_t>(0, num_nodes + 1);
+  for (size_t e = 0; e < num_edges; ++e)
+    this->offs_[from[e]+1]++;
+  for (size_t u = 0; u < num_nodes; ++u)
+    this->offs_[u+1] += this->offs_[u];
+  dyn_array<size_t>& next = cnt;
+  for (size_t u = 0; u < num_nodes; ++u)
+    next[u] = this->offs_[u];
+  this->tgts_ = dyn_array<size_t>(0, num_edges);
+  this->wgts_ = dyn_array<int>(0, weights.is_empty() ? 0 : num_edges);
+  for (size_t i = 0; i < num_edges; ++i) {
+    size_t e = by_tgt[i];
+    size_t slot = next[from[e]]++;
+    this->tgts_[slot] = to[e];
+    if (!weights.is_empty())
+      this->wgts_[slot] = weights[e];
+  }
+  return true;
+}
+
+template <class T>
+dyn_array<size_t> csr_graph<T>::dft(size_t from_ind,
+                                    const std::function<bool(size_t)>& check,
+                                    std::ostream* os_ptr) const
+{
+  size_t num_nodes = this->size();
+  // Parent index of each visited node, num_nodes for unvisited nodes.
+  dyn_array<size_t> parent(num_nodes, num_nodes);
+  dyn_array<size_t> path;
+  // Each frame of the explicit stack holds a node and its next edge.
+  dyn_array<size_t> nodes, edges;
+  parent[from_ind] = from_ind;
+  size_t v = from_ind;
+  while (true) {
+    // Visit v before any of its neighbors.
+    if (os_ptr)
+      *os_ptr << this->vals_[v];
+    path.add(v);
+    if (check(v)) {
+      if (os_ptr)
+        *os_ptr << " [Target Found]";
+      return this->trace_path(v, parent);
+    }
+    nodes.add(v);
+    edges.add(this->offs_[v]);
+    // Pop finished nodes until one has an unvisited neighbor left.
+    v = num_nodes;
+    while (!nodes.is_empty()) {
+      size_t u = nodes.last();
+      size_t& e = edges[edges.size()-1];
+      while (e < this->offs_[u+1] && parent[this->tgts_[e]] != num_nodes)
+        ++e;
+      if (e < this->offs_[u+1]) {
+        v = this->tgts_[e++];
+        parent[v] = u;
+        break;
+      }
+      nodes.remove();
+      edges.remove();
+    }
+    if (v == num_nodes)
+      return path;
+    if (os_ptr)
+      *os_ptr << " -> ";
+  }
+}
+
+template <class T>
+dyn_array<size_t> csr_graph<T>::bft(size_t from_ind,
+                                    const std::function<bool(size_t)>& check,
+                                    std::ostream* os_ptr) const
+{
+  size_t num_nodes = this->size();
+  // Parent index of each visited node, num_nodes for unvisited nodes.
+  dyn_array<size_t> parent(num_nodes, num_nodes);
+  // Dequeued nodes stay in the array, which ends up as the traversal path.
+  dyn_array<size_t> path;
+  path.add(from_ind);
+  parent[from_ind] = from_ind;
+  for (size_t head = 0; head < path.size(); ++head) {
+    size_t u = path[head];
+    if (os_ptr)
+      *os_ptr << this->vals_[u];
+    // If target is found, reconstruct the path from target and return it.
+    if (check(u)) {
+      if (os_ptr)
+        *os_ptr << " [Target Found]";
+      return this->trace_path(u, parent);
+    }
+    // Enqueue all the unvisited neighbors of the current node.
+    for (size_t e = this->offs_[u]; e < this->offs_[u+1]; ++e) {
+      if (parent[this->tgts_[e]] == num_nodes) {
+        parent[this->tgts_[e]] = u;
+        path.add(this->tgts_[e]);
+      }
+    }
+    if (head + 1 < path.size() && os_ptr)
+      *os_ptr << " -> ";
+  }
+  return path;
+}
+
+template <class T>
+dyn_array<size_t> csr_graph<T>::trace_path(
+    size_t ind, const dyn_array<size_t>& parent) const
+{
+  dyn_array<size_t> path;
+  path.add(ind);
+  while (parent[ind] != ind) {
+    ind = parent[ind];
+    path.add(ind);
+  }
+  return path.reverse();
+}
@@ -6,6 +6,15 @@
 #include <initializer_list>
 #include <type_traits>
 #include <random>
+#include <new>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include <string>
+#include <functional>
+#include <atomic>
+#include "simd.h"
+#include "thread_pool.h"
 
 template <class T>
 class dyn_array;
@@ -27,12 +36,134 @@ template <class U>
 using has_int = std::is_integral<typename U::value_type>;
 template <class U>
 using is_dyn = std::enable_if<is_arr<U>::value && has_int<U>::value, int>;
+// True for arithmetic types, std::string and pointers to either, which unique
+// and unique_cnt hash with std::hash, pointers by the value they point to.
+// The member type is the type passed to std::hash.
+template <class U>
+struct can_hash : std::integral_constant<bool,
+    std::is_arithmetic<typename std::remove_cv<
+        typename strip<U>::type>::type>::value ||
+    std::is_same<typename std::remove_cv<typename strip<U>::type>::type,
+                 std::string>::value>
+{
+  typedef typename std::remove_cv<typename strip<U>::type>::type type;
+};
+template <class U>
+using is_rdx = std::enable_if<(std::is_integral<U>::value &&
+                               !std::is_same<U, bool>::value) ||
+                              std::is_same<U, float>::value ||
+                              std::is_same<U, double>::value, int>;
+
+template <class U>
+using is_raw = std::enable_if<std::is_trivially_copyable<U>::value &&
+                              !std::is_pointer<U>::value, int>;
+template <class U>
+using is_nst = std::enable_if<is_arr<U>::value &&
+    std::is_trivially_copyable<typename U::value_type>::value &&
+    !std::is_pointer<typename U::value_type>::value, int>;
+
+// Header of the binary format written by dyn_array<T>::serialize, in native
+// byte order. Flat arrays of trivially copyable elements follow the header
+// with their raw elements. Nested arrays follow it with size + 1 row offsets,
+// counted in elements, then the raw elements of all rows back to back.
+// Elements start at the next multiple of their alignment, so that buffers
+// aligned to 8 bytes can be viewed in place by dyn_view<T>.
+struct array_header
+{
+  // Bumped whenever the layout changes. Readers reject other versions.
+  static const std::uint32_t current = 1;
+
+  char magic[8];
+  std::uint32_t version;
+  // Size of the innermost elements.
+  std::uint32_t elem_size;
+  // 1 for flat arrays, 2 for arrays of arrays.
+  std::uint32_t depth;
+  // Sorted flag of the outermost array.
+  std::int32_t sorted;
+  // Number of elements of flat arrays, or rows of nested ones.
+  std::uint64_t size;
+
+  // Header for an array of the given layout. O(1) | O(1)
+  static array_header make(size_t elem_size, size_t depth, int sorted,
+                           size_t size)
+  {
+    array_header head;
+    std::memcpy(head.magic, "cppdbin", 8);
+    head.version = current;
+    head.elem_size = static_cast<std::uint32_t>(elem_size);
+    head.depth = static_cast<std::uint32_t>(depth);
+    head.sorted = sorted;
+    head.size = size;
+    return head;
+  }
+  // Returns true if the header describes an array of the given layout,
+  // printing what doesn't match otherwise. O(1) | O(1)
+  bool check(size_t elem_size, size_t depth) const
+  {
+    const char* err = nullptr;
+    if (std::memcmp(this->magic, "cppdbin", 8) != 0)
+      err = "Input doesn't hold a serialized dyn_array.";
+    else if (this->version != current)
+      err = "Serialized dyn_array has an unsupported format version.";
+    else if (this->elem_size != elem_size || this->depth != depth)
+      err = "Serialized dyn_array has a different element type.";
+    if (err)
+      std::cerr << "ERROR! " << err << std::endl;
+    return !err;
+  }
+  // Offset of the first element, given the bytes written before it. O(1)
+  static size_t start(size_t pos, size_t align)
+  {
+    return (pos + align - 1) / align * align;
+  }
+};
+
+// Maps float, double and integral values other than bool to unsigned keys of
+// the same size, whose unsigned order matches the order of the values, for
+// radix sorts.
+// Signed integers get their sign bit flipped. Floating-point values get their
+// sign bit flipped if positive, and all bits flipped if negative, which puts
+// -0.0 before 0.0 and NaN values past the infinities of the same sign.
+template <class U, class Enable = void>
+struct radix_key;
+template <class U>
+struct radix_key<U, typename std::enable_if<std::is_integral<U>::value>::type>
+{
+  typedef typename std::make_unsigned<U>::type type;
+  static type get(U v)
+  {
+    const type sign = std::is_signed<U>::value
+        ? static_cast<type>(type(1) << (8 * sizeof(U) - 1)) : type(0);
+    return static_cast<type>(static_cast<type>(v) ^ sign);
+  }
+};
+template <class U>
+struct radix_key<U, typename std::enable_if<
+    std::is_floating_point<U>::value>::type>
+{
+  typedef typename std::conditional<sizeof(U) == 4, std::uint32_t,
+                                    std::uint64_t>::type type;
+  static type get(U v)
+  {
+    const type sign = type(1) << (8 * sizeof(U) - 1);
+    type bits;
+    std::memcpy(&bits, &v, sizeof(U));
+    return (bits & sign) ? ~bits : (bits | sign);
+  }
+};
 
 // Resizable dynamic array. Stores elements in a raw array and dynamically
 // manages its size and capacity much like std::vector does: When size reaches
 // capacity, dyn_array will increase its size to the next power of 2 by
-// allocating a new array of that size, copying over its elements, then
-// deleting its old array, for an amortized cost of O(1).
+// allocating a new array of that size, moving over its elements, then
+// releasing its old array, for an amortized cost of O(1).
+// The raw array is uninitialized storage: Only the first size_ slots hold
+// constructed elements, so growing never default-constructs spare capacity.
+// Elements are moved to new storage, or copied with memcpy if T is trivially
+// copyable. Move construction and assignment steal the raw array of their
+// source, which lets functions return dyn_arrays by value without copying
+// their elements, and emplace constructs new elements in place.
 // Offers a wide range of sorting methods, some enabled only for compatible T
 // types through "Substitution Failure Is Not An Error" (SFINAE).
 // Tracks whether its elements are sorted with a class member that is set to 1
@@ -41,6 +172,12 @@ using is_dyn = std::enable_if<is_arr<U>::value && has_int<U>::value, int>;
 // non-const methods are called.
 // As long as dyn_array is sorted, its search method will run binary search on
 // its elements; at all other times it will run linear search.
+// Linear scans over non-pointer T, namely linear search, min, max, equality
+// and unique, run the SIMD kernels in simd.h, which handle float, double and
+// 32-bit and 64-bit integers with SSE2 or AVX2 picked at runtime, and fall
+// back to scalar loops for all other types.
+// Parallel merge sort, samplesort and radix sort split their work between
+// the threads of a thread_pool, in rounds separated by batch boundaries.
 //
 // The most distinctive feature of dyn_array<T> is in its handling of pointer T
 // types: All sorting algorithms, relational and equality operators, friend
@@ -67,8 +204,9 @@ using is_dyn = std::enable_if<is_arr<U>::value && has_int<U>::value, int>;
 // Many classes also utilize dyn_array<T> objects as data-organizing buffers
 // and as intermediating links to other classes in cppdata.
 //
-// Observes the rule of 3. Owns the memory for its underlying raw array.
-// Does not individually call delete on each raw array element when destroyed.
+// Observes the rule of 5. Owns the memory for its underlying raw array, in
+// which elements are constructed and destroyed one by one as they are added
+// and removed. Pointer elements are not deleted.
 // Assumes T is default-constructable with equality and relational operators.
 template <class T>
 class dyn_array
@@ -88,7 +226,10 @@ class dyn_array
     dyn_array(std::initializer_list<T> list);
     // Duplicates source elements, size and capacity. O(N) | O(N)
     dyn_array(const dyn_array<T>& source);
-    // Destructor deletes the protected raw array list_. O(N) | O(1)
+    // Takes over the raw array of source, leaving it empty. O(1) | O(1)
+    dyn_array(dyn_array<T>&& source);
+    // Destructor destroys the elements, then frees the raw array list_.
+    // O(N) | O(1)
     ~dyn_array();
 
     // Read/write access to array elements. O(1) | O(1)
@@ -106,7 +247,10 @@ class dyn_array
     bool is_empty() const {return this->size_ == 0;}
     // Returns the size of the underlying raw array. O(1) | O(1)
     size_t size() const {return this->size_;}
-    // Deletes the raw array and sets size and capacity to 0. O(N) | O(1)
+    // Returns the number of elements that fit without reallocation. O(1) | O(1)
+    size_t capacity() const {return this->capacity_;}
+    // Deletes the raw array and sets size and capacity to 0. Inline storage of
+    // small_array is kept instead, and keeps its capacity. O(N) | O(1)
     dyn_array<T>& clear();
 
     // Equality check operators compare all elements.
@@ -121,6 +265,8 @@ class dyn_array
     bool operator >= (const dyn_array<T>& other) const;
     // Assignment operator for deep copy from source dyn_array. O(N) | O(N)
     dyn_array<T>& operator = (const dyn_array<T>& source);
+    // Move assignment takes over the raw array of source. O(N) | O(1)
+    dyn_array<T>& operator = (dyn_array<T>&& source);
 
     // Get a copy of dyn_array's min/max element. O(N) | O(1)
     T min() const;
@@ -130,10 +276,20 @@ class dyn_array
 
     // Adds val to list_, reallocs if needed. O(1) average, O(N) worst | O(1)
     dyn_array<T>& add(const T& val);
+    // Moves val into list_, reallocs if needed.
+    // O(1) average, O(N) worst | O(1)
+    dyn_array<T>& add(T&& val);
+    // Constructs a new element at the end of list_ from args, reallocs if
+    // needed. O(1) average, O(N) worst | O(1)
+    template <class... Args>
+    dyn_array<T>& emplace(Args&&... args);
     // Appends an array to list_. O(K) average, O(N+K) worst | O(K)
     dyn_array<T>& add(const T* const arr, size_t start, size_t end);
     // Appends another dyn_array. O(K) average, O(N+K) worst | O(K)
     dyn_array<T>& append(const dyn_array<T>& source);
+    // Moves the elements of another dyn_array, leaving it empty.
+    // O(K) average, O(N+K) worst | O(K)
+    dyn_array<T>& append(dyn_array<T>&& source);
     // Swap the elements at indices i and j. O(1) | O(1)
     dyn_array<T>& swap(size_t i, size_t j);
     // Pops the last element, reducing the size by 1. O(1) | O(1)
@@ -159,6 +315,14 @@ class dyn_array
     dyn_array<T>& quick_sort(bool inc = true);
     // In-place and unstable. O(N*logN) | O(1)
     dyn_array<T>& heap_sort(bool inc = true);
+    // In-place and unstable. Pattern-defeating quicksort: Partitions around
+    // median-of-3 pivots, or ninthers on ranges above 128 elements, and
+    // insertion sorts small ranges. Puts elements equal to the pivot of an
+    // enclosing range aside in one pass, quits early on ranges that partition
+    // without any swaps and then insertion sort with only a few moves, breaks
+    // patterns behind unbalanced partitions with swaps, and heap sorts ranges
+    // after too many of them. O(N*logN) | O(logN)
+    dyn_array<T>& intro_sort(bool inc = true);
 
     // Out-of-place, stable and non-comparison-based.
     // Restricted to T=integral. O(N+K) | O(N+K)
@@ -172,10 +336,11 @@ class dyn_array
     // Restricted to T=dyn_array<integral>. O(N+K) | O(N+K)
     template <class U = T, typename is_dyn<U>::type = 0>
     dyn_array<T> counting_sort(int digit, bool inc = true);
-    // Out-of-place, stable and non-comparison-based.
-    // Restricted to T=integral. O(D*N) | O(N)
-    // Calls counting_sort on each decimal.
-    template <class U = T, typename is_int<U>::type = 0>
+    // Out-of-place, stable and non-comparison-based. LSD radix sort on bytes
+    // of radix_key<T> keys, with one ping-pong buffer. Counts all bytes in a
+    // single pass up front and skips bytes that all elements share.
+    // Restricted to T=integral, float and double. O(B*N) | O(N)
+    template <class U = T, typename is_rdx<U>::type = 0>
     dyn_array<T> radix_sort(bool inc = true);
     // Out-of-place, stable and non-comparison-based.
     // Restricted to T=dyn_array<integral>. O(D*(N+B)) | O(N+B)
@@ -189,17 +354,67 @@ class dyn_array
     template <class U = T, typename is_art<U>::type = 0>
     dyn_array<T> bucket_sort(bool inc = true, size_t num_buckets = 0);
 
+    // Parallel sorts split the work between the threads of pool, or of
+    // thread_pool::shared() if pool is nullptr, and run serially on arrays
+    // of fewer than 16384 elements. P is the number of threads.
+    // Out-of-place and stable. Merge sorts one run per thread, then merges
+    // pairs of runs, splitting every merge into pieces of equal length at
+    // co-ranks found with binary search. O(N*logN/P + N*logP/P) | O(N)
+    dyn_array<T>& par_merge_sort(bool inc = true, thread_pool* pool = nullptr);
+    // Out-of-place and stable. Picks bucket splitters from a random sample,
+    // moves elements to their buckets using per-thread counts, then merge
+    // sorts buckets in parallel. Elements equal to repeated splitters share
+    // a bucket that needs no sorting. O(N*logN/P) average | O(N)
+    dyn_array<T>& sample_sort(bool inc = true, thread_pool* pool = nullptr);
+    // Out-of-place, stable and non-comparison-based. Parallel radix_sort
+    // with per-thread histograms for every byte.
+    // Restricted to T=integral, float and double. O(B*N/P) | O(N)
+    template <class U = T, typename is_rdx<U>::type = 0>
+    dyn_array<T> par_radix_sort(bool inc = true, thread_pool* pool = nullptr);
+
     // Fisher-Yates in-place shuffle.
     dyn_array<T>& shuffle();
     // Reverses the order of elements in-place. O(N) | O(1)
     dyn_array<T>& reverse();
-    // Computes all the permutations of array elements. O(N*N!) | O(N*N!)
+    // Computes all the permutations of array elements, in lexicographic order
+    // of element positions. Use perm_gen or par_permutations beyond about 10
+    // elements. O(N*N!) | O(N*N!)
     dyn_array<dyn_array<T> > permutations() const;
-    // Returns unique values in the array. O(N^2) | O(N)
+    // Calls visit on every permutation of array elements until it returns
+    // false, splitting them between the threads of pool by their first few
+    // elements. visit runs concurrently and gets a buffer that is reused for
+    // the next permutation. Returns false if visit stopped the enumeration.
+    // O(N!/P) | O(N*P)
+    bool par_permutations(
+        const std::function<bool(const dyn_array<T>&)>& visit,
+        thread_pool* pool = nullptr) const;
+    // Returns unique values in the array, in order of first appearance.
+    // Scans runs of equal values if sorted, otherwise hashes arithmetic and
+    // std::string values, or the values pointed to by pointer T, and falls
+    // back to comparing against every unique value for all other types.
+    // O(N) sorted or hashed average, O(N*U) otherwise | O(N)
     dyn_array<T> unique() const;
-    // Replaces array with its unique vals, returns their counts. O(N^2) | O(N)
+    // Replaces array with its unique vals, returns their counts. Same
+    // strategies as unique. O(N) sorted or hashed average, O(N*U) otherwise
+    // | O(N)
     dyn_array<size_t> unique_cnt();
 
+    // Writes the array to os in the versioned binary format of array_header,
+    // with one bulk write of the raw bytes of trivially copyable elements,
+    // or of every row of nested arrays. Returns false if os fails.
+    // O(N) | O(1)
+    template <class U = T, typename is_raw<U>::type = 0>
+    bool serialize(std::ostream& os) const;
+    template <class U = T, typename is_nst<U>::type = 0>
+    bool serialize(std::ostream& os) const;
+    // Replaces the elements with ones written by serialize, read in bulk.
+    // Rows of nested arrays come back unsorted. Returns false and leaves the
+    // array empty if the stream holds anything else. O(N) | O(N)
+    template <class U = T, typename is_raw<U>::type = 0>
+    bool deserialize(std::istream& is);
+    template <class U = T, typename is_nst<U>::type = 0>
+    bool deserialize(std::istream& is);
+
     // Utility to compute next power of 2 for memory allocations. O(1) | O(1)
     size_t next_pow_2(size_t n) const;
 
@@ -207,7 +422,44 @@ class dyn_array
     template <class U>
     friend std::ostream& operator << (std::ostream& os,
                                       const dyn_array<U>& al);
+    // Views copy their sorted flag to the arrays they make.
+    template <class U>
+    friend class dyn_view;
+    // Nested arrays read their offsets and rows with read_raw.
+    template <class U>
+    friend class dyn_array;
   protected:
+    // Tag for the constructor that adopts inline storage of small_array.
+    struct local_tag {};
+    // Uses the given inline storage for up to n elements, which is never
+    // released by dyn_array. Used by small_array. O(1) | O(1)
+    dyn_array(T* local, size_t n, local_tag);
+
+    // Allocates uninitialized storage for n elements. O(1) | O(N)
+    static T* allocate(size_t n);
+    // Releases list_ storage unless it's inline, leaving no storage. Expects
+    // all elements to be destroyed or moved out already. Never called on
+    // mapped storage, which mapped_array unmaps itself. O(1) | O(1)
+    void release();
+    // Appends n elements read from the raw bytes in is. Reads in chunks of
+    // at most 1 MiB and grows storage with the bytes actually read, so sizes
+    // taken from corrupt input can't allocate more than the input holds.
+    // Returns false if the stream runs out first. O(N) | O(N)
+    template <class U = T, typename is_raw<U>::type = 0>
+    bool read_raw(std::istream& is, size_t n);
+    // Takes over the elements of source, leaving it empty. Expects this to
+    // hold no elements. Steals the raw array of source unless either array
+    // uses inline or mapped storage, whose elements are moved instead.
+    // O(N) | O(N)
+    void take(dyn_array<T>& source);
+    // Destroys the elements in [from, to) of list_. O(N) | O(1)
+    void destroy(size_t from, size_t to);
+    // Moves n elements from src to uninitialized dst, destroying the sources.
+    // Tag-dispatch on whether T is trivially copyable. O(N) | O(1)
+    static void relocate(T* src, size_t n, T* dst);
+    static void relocate(T* src, size_t n, T* dst, std::true_type);
+    static void relocate(T* src, size_t n, T* dst, std::false_type);
+
     // Tag-dispatch methods for dereferenced/direct element comparisons.
     // Choice of the type of comparison is decided based on type of T.
     // They return:
@@ -219,28 +471,180 @@ class dyn_array
     int compare(const T& v1, const T& v2, bool inc, val) const;
     int check(size_t i, const typename strip<T>::type& v, bool inc, ptr) const;
     int check(size_t i, const typename strip<T>::type& v, bool inc, val) const;
+    // Tag-dispatch methods for linear scans. Dereference pointer T, and run
+    // SIMD kernels on direct values. O(N) | O(1)
+    size_t find_next(size_t i, const typename strip<T>::type& qr, ptr) const;
+    size_t find_next(size_t i, const typename strip<T>::type& qr, val) const;
+    T extreme(bool inc, ptr) const;
+    T extreme(bool inc, val) const;
+    bool equal(const dyn_array<T>& other, ptr) const;
+    bool equal(const dyn_array<T>& other, val) const;
+    // Tag-dispatch methods for unique and unique_cnt. Add the first instance
+    // of every distinct value to rep, in order, and its count to cnt unless
+    // cnt is nullptr. Hash or compare dereferenced pointer T values.
+    // O(N) sorted or hashed average, O(N*U) otherwise | O(U)
+    void uniques(dyn_array<T>& rep, dyn_array<size_t>* cnt) const;
+    void uniques(dyn_array<T>& rep, dyn_array<size_t>* cnt, std::true_type)
+        const;
+    void uniques(dyn_array<T>& rep, dyn_array<size_t>* cnt, std::false_type)
+        const;
+    // True if the values, or the values pointed to by pointer T, are equal.
+    bool same(const T& v1, const T& v2, ptr) const
+        {return v1 == v2 || (v1 && v2 && *v1 == *v2);}
+    bool same(const T& v1, const T& v2, val) const {return v1 == v2;}
+    // std::hash of the value, or of the value pointed to by pointer T.
+    size_t hash_of(const T& v, ptr) const
+        {return v ? std::hash<typename can_hash<T>::type>()(*v) : 0;}
+    size_t hash_of(const T& v, val) const
+        {return std::hash<typename can_hash<T>::type>()(v);}
 
     // Sift down i-th element on the subarray [0, j) during heap sort.
     dyn_array<T>& sift_down(size_t i, size_t j, bool inc = true);
     // Recursive function for internal use during quick sort.
     dyn_array<T>& quick_rec(bool inc, int left, int right);
+    // Helpers for intro_sort, all working on the subarray [low, high).
+    // True if v1 strictly precedes v2 in sort order. O(1) | O(1)
+    bool precedes(const T& v1, const T& v2, bool inc) const
+        {return this->compare(v1, v2, inc, is_ptr<T>{}) == 1;}
+    // Sorts the elements at indices a, b and c among themselves. O(1) | O(1)
+    void sort3(size_t a, size_t b, size_t c, bool inc);
+    // Sorts [low, high), recursing into the smaller side of each partition
+    // and looping on the larger one. bad is the number of unbalanced
+    // partitions left before falling back to heap sort, and leftmost is
+    // false if the element before low is no greater than all in the range.
+    // O(N*logN) | O(logN)
+    void intro_rec(bool inc, size_t low, size_t high, int bad, bool leftmost);
+    // Partitions around the pivot at low, leaving elements preceding it on
+    // its left. Returns its new index and sets done if no swaps were needed.
+    // O(N) | O(1)
+    size_t part_right(bool inc, size_t low, size_t high, bool& done);
+    // Partitions around the pivot at low, leaving elements equal to it on its
+    // left. Returns its new index. O(N) | O(1)
+    size_t part_left(bool inc, size_t low, size_t high);
+    // Insertion sort that gives up after moving 8 elements if partial is
+    // true. Returns true if it completed. O(N^2), O(N) partial | O(1)
+    bool insertion_range(bool inc, size_t low, size_t high, bool partial);
+    // Heap sort on [low, high). O(N*logN) | O(1)
+    void heap_range(bool inc, size_t low, size_t high);
     // Recursive function for internal use during merge sort.
     void merge_rec(bool inc, size_t low, size_t high, T* aux);
-    // Recursive private helper to compute array element permutations.
-    void perms(dyn_array<dyn_array<T> >& pr, dyn_array<T>& pre) const;
+    // Number of elements in a[0, na) among the first k elements of the stable
+    // merge of a[0, na) and b[0, nb). O(log(N)) | O(1)
+    size_t co_rank(const T* a, size_t na, const T* b, size_t nb, size_t k,
+                   bool inc) const;
+    // Stably merges a[0, na) and b[0, nb) by moving them to dst. O(N) | O(1)
+    void merge_to(T* a, size_t na, T* b, size_t nb, T* dst, bool inc) const;
 
     // Tag-dispatch methods to support the public << ostream overload.
     std::ostream& print_arr(std::ostream& os, ptr) const;
     std::ostream& print_arr(std::ostream& os, val) const;
 
+    // Smallest array size parallel sorts split between threads.
+    static const size_t par_min = 16384;
+
     // Number of elements dyn_array is holding.
     size_t size_;
     // Total capacity allocated for dyn_array on memory.
     size_t capacity_;
-    // Array that holds the data.
+    // Array that holds the data, constructed only up to size_.
     T* list_;
     // 0: unsorted, 1: increasing-order sorted, 2: decreasing-order sorted.
     int sorted_;
+    // True if list_ is inline storage of a small_array.
+    bool local_;
+    // True if list_ points into the file mapping of a mapped_array.
+    bool mapped_;
+    // Grows the mapped storage of an array to n elements. Supplied by
+    // mapped_array<T>, which owns all mapped storage, so that dyn_array<T>
+    // doesn't depend on it or on the platform mapping APIs.
+    static std::atomic<void (*)(dyn_array<T>&, size_t)> remap_;
+};
+
+// Inline-capacity variant of dyn_array<T> that stores up to N elements inside
+// the object itself, in uninitialized storage adopted by its dyn_array<T>
+// base, and only allocates raw arrays on the heap when it outgrows them.
+// Meant for the many tiny arrays that nodes carry, where a separate heap
+// allocation for a few elements costs more memory and cache misses than the
+// elements themselves.
+// Works anywhere a dyn_array<T> does. Once an array spills to the heap, it
+// keeps using heap arrays until destroyed, which keeps moves cheap. Moving
+// from an array that is still inline moves its elements one by one instead
+// of stealing its raw array.
+template <class T, size_t N>
+class small_array : public dyn_array<T>
+{
+  public:
+    // Default constructor starts with the inline storage. O(1) | O(1)
+    small_array()
+        : dyn_array<T>(reinterpret_cast<T*>(buf_), N,
+                       typename dyn_array<T>::local_tag()) {}
+    // Constructor to initialize with n copies of val. O(N) | O(N)
+    small_array(const T& val, size_t n);
+    // Constructs small_array from an initializer_list. O(N) | O(N)
+    small_array(std::initializer_list<T> list);
+    // Copies source elements, inline if they fit. O(N) | O(N)
+    small_array(const small_array<T, N>& source);
+    small_array(const dyn_array<T>& source);
+    // Takes over the elements of source, leaving it empty. O(N) | O(N)
+    small_array(small_array<T, N>&& source);
+    small_array(dyn_array<T>&& source);
+
+    // Assignment operators copy or move source elements. O(N) | O(N)
+    small_array<T, N>& operator = (const small_array<T, N>& source);
+    small_array<T, N>& operator = (const dyn_array<T>& source);
+    small_array<T, N>& operator = (small_array<T, N>&& source);
+    small_array<T, N>& operator = (dyn_array<T>&& source);
+    small_array<T, N>& operator = (std::initializer_list<T> list);
+
+  private:
+    // Inline storage for the first N elements.
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buf_[N];
+};
+
+// Lazy generator of the permutations of a dyn_array<T>, which produces one
+// permutation at a time into a buffer that it reuses, instead of holding all
+// N! of them in memory. Enumerates permutations in lexicographic order of
+// element positions, the same order as dyn_array<T>::permutations, by
+// stepping an array of positions to the next permutation and only copying
+// the elements of the positions that changed, which averages fewer than 3
+// per step. Elements are treated as distinct even if they are equal.
+// A generator can be restricted to the permutations that start with a given
+// prefix of positions, which splits the permutation space into independent
+// blocks for parallel enumeration, as done by par_permutations. Callers that
+// search for a permutation can stop at any time.
+template <class T>
+class perm_gen
+{
+  public:
+    // Generates all permutations of source elements. O(N) | O(N)
+    explicit perm_gen(const dyn_array<T>& source);
+    // Generates the permutations of source elements that start with the
+    // elements at the given distinct positions, in order. O(N) | O(N)
+    perm_gen(const dyn_array<T>& source, const dyn_array<size_t>& prefix);
+
+    // Moves on to the next permutation, or to the first one on the first
+    // call. Returns false once all permutations were generated.
+    // O(1) average, O(N) worst | O(1)
+    bool next();
+    // Returns the current permutation. O(1) | O(1)
+    const dyn_array<T>& current() const {return this->cur_;}
+    // Returns the positions in source of the current permutation's elements.
+    // O(1) | O(1)
+    const dyn_array<size_t>& positions() const {return this->pos_;}
+
+  private:
+    // Copies of the source elements, indexed by position.
+    dyn_array<T> src_;
+    // Source positions of the current permutation.
+    dyn_array<size_t> pos_;
+    // Elements of the current permutation.
+    dyn_array<T> cur_;
+    // Number of leading positions fixed by the prefix.
+    size_t fixed_;
+    // False until the first call to next.
+    bool started_;
+    // True once the last permutation was generated.
+    bool done_;
 };
 
 // Templated class method implementations need to be accessible at the
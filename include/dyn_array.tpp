@@ -10,50 +10,68 @@
 //                                                                      //
 //======================================================================//
 
+template <class T>
+std::atomic<void (*)(dyn_array<T>&, size_t)> dyn_array<T>::remap_(nullptr);
+
 template <class T>
 dyn_array<T>::dyn_array()
-    : size_(0), capacity_(0), list_(nullptr), sorted_(0)
+    : size_(0), capacity_(0), list_(nullptr), sorted_(0), local_(false),
+      mapped_(false)
 {
 }
 
 template <class T>
 dyn_array<T>::dyn_array(const T& val)
-    : size_(1), capacity_(1), list_(new T[1]), sorted_(0)
+    : size_(1),
+      capacity_(1),
+      list_(dyn_array::allocate(1)),
+      sorted_(0),
+      local_(false),
+      mapped_(false)
 {
-  this->list_[0] = val;
+  ::new (static_cast<void*>(this->list_)) T(val);
 }
 
 template <class T>
 dyn_array<T>::dyn_array(const T& val, size_t n)
-    : size_(n), capacity_(n), list_(n > 0 ? new T[n] : nullptr), sorted_(0)
+    : size_(n),
+      capacity_(n),
+      list_(dyn_array::allocate(n)),
+      sorted_(0),
+      local_(false),
+      mapped_(false)
 {
   for (size_t i = 0; i < n; ++i)
-    this->list_[i] = val;
+    ::new (static_cast<void*>(this->list_ + i)) T(val);
 }
 
 template <class T>
 dyn_array<T>::dyn_array(const T* in, size_t start, size_t end)
     : size_(in && end > start ? end-start : 0),
       capacity_(end > start ? end-start : 0),
-      list_(end > start ? new T[end-start] : nullptr),
-      sorted_(0)
+      list_(dyn_array::allocate(end > start ? end-start : 0)),
+      sorted_(0),
+      local_(false),
+      mapped_(false)
 {
   if (in)
     for (size_t i = start; i < end; ++i)
-      this->list_[i-start] = *(in + i);
+      ::new (static_cast<void*>(this->list_ + i - start)) T(*(in + i));
 }
 
 template <class T>
 dyn_array<T>::dyn_array(std::initializer_list<T> list)
     : size_(list.size()),
       capacity_(list.size()),
-      list_(new T[list.size()]),
-      sorted_(0)
+      list_(dyn_array::allocate(list.size())),
+      sorted_(0),
+      local_(false),
+      mapped_(false)
 {
   // Copy elements from the initializer list
   size_t i = 0;
   for (const T& val : list) {
-    this->list_[i++] = val;
+    ::new (static_cast<void*>(this->list_ + i++)) T(val);
   }
 }
 
@@ -62,18 +80,35 @@ dyn_array<T>::dyn_array(const dyn_array<T>& source)
 {
   // Copies allocate exactly the amount of memory needed to match source size
   this->capacity_ = source.size_;
-  this->list_ = new T[this->capacity_];
+  this->list_ = dyn_array::allocate(this->capacity_);
   for (size_t i = 0; i < source.size_; ++i)
-    this->list_[i] = source.list_[i];
+    ::new (static_cast<void*>(this->list_ + i)) T(source.list_[i]);
   this->size_ = source.size_;
   this->sorted_ = source.sorted_;
+  this->local_ = false;
+  this->mapped_ = false;
+}
+
+template <class T>
+dyn_array<T>::dyn_array(dyn_array<T>&& source)
+    : size_(0), capacity_(0), list_(nullptr), sorted_(0), local_(false),
+      mapped_(false)
+{
+  this->take(source);
+}
+
+template <class T>
+dyn_array<T>::dyn_array(T* local, size_t n, local_tag)
+    : size_(0), capacity_(n), list_(local), sorted_(0), local_(true),
+      mapped_(false)
+{
 }
 
 template <class T>
 dyn_array<T>::~dyn_array()
 {
-  if (this->list_)
-    delete[] this->list_;
+  this->destroy(0, this->size_);
+  this->release();
 }
 
 template <class T>
@@ -94,50 +129,52 @@ const T& dyn_array<T>::operator [] (size_t i) const
 template <class T>
 dyn_array<T>& dyn_array<T>::realloc(size_t n)
 {
-  this->capacity_ = n;
-  T* new_list = new T[n];
-  // Copy the existing elements up to previous size or n, whichever is smaller
-  for (size_t i = 0; (i < this->size_) && (i < n); ++i)
-    new_list[i] = this->list_[i];
-  // Delete the old array
-  delete[] this->list_;
+  size_t kept = this->size_ < n ? this->size_ : n;
+  // Inline and mapped storage are kept for as long as they are large enough
+  if ((this->local_ || this->mapped_) && n <= this->capacity_) {
+    this->destroy(kept, this->size_);
+    this->size_ = kept;
+    return *this;
+  }
+  // Mapped storage grows its file instead, which keeps the elements
+  if (this->mapped_) {
+    dyn_array::remap_.load(std::memory_order_relaxed)(*this, n);
+    return *this;
+  }
+  T* new_list = dyn_array::allocate(n);
+  // Move the existing elements up to previous size or n, whichever is smaller
+  dyn_array::relocate(this->list_, kept, new_list);
+  // Destroy the tail elements that didn't fit, then release the old array
+  this->destroy(kept, this->size_);
+  this->release();
   // Set list_ to point to the new array
   this->list_ = new_list;
-  // Adjust size if needed
-  if (n < this->size_)
-    this->size_ = n;
+  this->capacity_ = n;
+  this->size_ = kept;
   return *this;
 }
 
 template <class T>
 dyn_array<T>& dyn_array<T>::resize(size_t n)
 {
-  this->capacity_ = n;
-  T* new_list = new T[n];
-  // Copy the existing elements up to previous size or n, whichever is smaller
-  for (size_t i = 0; (i < this->size_) && (i < n); ++i)
-    new_list[i] = this->list_[i];
-  // Delete the old array
-  delete[] this->list_;
-  // Set list_ to point to the new array
-  this->list_ = new_list;
+  // Move the existing elements up to previous size or n, whichever is smaller
+  if (n != this->capacity_)
+    this->realloc(n);
   // Pad if needed and adjust size
-  if (this->size_ > n)
-    this->size_ = n;
-  else
-    while (this->size_ < n)
-      this->add(T());
+  for (; this->size_ < n; ++this->size_)
+    ::new (static_cast<void*>(this->list_ + this->size_)) T();
+  this->sorted_ = 0;
   return *this;
 }
 
 template <class T>
 dyn_array<T>& dyn_array<T>::clear()
 {
-  if (this->list_)
-    delete[] this->list_;
-  this->list_ = nullptr;
+  this->destroy(0, this->size_);
+  // Inline and mapped storage are kept for reuse
+  if (!this->local_ && !this->mapped_)
+    this->release();
   this->size_ = 0;
-  this->capacity_ = 0;
   this->sorted_ = 0;
   return *this;
 }
@@ -147,11 +184,7 @@ bool dyn_array<T>::operator == (const dyn_array<T>& other) const
 {
   if (this->size_ != other.size_)
     return false;
-  for (size_t i = 0; i < this->size_; ++i) {
-    if (this->compare(this->list_[i], other.list_[i], true, is_ptr<T>{}) != 2)
-      return false;
-  }
-  return true;
+  return this->equal(other, is_ptr<T>{});
 }
 
 template <class T>
@@ -258,30 +291,48 @@ dyn_array<T>& dyn_array<T>::operator = (const dyn_array<T>& source)
   if (this != &source) {
     // Only re-allocate if current capacity is insufficient
     if (this->capacity_ < source.size_) {
-      if (this->list_)
-        delete[] this->list_;
-      this->capacity_ = source.size_;
-      this->list_ = new T[this->capacity_];
+      this->destroy(0, this->size_);
+      this->size_ = 0;
+      if (this->mapped_) {
+        this->realloc(source.size_);
+      }
+      else {
+        this->release();
+        this->capacity_ = source.size_;
+        this->list_ = dyn_array::allocate(this->capacity_);
+      }
     }
-    // Capacity is not updated if it was sufficient to hold all elements
-    for (size_t i = 0; i < source.size_; ++i)
+    // Capacity is not updated if it was sufficient to hold all elements.
+    // Existing elements are assigned to, the rest are constructed in place.
+    size_t common = this->size_ < source.size_ ? this->size_ : source.size_;
+    for (size_t i = 0; i < common; ++i)
       this->list_[i] = source.list_[i];
+    for (size_t i = common; i < source.size_; ++i)
+      ::new (static_cast<void*>(this->list_ + i)) T(source.list_[i]);
+    this->destroy(source.size_, this->size_);
     this->size_ = source.size_;
     this->sorted_ = source.sorted_;
   }
   return *this;
 }
 
+template <class T>
+dyn_array<T>& dyn_array<T>::operator = (dyn_array<T>&& source)
+{
+  if (this != &source) {
+    this->destroy(0, this->size_);
+    this->size_ = 0;
+    this->take(source);
+  }
+  return *this;
+}
+
 template <class T>
 T dyn_array<T>::min() const
 {
   if (this->size_ == 0)
     return T();
-  size_t i_min = 0;
-  for (size_t i = 1; i < this->size_; ++i)
-    if (!this->compare(i_min, i, true))
-      i_min = i;
-  return this->list_[i_min];
+  return this->extreme(true, is_ptr<T>{});
 }
 
 template <class T>
@@ -289,23 +340,53 @@ T dyn_array<T>::max() const
 {
   if (this->size_ == 0)
     return T();
-  size_t i_max = 0;
-  for (size_t i = 1; i < this->size_; ++i)
-    if (!this->compare(i_max, i, false))
-      i_max = i;
-  return this->list_[i_max];
+  return this->extreme(false, is_ptr<T>{});
 }
 
 template <class T>
 dyn_array<T>& dyn_array<T>::add(const T& val)
+{
+  return this->emplace(val);
+}
+
+template <class T>
+dyn_array<T>& dyn_array<T>::add(T&& val)
+{
+  return this->emplace(std::move(val));
+}
+
+template <class T>
+template <class... Args>
+dyn_array<T>& dyn_array<T>::emplace(Args&&... args)
 {
   // Check if list capacity is reached. If full, create a new array with size
   // set to the smallest power of 2 larger than current capacity. This doubles
   // the size of dyn_array if capacity_ is already a power of 2.
-  if (this->size_ == this->capacity_)
+  if (this->size_ == this->capacity_ && this->mapped_) {
+    // Growing the file may move the mapping, so the new element is built
+    // before args can be left dangling.
+    T val(std::forward<Args>(args)...);
     this->realloc(this->next_pow_2(this->capacity_));
-  // Set the value at the next index to val and increment size
-  this->list_[this->size_++] = val;
+    ::new (static_cast<void*>(this->list_ + this->size_)) T(std::move(val));
+  }
+  else if (this->size_ == this->capacity_) {
+    size_t n = this->next_pow_2(this->capacity_);
+    T* new_list = dyn_array::allocate(n);
+    // Construct the new element before moving the old ones, since args may
+    // refer to them.
+    ::new (static_cast<void*>(new_list + this->size_))
+        T(std::forward<Args>(args)...);
+    dyn_array::relocate(this->list_, this->size_, new_list);
+    this->release();
+    this->list_ = new_list;
+    this->capacity_ = n;
+  }
+  // Otherwise construct the new element at the next index
+  else {
+    ::new (static_cast<void*>(this->list_ + this->size_))
+        T(std::forward<Args>(args)...);
+  }
+  this->size_++;
   this->sorted_ = 0;
   return *this;
 }
@@ -319,12 +400,11 @@ dyn_array<T>& dyn_array<T>::add(const T* const arr, size_t start, size_t end)
   // Check if new memory allocation is needed
   if (this->size_ + n >= this->capacity_) {
     // If allocation is needed, allocate in powers of 2
-    this->capacity_ = this->next_pow_2(this->size_ + n);
-    this->realloc(this->capacity_);
+    this->realloc(this->next_pow_2(this->size_ + n));
   }
   // Append the array values to list_
   for (size_t i = start; i < end; ++i)
-    this->list_[this->size_++] = *(arr + i);
+    ::new (static_cast<void*>(this->list_ + this->size_++)) T(*(arr + i));
   this->sorted_ = 0;
   return *this;
 }
@@ -332,15 +412,35 @@ dyn_array<T>& dyn_array<T>::add(const T* const arr, size_t start, size_t end)
 template <class T>
 dyn_array<T>& dyn_array<T>::append(const dyn_array<T>& source)
 {
+  // Source size is fixed upfront in case an array is appended to itself
+  size_t n = source.size_;
   // Check if new memory allocation is needed
-  if (this->size_ + source.size_ > this->capacity_) {
+  if (this->size_ + n > this->capacity_) {
     // If allocation is needed, allocate in powers of 2
-    this->capacity_ = this->next_pow_2(this->size_ + source.size_);
-    this->realloc(this->capacity_);
+    this->realloc(this->next_pow_2(this->size_ + n));
   }
   // Append the source dyn_array<T> values to this->list_
-  for (size_t i = 0; i < source.size_; ++i)
-    this->list_[this->size_++] = source[i];
+  for (size_t i = 0; i < n; ++i)
+    ::new (static_cast<void*>(this->list_ + this->size_++)) T(source[i]);
+  this->sorted_ = 0;
+  return *this;
+}
+
+template <class T>
+dyn_array<T>& dyn_array<T>::append(dyn_array<T>&& source)
+{
+  if (this == &source)
+    return this->append(static_cast<const dyn_array<T>&>(source));
+  // Check if new memory allocation is needed
+  if (this->size_ + source.size_ > this->capacity_) {
+    // If allocation is needed, allocate in powers of 2
+    this->realloc(this->next_pow_2(this->size_ + source.size_));
+  }
+  // Move the source elements over, then leave source empty
+  dyn_array::relocate(source.list_, source.size_, this->list_ + this->size_);
+  this->size_ += source.size_;
+  source.size_ = 0;
+  source.clear();
   this->sorted_ = 0;
   return *this;
 }
@@ -348,9 +448,9 @@ dyn_array<T>& dyn_array<T>::append(const dyn_array<T>& source)
 template <class T>
 dyn_array<T>& dyn_array<T>::swap(size_t i, size_t j)
 {
-  T buf = this->list_[i];
-  this->list_[i] = this->list_[j];
-  this->list_[j] = buf;
+  T buf = std::move(this->list_[i]);
+  this->list_[i] = std::move(this->list_[j]);
+  this->list_[j] = std::move(buf);
   this->sorted_ = 0;
   return *this;
 }
@@ -358,8 +458,8 @@ dyn_array<T>& dyn_array<T>::swap(size_t i, size_t j)
 template <class T>
 T dyn_array<T>::remove()
 {
-  T ret = this->list_[this->size_ - 1];
-  this->list_[this->size_ - 1] = T();
+  T ret = std::move(this->list_[this->size_ - 1]);
+  this->destroy(this->size_ - 1, this->size_);
   this->size_--;
   this->sorted_ = 0;
   return ret;
@@ -392,9 +492,11 @@ dyn_array<size_t> dyn_array<T>::search(const typename strip<T>::type& qr) const
   }
   // Run linear search otherwise.
   else {
-    for (size_t i = 0; i < this->size_; ++i)
-      if (this->check(i, qr, true, is_ptr<T>{}) == 2)
-        ret.add(i);
+    size_t i = this->find_next(0, qr, is_ptr<T>{});
+    while (i < this->size_) {
+      ret.add(i);
+      i = this->find_next(i + 1, qr, is_ptr<T>{});
+    }
   }
   return ret;
 }
@@ -480,6 +582,42 @@ void dyn_array<T>::merge_rec(bool inc, size_t low, size_t high, T* aux)
   return;
 }
 
+template <class T>
+size_t dyn_array<T>::co_rank(const T* a, size_t na, const T* b, size_t nb,
+                             size_t k, bool inc) const
+{
+  // Find the smallest i for which a[i] isn't merged before b[k-i-1].
+  size_t low = k > nb ? k - nb : 0;
+  size_t high = k < na ? k : na;
+  while (low < high) {
+    size_t i = (low + high) / 2;
+    if (this->compare(a[i], b[k - i - 1], inc, is_ptr<T>{}))
+      low = i + 1;
+    else
+      high = i;
+  }
+  return low;
+}
+
+template <class T>
+void dyn_array<T>::merge_to(T* a, size_t na, T* b, size_t nb, T* dst,
+                            bool inc) const
+{
+  size_t i = 0;
+  size_t j = 0;
+  // Ties go to a, which keeps the merge stable.
+  while (i < na && j < nb) {
+    if (this->compare(a[i], b[j], inc, is_ptr<T>{}))
+      *dst++ = std::move(a[i++]);
+    else
+      *dst++ = std::move(b[j++]);
+  }
+  while (i < na)
+    *dst++ = std::move(a[i++]);
+  while (j < nb)
+    *dst++ = std::move(b[j++]);
+}
+
 template <class T>
 dyn_array<T>& dyn_array<T>::selection_sort(bool inc)
 {
@@ -590,6 +728,199 @@ dyn_array<T>& dyn_array<T>::sift_down(size_t i, size_t j, bool inc)
   return *this;
 }
 
+template <class T>
+dyn_array<T>& dyn_array<T>::intro_sort(bool inc)
+{
+  if (this->size_ < 2)
+    return *this;
+  // Allow about log2(N) unbalanced partitions before heap sorting.
+  int bad = 0;
+  for (size_t n = this->size_; n > 1; n >>= 1)
+    bad++;
+  this->intro_rec(inc, 0, this->size_, bad, true);
+  this->sorted_ = inc ? 1 : 2;
+  return *this;
+}
+
+template <class T>
+void dyn_array<T>::sort3(size_t a, size_t b, size_t c, bool inc)
+{
+  T* l = this->list_;
+  if (this->precedes(l[b], l[a], inc))
+    std::swap(l[a], l[b]);
+  if (this->precedes(l[c], l[b], inc)) {
+    std::swap(l[b], l[c]);
+    if (this->precedes(l[b], l[a], inc))
+      std::swap(l[a], l[b]);
+  }
+}
+
+template <class T>
+void dyn_array<T>::intro_rec(bool inc, size_t low, size_t high, int bad,
+                             bool leftmost)
+{
+  // Below this size, insertion sort beats partitioning.
+  const size_t small = 24;
+  // Above this size, pivots are ninthers rather than medians of 3.
+  const size_t large = 128;
+  T* l = this->list_;
+  while (high - low >= small) {
+    size_t n = high - low;
+    size_t mid = low + n / 2;
+    // Move the pivot to low: the median of 3 on ranges of up to large
+    // elements, and the median of 3 medians of 3 above that. Either way, an
+    // element no smaller than the pivot ends up at the end.
+    if (n > large) {
+      this->sort3(low, mid, high - 1, inc);
+      this->sort3(low + 1, mid - 1, high - 2, inc);
+      this->sort3(low + 2, mid + 1, high - 3, inc);
+      this->sort3(mid - 1, mid, mid + 1, inc);
+      std::swap(l[low], l[mid]);
+    }
+    else {
+      this->sort3(mid, low, high - 1, inc);
+    }
+    // If the element before the range equals the pivot, so do all elements
+    // that don't follow the pivot. Put them aside and skip them.
+    if (!leftmost && !this->precedes(l[low - 1], l[low], inc)) {
+      low = this->part_left(inc, low, high) + 1;
+      continue;
+    }
+    bool done;
+    size_t pivot = this->part_right(inc, low, high, done);
+    size_t n_left = pivot - low;
+    size_t n_right = high - pivot - 1;
+    if (n_left < n / 8 || n_right < n / 8) {
+      // Too many unbalanced partitions mean the pivots are being defeated.
+      if (--bad == 0) {
+        this->heap_range(inc, low, high);
+        return;
+      }
+      // Swap elements around to break up patterns that keep pivots bad.
+      if (n_left >= small) {
+        std::swap(l[low], l[low + n_left / 4]);
+        std::swap(l[pivot - 1], l[pivot - n_left / 4]);
+      }
+      if (n_right >= small) {
+        std::swap(l[pivot + 1], l[pivot + 1 + n_right / 4]);
+        std::swap(l[high - 1], l[high - n_right / 4]);
+      }
+    }
+    // A range that needed no swaps is likely sorted already.
+    else if (done && this->insertion_range(inc, low, pivot, true) &&
+             this->insertion_range(inc, pivot + 1, high, true)) {
+      return;
+    }
+    if (n_left < n_right) {
+      this->intro_rec(inc, low, pivot, bad, leftmost);
+      low = pivot + 1;
+      leftmost = false;
+    }
+    else {
+      this->intro_rec(inc, pivot + 1, high, bad, false);
+      high = pivot;
+    }
+  }
+  this->insertion_range(inc, low, high, false);
+}
+
+template <class T>
+size_t dyn_array<T>::part_right(bool inc, size_t low, size_t high, bool& done)
+{
+  T* l = this->list_;
+  // Keep a copy of the pivot at low, which stops scans that reach it.
+  T pivot = l[low];
+  size_t first = low;
+  size_t last = high;
+  // The end of the range holds an element no smaller than the pivot.
+  while (this->precedes(l[++first], pivot, inc));
+  // If no element preceded the pivot, guard the scan from the right.
+  if (first - 1 == low)
+    while (first < last && !this->precedes(l[--last], pivot, inc));
+  else
+    while (!this->precedes(l[--last], pivot, inc));
+  done = first >= last;
+  while (first < last) {
+    std::swap(l[first], l[last]);
+    while (this->precedes(l[++first], pivot, inc));
+    while (!this->precedes(l[--last], pivot, inc));
+  }
+  size_t pos = first - 1;
+  l[low] = std::move(l[pos]);
+  l[pos] = std::move(pivot);
+  return pos;
+}
+
+template <class T>
+size_t dyn_array<T>::part_left(bool inc, size_t low, size_t high)
+{
+  T* l = this->list_;
+  T pivot = l[low];
+  size_t first = low;
+  size_t last = high;
+  while (this->precedes(pivot, l[--last], inc));
+  if (last + 1 == high)
+    while (first < last && !this->precedes(pivot, l[++first], inc));
+  else
+    while (!this->precedes(pivot, l[++first], inc));
+  while (first < last) {
+    std::swap(l[first], l[last]);
+    while (this->precedes(pivot, l[--last], inc));
+    while (!this->precedes(pivot, l[++first], inc));
+  }
+  l[low] = std::move(l[last]);
+  l[last] = std::move(pivot);
+  return last;
+}
+
+template <class T>
+bool dyn_array<T>::insertion_range(bool inc, size_t low, size_t high,
+                                   bool partial)
+{
+  T* l = this->list_;
+  size_t moved = 0;
+  for (size_t i = low + 1; i < high; ++i) {
+    if (!this->precedes(l[i], l[i - 1], inc))
+      continue;
+    T buf = std::move(l[i]);
+    size_t j = i;
+    for (; j > low && this->precedes(buf, l[j - 1], inc); --j)
+      l[j] = std::move(l[j - 1]);
+    l[j] = std::move(buf);
+    moved += i - j;
+    if (partial && moved > 8)
+      return false;
+  }
+  return true;
+}
+
+template <class T>
+void dyn_array<T>::heap_range(bool inc, size_t low, size_t high)
+{
+  T* l = this->list_ + low;
+  size_t n = high - low;
+  // Sift down the element at i on the heap [0, end) of the range, which has
+  // the last element in sort order on top.
+  auto sift = [&](size_t i, size_t end) {
+    while (2 * i + 1 < end) {
+      size_t c = 2 * i + 1;
+      if (c + 1 < end && this->precedes(l[c], l[c + 1], inc))
+        c++;
+      if (!this->precedes(l[i], l[c], inc))
+        break;
+      std::swap(l[i], l[c]);
+      i = c;
+    }
+  };
+  for (size_t i = n / 2; i > 0; --i)
+    sift(i - 1, n);
+  // Move the top to the end of the shrinking heap until it's empty.
+  for (size_t end = n - 1; end > 0; --end) {
+    std::swap(l[0], l[end]);
+    sift(0, end);
+  }
+}
+
 template <class T>
 template <class U, typename is_int<U>::type>
 dyn_array<T> dyn_array<T>::counting_sort(bool inc)
@@ -714,27 +1045,54 @@ dyn_array<T> dyn_array<T>::counting_sort(int digit, bool inc)
 }
 
 template <class T>
-template <class U, typename is_int<U>::type>
+template <class U, typename is_rdx<U>::type>
 dyn_array<T> dyn_array<T>::radix_sort(bool inc)
 {
+  typedef typename radix_key<T>::type key;
+  const size_t bytes = sizeof(key);
   dyn_array<T> ret = *this;
-  if (this->size_ < 2)
+  size_t n = this->size_;
+  if (n < 2) {
+    ret.sorted_ = inc ? 1 : 2;
     return ret;
-  // Find the maximum element while traversing.
-  T el_max = 0;
-  for (size_t i = 0; i < this->size_; ++i)
-    if (el_max < this->list_[i])
-      el_max = this->list_[i];
-  // Compute the number of decimal places in maximum element.
-  T buf = el_max;
-  size_t dec = 1;
-  while (buf >= 10) {
-    dec++;
-    buf = buf / 10;
-  }
-  // Call counting sort on each decimal place, from least to most significant.
-  for (int d = 0; d < dec; ++d)
-    ret = ret.counting_sort(d, inc);
+  }
+  // Flipping all bits of the keys reverses the order.
+  const key flip = inc ? key(0) : static_cast<key>(~key(0));
+  // Count every byte of every key in a single pass.
+  size_t cnt[bytes][256];
+  std::memset(cnt, 0, sizeof(cnt));
+  for (size_t i = 0; i < n; ++i) {
+    key k = static_cast<key>(radix_key<T>::get(this->list_[i]) ^ flip);
+    for (size_t b = 0; b < bytes; ++b)
+      cnt[b][(k >> (8 * b)) & 255]++;
+  }
+  dyn_array<T> buf(T(), n);
+  T* src = ret.list_;
+  T* dst = buf.list_;
+  for (size_t b = 0; b < bytes; ++b) {
+    size_t shift = 8 * b;
+    // Skip the byte if every key has the same value in it.
+    key first = static_cast<key>(radix_key<T>::get(src[0]) ^ flip);
+    if (cnt[b][(first >> shift) & 255] == n)
+      continue;
+    // Turn counts into offsets.
+    size_t sum = 0;
+    for (size_t d = 0; d < 256; ++d) {
+      size_t c = cnt[b][d];
+      cnt[b][d] = sum;
+      sum += c;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      key k = static_cast<key>(radix_key<T>::get(src[i]) ^ flip);
+      dst[cnt[b][(k >> shift) & 255]++] = src[i];
+    }
+    T* tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+  if (src != ret.list_)
+    ret = std::move(buf);
+  ret.sorted_ = inc ? 1 : 2;
   return ret;
 }
 
@@ -810,6 +1168,223 @@ dyn_array<T> dyn_array<T>::bucket_sort(bool inc, size_t num_buckets)
   return ret;
 }
 
+template <class T>
+dyn_array<T>& dyn_array<T>::par_merge_sort(bool inc, thread_pool* pool)
+{
+  thread_pool& tp = pool ? *pool : thread_pool::shared();
+  size_t n = this->size_;
+  size_t p = tp.size();
+  if (p < 2 || n < dyn_array<T>::par_min)
+    return this->merge_sort(inc);
+  T* aux = new T[n];
+  // Merge sort one run per thread, using the same range of aux as scratch.
+  size_t run = (n + p - 1) / p;
+  tp.run(p, [&](size_t r) {
+    size_t low = r * run;
+    size_t high = low + run < n ? low + run : n;
+    if (low < high)
+      this->merge_rec(inc, low, high - 1, aux);
+  });
+  // Merge pairs of runs back and forth between list_ and aux, doubling the
+  // run length every round. Splitting each merge into pieces keeps all
+  // threads busy in the last rounds, when there are fewer pairs than threads.
+  T* src = this->list_;
+  T* dst = aux;
+  for (; run < n; run *= 2) {
+    size_t pairs = (n + 2 * run - 1) / (2 * run);
+    size_t pieces = (p + pairs - 1) / pairs;
+    // Piece t covers [k_0, k_1) of the merged output of pair t / pieces,
+    // taking src[low, low + i_0) from its first run.
+    auto bounds = [&](size_t t, size_t& low, size_t& mid, size_t& high,
+                      size_t& k_0, size_t& k_1) {
+      low = (t / pieces) * 2 * run;
+      mid = low + run < n ? low + run : n;
+      high = mid + run < n ? mid + run : n;
+      k_0 = (high - low) * (t % pieces) / pieces;
+      k_1 = (high - low) * (t % pieces + 1) / pieces;
+    };
+    // Split points are all found before any piece merges, since merging
+    // moves elements out of src that other pieces would still compare.
+    size_t* split = new size_t[pairs * pieces];
+    tp.run(pairs * pieces, [&](size_t t) {
+      size_t low, mid, high, k_0, k_1;
+      bounds(t, low, mid, high, k_0, k_1);
+      split[t] = this->co_rank(src + low, mid - low, src + mid, high - mid,
+                               k_0, inc);
+    });
+    tp.run(pairs * pieces, [&](size_t t) {
+      size_t low, mid, high, k_0, k_1;
+      bounds(t, low, mid, high, k_0, k_1);
+      size_t i_0 = split[t];
+      size_t i_1 = t % pieces + 1 < pieces ? split[t+1] : mid - low;
+      this->merge_to(src + low + i_0, i_1 - i_0, src + mid + k_0 - i_0,
+                     (k_1 - i_1) - (k_0 - i_0), dst + low + k_0, inc);
+    });
+    delete[] split;
+    T* buf = src;
+    src = dst;
+    dst = buf;
+  }
+  // Move the result back if it ended up in aux.
+  if (src != this->list_) {
+    tp.run(p, [&](size_t r) {
+      for (size_t i = r * n / p; i < (r + 1) * n / p; ++i)
+        this->list_[i] = std::move(src[i]);
+    });
+  }
+  delete[] aux;
+  this->sorted_ = inc ? 1 : 2;
+  return *this;
+}
+
+template <class T>
+dyn_array<T>& dyn_array<T>::sample_sort(bool inc, thread_pool* pool)
+{
+  thread_pool& tp = pool ? *pool : thread_pool::shared();
+  size_t n = this->size_;
+  size_t p = tp.size();
+  if (p < 2 || n < dyn_array<T>::par_min)
+    return this->merge_sort(inc);
+  // Several buckets per thread even out the load when buckets are uneven.
+  // Bucket indices are stored in unsigned shorts.
+  size_t b = 4 * p < 65536 ? 4 * p : 65536;
+  const size_t over = 16;
+  // Sort an oversampled random sample and take every over-th element of it
+  // as a splitter. Seeding with the size keeps the sort deterministic.
+  std::mt19937_64 gen(n);
+  dyn_array<T> split;
+  for (size_t i = 0; i < b * over; ++i)
+    split.add(this->list_[gen() % n]);
+  split.merge_sort(inc);
+  for (size_t k = 1; k < b; ++k)
+    split.list_[k - 1] = split.list_[k * over];
+  while (split.size_ > b - 1)
+    split.remove();
+  const T* s = split.list_;
+  // Bucket k holds the elements in [s[k-1], s[k]).
+  size_t chunk = (n + p - 1) / p;
+  unsigned short* ids = new unsigned short[n];
+  size_t* cnt = new size_t[p * b]();
+  tp.run(p, [&](size_t t) {
+    for (size_t i = t * chunk; i < (t + 1) * chunk && i < n; ++i) {
+      const T& el = this->list_[i];
+      // Count splitters that precede or equal the element.
+      size_t low = 0;
+      size_t high = b - 1;
+      while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (this->compare(s[mid], el, inc, is_ptr<T>{}))
+          low = mid + 1;
+        else
+          high = mid;
+      }
+      // Elements equal to a repeated splitter go between its copies.
+      if (low > 1 && this->compare(s[low - 1], el, inc, is_ptr<T>{}) == 2 &&
+          this->compare(s[low - 2], s[low - 1], inc, is_ptr<T>{}) == 2)
+        low--;
+      ids[i] = static_cast<unsigned short>(low);
+      cnt[t * b + low]++;
+    }
+  });
+  // Turn counts into offsets, ordered by bucket first and chunk second,
+  // which keeps the elements of each bucket in their original order.
+  size_t* start = new size_t[b + 1];
+  size_t sum = 0;
+  for (size_t k = 0; k < b; ++k) {
+    start[k] = sum;
+    for (size_t t = 0; t < p; ++t) {
+      size_t c = cnt[t * b + k];
+      cnt[t * b + k] = sum;
+      sum += c;
+    }
+  }
+  start[b] = n;
+  T* aux = new T[n];
+  tp.run(p, [&](size_t t) {
+    for (size_t i = t * chunk; i < (t + 1) * chunk && i < n; ++i)
+      aux[cnt[t * b + ids[i]]++] = std::move(this->list_[i]);
+  });
+  // Move each bucket back in place and sort it, using its range of aux as
+  // scratch. Buckets between equal splitters hold equal elements only.
+  tp.run(b, [&](size_t k) {
+    for (size_t i = start[k]; i < start[k + 1]; ++i)
+      this->list_[i] = std::move(aux[i]);
+    bool same = k > 0 && k < b - 1 &&
+                this->compare(s[k - 1], s[k], inc, is_ptr<T>{}) == 2;
+    if (!same && start[k + 1] - start[k] > 1)
+      this->merge_rec(inc, start[k], start[k + 1] - 1, aux);
+  });
+  delete[] aux;
+  delete[] start;
+  delete[] cnt;
+  delete[] ids;
+  this->sorted_ = inc ? 1 : 2;
+  return *this;
+}
+
+template <class T>
+template <class U, typename is_rdx<U>::type>
+dyn_array<T> dyn_array<T>::par_radix_sort(bool inc, thread_pool* pool)
+{
+  typedef typename radix_key<T>::type key;
+  dyn_array<T> ret = *this;
+  size_t n = this->size_;
+  if (n < 2) {
+    ret.sorted_ = inc ? 1 : 2;
+    return ret;
+  }
+  thread_pool& tp = pool ? *pool : thread_pool::shared();
+  size_t p = n < dyn_array<T>::par_min ? 1 : tp.size();
+  // Flipping all bits of the keys reverses the order.
+  const key flip = inc ? key(0) : static_cast<key>(~key(0));
+  dyn_array<T> buf(T(), n);
+  T* src = ret.list_;
+  T* dst = buf.list_;
+  size_t chunk = (n + p - 1) / p;
+  size_t* cnt = new size_t[p * 256];
+  for (size_t shift = 0; shift < 8 * sizeof(key); shift += 8) {
+    // Each thread counts the bytes in its own chunk.
+    tp.run(p, [&](size_t t) {
+      size_t* c = cnt + t * 256;
+      for (size_t d = 0; d < 256; ++d)
+        c[d] = 0;
+      for (size_t i = t * chunk; i < (t + 1) * chunk && i < n; ++i)
+        c[((radix_key<T>::get(src[i]) ^ flip) >> shift) & 255]++;
+    });
+    // Turn counts into offsets, ordered by byte first and chunk second.
+    // Skip the byte if every element has the same value in it.
+    size_t sum = 0;
+    bool skip = false;
+    for (size_t d = 0; d < 256 && !skip; ++d) {
+      size_t total = 0;
+      for (size_t t = 0; t < p; ++t) {
+        size_t c = cnt[t * 256 + d];
+        cnt[t * 256 + d] = sum;
+        sum += c;
+        total += c;
+      }
+      skip = total == n;
+    }
+    if (skip)
+      continue;
+    tp.run(p, [&](size_t t) {
+      size_t* c = cnt + t * 256;
+      for (size_t i = t * chunk; i < (t + 1) * chunk && i < n; ++i) {
+        key k = static_cast<key>(radix_key<T>::get(src[i]) ^ flip);
+        dst[c[(k >> shift) & 255]++] = src[i];
+      }
+    });
+    T* tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+  delete[] cnt;
+  if (src != ret.list_)
+    ret = std::move(buf);
+  ret.sorted_ = inc ? 1 : 2;
+  return ret;
+}
+
 template <class T>
 dyn_array<T>& dyn_array<T>::shuffle()
 {
@@ -851,53 +1426,61 @@ template <class T>
 dyn_array<dyn_array<T> > dyn_array<T>::permutations() const
 {
   dyn_array<dyn_array<T> > perms;
-  if (this->size_ == 0)
-    return perms;
-  dyn_array<T> prefix;
-  this->perms(perms, prefix);
+  perm_gen<T> gen(*this);
+  while (gen.next())
+    perms.add(gen.current());
   return perms;
 }
 
 template <class T>
-void dyn_array<T>::perms(dyn_array<dyn_array<T> >& pr, dyn_array<T>& pre) const
+bool dyn_array<T>::par_permutations(
+    const std::function<bool(const dyn_array<T>&)>& visit,
+    thread_pool* pool) const
 {
-  if (this->size_ == 1) {
-    pr.add(pre.add((*this)[0]));
-    pre.remove();
-    return;
-  }
-  // Add each element to pre before recursing.
-  for (size_t i = 0; i < this->size_; ++i) {
-    pre.add((*this)[i]);
-    // Create a new array from remaining elements.
-    dyn_array<T> rem(nullptr, 0, this->size_-1);
-    for (size_t j = 0; j < this->size_; ++j) {
-      if (j == i)
-        continue;
-      rem.add((*this)[j]);
+  thread_pool& tp = pool ? *pool : thread_pool::shared();
+  size_t n = this->size_;
+  if (n == 0)
+    return true;
+  // Permutations that share their first k elements make up a block. Blocks
+  // are much smaller than N!/P, so threads that finish early take more of
+  // them, and an early stop doesn't wait for a large block to run out.
+  size_t k = 0;
+  size_t blocks = 1;
+  while (k < n - 1 && blocks < 8 * tp.size())
+    blocks *= n - k++;
+  std::atomic<bool> stop(false);
+  tp.run(blocks, [&](size_t b) {
+    if (stop.load(std::memory_order_relaxed))
+      return;
+    // Block b has digits in mixed radix n, n-1, ..., each of which picks one
+    // of the positions that are still unused, in increasing order.
+    dyn_array<size_t> unused;
+    for (size_t i = 0; i < n; ++i)
+      unused.add(i);
+    dyn_array<size_t> prefix;
+    size_t div = blocks;
+    for (size_t i = 0; i < k; ++i) {
+      div /= n - i;
+      size_t d = b / div % (n - i);
+      prefix.add(unused[d]);
+      for (size_t j = d; j + 1 < unused.size(); ++j)
+        unused[j] = unused[j + 1];
+      unused.remove();
     }
-    rem.perms(pr, pre);
-    pre.remove();
-  }
-  return;
+    perm_gen<T> gen(*this, prefix);
+    while (!stop.load(std::memory_order_relaxed) && gen.next()) {
+      if (!visit(gen.current()))
+        stop.store(true);
+    }
+  });
+  return !stop.load();
 }
 
 template <class T>
 dyn_array<T> dyn_array<T>::unique() const
 {
   dyn_array<T> ret;
-  for (size_t i = 0; i < this->size_; ++i) {
-    T cur = this->list_[i];
-    bool already_seen = false;
-    for (size_t j = 0; j < ret.size(); ++j) {
-      if (cur == ret[j]) {
-        already_seen = true;
-        break;
-      }
-    }
-    if (!already_seen)
-      ret.add(cur);
-  }
+  this->uniques(ret, nullptr);
   return ret;
 }
 
@@ -906,24 +1489,158 @@ dyn_array<size_t> dyn_array<T>::unique_cnt()
 {
   dyn_array<size_t> cnt;
   dyn_array<T> rep;
+  this->uniques(rep, &cnt);
+  // Unique values of a sorted array are sorted the same way.
+  int sorted = this->sorted_;
+  *this = std::move(rep);
+  this->sorted_ = sorted;
+  return cnt;
+}
+
+template <class T>
+template <class U, typename is_raw<U>::type>
+bool dyn_array<T>::serialize(std::ostream& os) const
+{
+  array_header head = array_header::make(sizeof(T), 1, this->sorted_,
+                                         this->size_);
+  os.write(reinterpret_cast<const char*>(&head), sizeof(head));
+  // The header is 32 bytes long, so elements are aligned for up to that.
+  static_assert(alignof(T) <= sizeof(array_header), "Alignment is too large");
+  os.write(reinterpret_cast<const char*>(this->list_),
+           static_cast<std::streamsize>(this->size_ * sizeof(T)));
+  return os.good();
+}
+
+template <class T>
+template <class U, typename is_nst<U>::type>
+bool dyn_array<T>::serialize(std::ostream& os) const
+{
+  typedef typename T::value_type E;
+  array_header head = array_header::make(sizeof(E), 2, this->sorted_,
+                                         this->size_);
+  os.write(reinterpret_cast<const char*>(&head), sizeof(head));
+  std::uint64_t off = 0;
+  os.write(reinterpret_cast<const char*>(&off), sizeof(off));
   for (size_t i = 0; i < this->size_; ++i) {
-    T cur = this->list_[i];
-    bool already_seen = false;
-    for (size_t j = 0; j < rep.size(); ++j) {
-      if (cur == rep[j]) {
-        already_seen = true;
-        cnt[j]++;
-      }
-    }
-    if (!already_seen) {
-      rep.add(cur);
-      cnt.add(1);
+    off += this->list_[i].size();
+    os.write(reinterpret_cast<const char*>(&off), sizeof(off));
+  }
+  size_t pos = sizeof(head) + (this->size_ + 1) * sizeof(off);
+  const char pad[64] = {0};
+  static_assert(alignof(E) <= sizeof(pad), "Alignment is too large");
+  os.write(pad, static_cast<std::streamsize>(
+      array_header::start(pos, alignof(E)) - pos));
+  for (size_t i = 0; i < this->size_; ++i) {
+    const dyn_array<E>& row = this->list_[i];
+    if (row.size() > 0)
+      os.write(reinterpret_cast<const char*>(&row[0]),
+               static_cast<std::streamsize>(row.size() * sizeof(E)));
+  }
+  return os.good();
+}
+
+template <class T>
+template <class U, typename is_raw<U>::type>
+bool dyn_array<T>::deserialize(std::istream& is)
+{
+  this->clear();
+  array_header head;
+  if (!is.read(reinterpret_cast<char*>(&head), sizeof(head))) {
+    std::cerr << "ERROR! Input is too short for a dyn_array." << std::endl;
+    return false;
+  }
+  if (!head.check(sizeof(T), 1))
+    return false;
+  if (head.size > SIZE_MAX / sizeof(T)) {
+    std::cerr << "ERROR! Serialized dyn_array is too large." << std::endl;
+    return false;
+  }
+  // Elements are trivially copyable, so their bytes can go straight into the
+  // uninitialized storage.
+  if (!this->read_raw(is, static_cast<size_t>(head.size))) {
+    std::cerr << "ERROR! Serialized dyn_array is truncated." << std::endl;
+    this->clear();
+    return false;
+  }
+  this->sorted_ = head.sorted;
+  return true;
+}
+
+template <class T>
+template <class U, typename is_nst<U>::type>
+bool dyn_array<T>::deserialize(std::istream& is)
+{
+  typedef typename T::value_type E;
+  this->clear();
+  array_header head;
+  if (!is.read(reinterpret_cast<char*>(&head), sizeof(head))) {
+    std::cerr << "ERROR! Input is too short for a dyn_array." << std::endl;
+    return false;
+  }
+  if (!head.check(sizeof(E), 2))
+    return false;
+  if (head.size >= SIZE_MAX / sizeof(std::uint64_t)) {
+    std::cerr << "ERROR! Serialized dyn_array is too large." << std::endl;
+    return false;
+  }
+  size_t n = static_cast<size_t>(head.size);
+  dyn_array<std::uint64_t> offs;
+  if (!offs.read_raw(is, n + 1)) {
+    std::cerr << "ERROR! Serialized dyn_array is truncated." << std::endl;
+    return false;
+  }
+  // Offsets have to start at 0, never decrease, and count a number of
+  // elements that fits in memory before any row is allocated.
+  bool valid = offs[0] == 0 && offs[n] <= SIZE_MAX / sizeof(E);
+  for (size_t i = 0; valid && i < n; ++i)
+    valid = offs[i] <= offs[i + 1];
+  if (!valid) {
+    std::cerr << "ERROR! Serialized dyn_array has invalid row offsets.";
+    std::cerr << std::endl;
+    return false;
+  }
+  size_t pos = sizeof(head) + (n + 1) * sizeof(std::uint64_t);
+  is.ignore(static_cast<std::streamsize>(
+      array_header::start(pos, alignof(E)) - pos));
+  this->realloc(n);
+  for (size_t i = 0; is && i < n; ++i) {
+    dyn_array<E> row;
+    if (!row.read_raw(is, static_cast<size_t>(offs[i + 1] - offs[i])))
+      break;
+    this->add(std::move(row));
+  }
+  if (!is || this->size_ != n) {
+    std::cerr << "ERROR! Serialized dyn_array is truncated." << std::endl;
+    this->clear();
+    return false;
+  }
+  this->sorted_ = head.sorted;
+  return true;
+}
+
+template <class T>
+template <class U, typename is_raw<U>::type>
+bool dyn_array<T>::read_raw(std::istream& is, size_t n)
+{
+  assert(n <= SIZE_MAX / sizeof(T) - this->size_ && "read_raw size overflow");
+  const size_t chunk = ((size_t(1) << 20) + sizeof(T) - 1) / sizeof(T);
+  size_t end = this->size_ + n;
+  while (this->size_ < end) {
+    size_t cnt = end - this->size_ < chunk ? end - this->size_ : chunk;
+    // Double the storage as reads succeed, but never past the end.
+    if (this->size_ + cnt > this->capacity_) {
+      size_t cap = 2 * this->capacity_;
+      if (cap < this->size_ + cnt)
+        cap = this->size_ + cnt;
+      this->realloc(cap < end ? cap : end);
     }
+    // Size only counts the elements whose bytes were read in full.
+    if (!is.read(reinterpret_cast<char*>(this->list_ + this->size_),
+                 static_cast<std::streamsize>(cnt * sizeof(T))))
+      return false;
+    this->size_ += cnt;
   }
-  this->resize(rep.size());
-  for (size_t i = 0; i < rep.size(); ++i)
-    this->list_[i] = rep[i];
-  return cnt;
+  return true;
 }
 
 template <class T>
@@ -941,6 +1658,85 @@ size_t dyn_array<T>::next_pow_2(size_t n) const
   return ret + 1;
 }
 
+template <class T>
+T* dyn_array<T>::allocate(size_t n)
+{
+  if (n == 0)
+    return nullptr;
+  return static_cast<T*>(::operator new(n * sizeof(T)));
+}
+
+template <class T>
+void dyn_array<T>::release()
+{
+  if (this->list_ && !this->local_)
+    ::operator delete(this->list_);
+  this->list_ = nullptr;
+  this->capacity_ = 0;
+  this->local_ = false;
+}
+
+template <class T>
+void dyn_array<T>::take(dyn_array<T>& source)
+{
+  // Inline and mapped storage can't change hands, so their elements are
+  // moved instead, into the current storage of this array if they fit.
+  if (source.local_ || source.mapped_ || this->mapped_) {
+    if (this->capacity_ < source.size_ && this->mapped_) {
+      this->realloc(source.size_);
+    }
+    else if (this->capacity_ < source.size_) {
+      this->release();
+      this->list_ = dyn_array::allocate(source.size_);
+      this->capacity_ = source.size_;
+    }
+    dyn_array::relocate(source.list_, source.size_, this->list_);
+  }
+  else {
+    this->release();
+    this->list_ = source.list_;
+    this->capacity_ = source.capacity_;
+    source.list_ = nullptr;
+    source.capacity_ = 0;
+  }
+  this->size_ = source.size_;
+  this->sorted_ = source.sorted_;
+  source.size_ = 0;
+  source.sorted_ = 0;
+}
+
+template <class T>
+void dyn_array<T>::destroy(size_t from, size_t to)
+{
+  if (std::is_trivially_destructible<T>::value)
+    return;
+  for (size_t i = from; i < to; ++i)
+    this->list_[i].~T();
+}
+
+template <class T>
+void dyn_array<T>::relocate(T* src, size_t n, T* dst)
+{
+  dyn_array::relocate(src, n, dst, std::is_trivially_copyable<T>{});
+}
+
+template <class T>
+void dyn_array<T>::relocate(T* src, size_t n, T* dst, std::true_type)
+{
+  if (n > 0)
+    std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src),
+                n * sizeof(T));
+}
+
+template <class T>
+void dyn_array<T>::relocate(T* src, size_t n, T* dst, std::false_type)
+{
+  for (size_t i = 0; i < n; ++i) {
+    ::new (static_cast<void*>(dst + i)) T(std::move(src[i]));
+    src[i].~T();
+  }
+}
+
 template <class T>
 int dyn_array<T>::compare(size_t i, size_t j, bool inc) const
 {
@@ -993,6 +1789,151 @@ int dyn_array<T>::check(size_t i, const typename strip<T>::type& v,
     return inc ? this->list_[i] < v : this->list_[i] > v;
 }
 
+template <class T>
+size_t dyn_array<T>::find_next(size_t i, const typename strip<T>::type& qr,
+                               ptr) const
+{
+  for (; i < this->size_; ++i)
+    if (this->check(i, qr, true, ptr{}) == 2)
+      return i;
+  return this->size_;
+}
+
+template <class T>
+size_t dyn_array<T>::find_next(size_t i, const typename strip<T>::type& qr,
+                               val) const
+{
+  if (i >= this->size_)
+    return this->size_;
+  return i + simd::find(this->list_ + i, this->size_ - i, qr);
+}
+
+template <class T>
+T dyn_array<T>::extreme(bool inc, ptr) const
+{
+  size_t i_ext = 0;
+  for (size_t i = 1; i < this->size_; ++i)
+    if (!this->compare(i_ext, i, inc))
+      i_ext = i;
+  return this->list_[i_ext];
+}
+
+template <class T>
+T dyn_array<T>::extreme(bool inc, val) const
+{
+  return simd::extreme(this->list_, this->size_, inc);
+}
+
+template <class T>
+bool dyn_array<T>::equal(const dyn_array<T>& other, ptr) const
+{
+  for (size_t i = 0; i < this->size_; ++i) {
+    if (this->compare(this->list_[i], other.list_[i], true, ptr{}) != 2)
+      return false;
+  }
+  return true;
+}
+
+template <class T>
+bool dyn_array<T>::equal(const dyn_array<T>& other, val) const
+{
+  return simd::equal(this->list_, other.list_, this->size_);
+}
+
+template <class T>
+void dyn_array<T>::uniques(dyn_array<T>& rep, dyn_array<size_t>* cnt) const
+{
+  if (!this->sorted_) {
+    this->uniques(rep, cnt, can_hash<T>{});
+    return;
+  }
+  // Equal values of a sorted array are next to each other.
+  for (size_t i = 0; i < this->size_; ++i) {
+    const T& cur = this->list_[i];
+    if (i > 0 && this->same(cur, rep.list_[rep.size_ - 1], is_ptr<T>{})) {
+      if (cnt)
+        (*cnt)[cnt->size() - 1]++;
+      continue;
+    }
+    rep.add(cur);
+    if (cnt)
+      cnt->add(1);
+  }
+}
+
+template <class T>
+void dyn_array<T>::uniques(dyn_array<T>& rep, dyn_array<size_t>* cnt,
+                           std::true_type) const
+{
+  // Open addressing with linear probing. Slots hold indices into rep plus
+  // one, or 0 if empty, and are picked by Fibonacci hashing. The hashes of
+  // rep elements rule out most mismatches without comparing values, and
+  // let the table grow without hashing values again.
+  const unsigned long long fib = 11400714819323198485ULL;
+  dyn_array<unsigned long long> hashes;
+  size_t bits = 4;
+  size_t* slots = new size_t[size_t(1) << bits]();
+  for (size_t i = 0; i < this->size_; ++i) {
+    const T& cur = this->list_[i];
+    unsigned long long h = this->hash_of(cur, is_ptr<T>{});
+    size_t mask = (size_t(1) << bits) - 1;
+    size_t s = static_cast<size_t>((h * fib) >> (64 - bits));
+    while (slots[s] && (hashes[slots[s] - 1] != h ||
+           !this->same(rep.list_[slots[s] - 1], cur, is_ptr<T>{})))
+      s = (s + 1) & mask;
+    if (slots[s]) {
+      if (cnt)
+        (*cnt)[slots[s] - 1]++;
+      continue;
+    }
+    rep.add(cur);
+    hashes.add(h);
+    if (cnt)
+      cnt->add(1);
+    slots[s] = rep.size_;
+    // Keep the table at most half full.
+    if (2 * rep.size_ > mask + 1) {
+      delete[] slots;
+      bits++;
+      mask = (size_t(1) << bits) - 1;
+      slots = new size_t[mask + 1]();
+      for (size_t j = 0; j < rep.size_; ++j) {
+        s = static_cast<size_t>((hashes[j] * fib) >> (64 - bits));
+        while (slots[s])
+          s = (s + 1) & mask;
+        slots[s] = j + 1;
+      }
+    }
+  }
+  delete[] slots;
+}
+
+template <class T>
+void dyn_array<T>::uniques(dyn_array<T>& rep, dyn_array<size_t>* cnt,
+                           std::false_type) const
+{
+  for (size_t i = 0; i < this->size_; ++i) {
+    const T& cur = this->list_[i];
+    size_t j = 0;
+    if (is_ptr<T>::value) {
+      while (j < rep.size_ && !this->same(rep.list_[j], cur, is_ptr<T>{}))
+        j++;
+    }
+    else {
+      j = simd::find(rep.list_, rep.size_, cur);
+    }
+    if (j < rep.size_) {
+      if (cnt)
+        (*cnt)[j]++;
+    }
+    else {
+      rep.add(cur);
+      if (cnt)
+        cnt->add(1);
+    }
+  }
+}
+
 template <class T>
 std::ostream& dyn_array<T>::print_arr(std::ostream& os, ptr) const
 {
@@ -1015,3 +1956,170 @@ std::ostream& operator << (std::ostream& os, const dyn_array<T>& al)
   al.print_arr(os, is_ptr<T>{});
   return os;
 }
+
+//======================================================================//
+//                                                                      //
+//                       small_array<T, N> methods                      //
+//                                                                      //
+//======================================================================//
+
+template <class T, size_t N>
+small_array<T, N>::small_array(const T& val, size_t n): small_array()
+{
+  if (n > N)
+    this->realloc(n);
+  for (size_t i = 0; i < n; ++i)
+    this->emplace(val);
+}
+
+template <class T, size_t N>
+small_array<T, N>::small_array(std::initializer_list<T> list): small_array()
+{
+  *this = list;
+}
+
+template <class T, size_t N>
+small_array<T, N>::small_array(const small_array<T, N>& source)
+    : small_array()
+{
+  this->append(source);
+  this->sorted_ = source.sorted_;
+}
+
+template <class T, size_t N>
+small_array<T, N>::small_array(const dyn_array<T>& source): small_array()
+{
+  this->append(source);
+}
+
+template <class T, size_t N>
+small_array<T, N>::small_array(small_array<T, N>&& source): small_array()
+{
+  this->take(source);
+}
+
+template <class T, size_t N>
+small_array<T, N>::small_array(dyn_array<T>&& source): small_array()
+{
+  this->take(source);
+}
+
+template <class T, size_t N>
+small_array<T, N>& small_array<T, N>::operator = (
+    const small_array<T, N>& source)
+{
+  dyn_array<T>::operator = (source);
+  return *this;
+}
+
+template <class T, size_t N>
+small_array<T, N>& small_array<T, N>::operator = (const dyn_array<T>& source)
+{
+  dyn_array<T>::operator = (source);
+  return *this;
+}
+
+template <class T, size_t N>
+small_array<T, N>& small_array<T, N>::operator = (small_array<T, N>&& source)
+{
+  dyn_array<T>::operator = (std::move(source));
+  return *this;
+}
+
+template <class T, size_t N>
+small_array<T, N>& small_array<T, N>::operator = (dyn_array<T>&& source)
+{
+  dyn_array<T>::operator = (std::move(source));
+  return *this;
+}
+
+template <class T, size_t N>
+small_array<T, N>& small_array<T, N>::operator = (
+    std::initializer_list<T> list)
+{
+  this->clear();
+  if (list.size() > this->capacity_)
+    this->realloc(list.size());
+  for (const T& val : list)
+    this->emplace(val);
+  return *this;
+}
+
+//======================================================================//
+//                                                                      //
+//                          perm_gen<T> methods                         //
+//                                                                      //
+//======================================================================//
+
+template <class T>
+perm_gen<T>::perm_gen(const dyn_array<T>& source)
+    : src_(source),
+      cur_(source),
+      fixed_(0),
+      started_(false),
+      done_(source.is_empty())
+{
+  for (size_t i = 0; i < source.size(); ++i)
+    this->pos_.add(i);
+}
+
+template <class T>
+perm_gen<T>::perm_gen(const dyn_array<T>& source,
+                      const dyn_array<size_t>& prefix)
+    : src_(source),
+      fixed_(prefix.size()),
+      started_(false),
+      done_(source.is_empty())
+{
+  size_t n = source.size();
+  dyn_array<bool> used(false, n);
+  for (size_t i = 0; i < prefix.size(); ++i) {
+    if (prefix[i] >= n || used[prefix[i]]) {
+      std::cerr << "ERROR! Prefix has to hold distinct positions of source.";
+      std::cerr << std::endl;
+      this->done_ = true;
+      return;
+    }
+    used[prefix[i]] = true;
+    this->pos_.add(prefix[i]);
+  }
+  // Unused positions follow in increasing order, the first permutation.
+  for (size_t i = 0; i < n; ++i)
+    if (!used[i])
+      this->pos_.add(i);
+  for (size_t i = 0; i < n; ++i)
+    this->cur_.add(source[this->pos_[i]]);
+}
+
+template <class T>
+bool perm_gen<T>::next()
+{
+  if (this->done_)
+    return false;
+  // The constructor sets up the first permutation.
+  if (!this->started_) {
+    this->started_ = true;
+    return true;
+  }
+  dyn_array<size_t>& pos = this->pos_;
+  size_t n = pos.size();
+  // Find the last position that precedes its successor, then swap it with
+  // the last position after it that is larger. Positions after it are in
+  // decreasing order, and reversing them makes them the smallest suffix.
+  size_t i = n - 1;
+  while (i > this->fixed_ && pos[i - 1] > pos[i])
+    i--;
+  if (i <= this->fixed_) {
+    this->done_ = true;
+    return false;
+  }
+  size_t j = n - 1;
+  while (pos[j] < pos[i - 1])
+    j--;
+  std::swap(pos[i - 1], pos[j]);
+  for (size_t lo = i, hi = n - 1; lo < hi; ++lo, --hi)
+    std::swap(pos[lo], pos[hi]);
+  for (size_t m = i - 1; m < n; ++m)
+    this->cur_[m] = this->src_[this->pos_[m]];
+  return true;
+}
@@ -0,0 +1,112 @@
+#ifndef dyn_view_h_
+#define dyn_view_h_
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "dyn_array.h"
+
+// Read-only view of a dyn_array<T> in the binary format of array_header,
+// which references the elements in the serialized buffer in place instead of
+// copying them. Loading a view only checks the header, so buffers holding
+// large arrays, such as read-only mappings of files written by serialize, can
+// be used right away. Views never own their buffer, which has to outlive them
+// and stay unchanged.
+// Elements have to be aligned in memory, which holds for buffers aligned to
+// 8 bytes, as returned by operator new and mmap. Views keep the sorted flag
+// of the serialized array and binary search sorted arrays.
+// The dyn_view<dyn_array<E>> specialization views nested arrays, whose rows
+// are dyn_view<E> views into the same buffer.
+template <class T>
+class dyn_view
+{
+  public:
+    // Starts as an empty view. O(1) | O(1)
+    dyn_view(): data_(nullptr), size_(0), sorted_(0) {}
+    // Views n elements starting at data, sorted as the flag says, with the
+    // same meaning as the sorted flag of dyn_array. O(1) | O(1)
+    dyn_view(const T* data, size_t n, int sorted = 0)
+        : data_(data), size_(n), sorted_(sorted) {}
+
+    // Views the array that dyn_array<T>::serialize wrote to buf[0, len).
+    // Returns false and leaves the view empty if buf holds anything else or
+    // isn't aligned for T. O(1) | O(1)
+    bool load(const void* buf, size_t len);
+    // Returns the i-th element. O(1) | O(1)
+    const T& operator [] (size_t i) const
+    {
+      assert(i < this->size_ && "dyn_view index out of bounds");
+      return this->data_[i];
+    }
+
+    // Returns true if the view holds no elements. O(1) | O(1)
+    bool is_empty() const {return this->size_ == 0;}
+    // Returns the number of viewed elements. O(1) | O(1)
+    size_t size() const {return this->size_;}
+    // Returns the first viewed element. O(1) | O(1)
+    const T* data() const {return this->data_;}
+    // Iterators to support range-based for loops. O(1) | O(1)
+    const T* begin() const {return this->data_;}
+    const T* end() const {return this->data_ + this->size_;}
+    // Returns the index of an element equal to val, or size() if there is
+    // none. Binary search if sorted, linear search otherwise.
+    // O(logN) sorted, O(N) unsorted | O(1)
+    size_t find(const T& val) const;
+    // Copies the viewed elements to a new dyn_array, sorted flag included.
+    // O(N) | O(N)
+    dyn_array<T> to_array() const;
+
+  private:
+    // First viewed element, in a buffer owned by someone else.
+    const T* data_;
+    // Number of viewed elements.
+    size_t size_;
+    // 0: unsorted, 1: increasing-order sorted, 2: decreasing-order sorted.
+    int sorted_;
+};
+
+// View of a nested dyn_array<dyn_array<E>>, whose rows are views into the
+// flat element section of the serialized buffer.
+template <class E>
+class dyn_view<dyn_array<E> >
+{
+  public:
+    // Starts as an empty view. O(1) | O(1)
+    dyn_view(): offs_(nullptr), data_(nullptr), size_(0), sorted_(0) {}
+
+    // Views the nested array that serialize wrote to buf[0, len). Checks
+    // that the row offsets stay inside buf. Returns false and leaves the
+    // view empty if buf holds anything else or isn't aligned. O(R) | O(1)
+    bool load(const void* buf, size_t len);
+    // Returns a view of the i-th row. O(1) | O(1)
+    dyn_view<E> operator [] (size_t i) const
+    {
+      assert(i < this->size_ && "dyn_view index out of bounds");
+      size_t len = static_cast<size_t>(this->offs_[i+1] - this->offs_[i]);
+      return dyn_view<E>(this->data_ + this->offs_[i], len);
+    }
+
+    // Returns true if the view holds no rows. O(1) | O(1)
+    bool is_empty() const {return this->size_ == 0;}
+    // Returns the number of viewed rows. O(1) | O(1)
+    size_t size() const {return this->size_;}
+    // Copies the viewed rows to a new nested dyn_array. O(N) | O(N)
+    dyn_array<dyn_array<E> > to_array() const;
+
+  private:
+    // size_ + 1 offsets of the rows in data_, counted in elements.
+    const std::uint64_t* offs_;
+    // First element of the first row.
+    const E* data_;
+    // Number of viewed rows.
+    size_t size_;
+    // Sorted flag of the outer array.
+    int sorted_;
+};
+
+// Templated class method implementations need to be accessible at the
+// point of instantiation.
+#include "dyn_view.tpp"
+
+#endif
@@ -0,0 +1,126 @@
+// The header is included primarily to get rid of IntelliSense squigglies.
+// The class should build and run properly without it. Header guard protection
+// prevents the apparent circular inclusion from causing any problems.
+#include "dyn_view.h"
+
+//======================================================================//
+//                                                                      //
+//                          dyn_view<T> methods                         //
+//                                                                      //
+//======================================================================//
+
+template <class T>
+bool dyn_view<T>::load(const void* buf, size_t len)
+{
+  *this = dyn_view<T>();
+  const char* bytes = static_cast<const char*>(buf);
+  array_header head;
+  if (!bytes || len < sizeof(head)) {
+    std::cerr << "ERROR! Buffer is too short for a dyn_array." << std::endl;
+    return false;
+  }
+  std::memcpy(&head, bytes, sizeof(head));
+  if (!head.check(sizeof(T), 1))
+    return false;
+  size_t pos = sizeof(head);
+  if (head.size > (len - pos) / sizeof(T)) {
+    std::cerr << "ERROR! Serialized dyn_array is truncated." << std::endl;
+    return false;
+  }
+  if (reinterpret_cast<std::uintptr_t>(bytes + pos) % alignof(T) != 0) {
+    std::cerr << "ERROR! Buffer isn't aligned for its elements." << std::endl;
+    return false;
+  }
+  this->data_ = reinterpret_cast<const T*>(bytes + pos);
+  this->size_ = static_cast<size_t>(head.size);
+  this->sorted_ = head.sorted;
+  return true;
+}
+
+template <class T>
+size_t dyn_view<T>::find(const T& val) const
+{
+  if (!this->sorted_)
+    return simd::find(this->data_, this->size_, val);
+  // Find the first element that doesn't precede val.
+  bool inc = this->sorted_ == 1;
+  size_t low = 0;
+  size_t high = this->size_;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    const T& cur = this->data_[mid];
+    if (inc ? cur < val : cur > val)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low < this->size_ && this->data_[low] == val ? low : this->size_;
+}
+
+template <class T>
+dyn_array<T> dyn_view<T>::to_array() const
+{
+  dyn_array<T> ret(this->data_, 0, this->size_);
+  ret.sorted_ = this->sorted_;
+  return ret;
+}
+
+//======================================================================//
+//                                                                      //
+//                   dyn_view<dyn_array<E>> methods                     //
+//                                                                      //
+//======================================================================//
+
+template <class E>
+bool dyn_view<dyn_array<E> >::load(const void* buf, size_t len)
+{
+  *this = dyn_view<dyn_array<E> >();
+  const char* bytes = static_cast<const char*>(buf);
+  array_header head;
+  if (!bytes || len < sizeof(head)) {
+    std::cerr << "ERROR! Buffer is too short for a dyn_array." << std::endl;
+    return false;
+  }
+  std::memcpy(&head, bytes, sizeof(head));
+  if (!head.check(sizeof(E), 2))
+    return false;
+  const size_t w = sizeof(std::uint64_t);
+  size_t pos = sizeof(head);
+  if (head.size >= (len - pos) / w) {
+    std::cerr << "ERROR! Serialized dyn_array is truncated." << std::endl;
+    return false;
+  }
+  size_t n = static_cast<size_t>(head.size);
+  size_t start = array_header::start(pos + (n + 1) * w, alignof(E));
+  const std::uint64_t* offs =
+      reinterpret_cast<const std::uint64_t*>(bytes + pos);
+  if (reinterpret_cast<std::uintptr_t>(offs) % alignof(std::uint64_t) != 0 ||
+      reinterpret_cast<std::uintptr_t>(bytes + start) % alignof(E) != 0) {
+    std::cerr << "ERROR! Buffer isn't aligned for its elements." << std::endl;
+    return false;
+  }
+  // Rows must be in order and end inside the buffer.
+  bool valid = start <= len && offs[0] == 0;
+  for (size_t i = 0; valid && i < n; ++i)
+    valid = offs[i] <= offs[i + 1];
+  if (!valid || offs[n] > (len - start) / sizeof(E)) {
+    std::cerr << "ERROR! Serialized dyn_array is truncated." << std::endl;
+    return false;
+  }
+  this->offs_ = offs;
+  this->data_ = reinterpret_cast<const E*>(bytes + start);
+  this->size_ = n;
+  this->sorted_ = head.sorted;
+  return true;
+}
+
+template <class E>
+dyn_array<dyn_array<E> > dyn_view<dyn_array<E> >::to_array() const
+{
+  dyn_array<dyn_array<E> > ret;
+  ret.realloc(this->size_);
+  for (size_t i = 0; i < this->size_; ++i)
+    ret.add((*this)[i].to_array());
+  ret.sorted_ = this->sorted_;
+  return ret;
+}
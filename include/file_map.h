@@ -0,0 +1,80 @@
+#ifndef file_map_h_
+#define file_map_h_
+
+#include <iostream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CPPDATA_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-write shared mapping of a whole file into memory. Writes to the mapped
+// bytes go to the file through the page cache, and pages are only read from
+// the file when first touched, so files larger than RAM can be mapped and
+// worked on in place. Resizing the file remaps it, which may move the mapping
+// to a different address.
+//
+// Needs POSIX mmap, which defines CPPDATA_MMAP. On other platforms open fails
+// with an error message and the map stays closed.
+class file_map
+{
+  public:
+    // Expected access patterns, passed on to the kernel to tune read-ahead.
+    enum Advice {NORMAL, SEQUENTIAL, RANDOM, WILL_NEED, DONT_NEED};
+
+    // Starts with no file open. O(1) | O(1)
+    file_map(): fd_(-1), data_(nullptr), length_(0) {}
+    // Mappings are owned by a single map, which can't be copied.
+    file_map(const file_map& other) = delete;
+    // Unmaps and closes the file. O(1) | O(1)
+    ~file_map() {this->close();}
+
+    // Mappings are owned by a single map, which can't be copied.
+    file_map& operator = (const file_map& other) = delete;
+    // Opens the file at path for reading and writing, creating it if it
+    // doesn't exist, and maps all of it. Returns false if it fails, leaving
+    // the map closed. O(1) | O(1)
+    bool open(const std::string& path);
+    // Truncates or extends the file to length bytes and remaps it. Returns
+    // false if it fails, leaving the file and the mapping as they were.
+    // O(1) | O(1)
+    bool resize(size_t length);
+    // Advises the kernel of the access pattern for the mapping. O(1) | O(1)
+    bool advise(Advice advice);
+    // Writes dirty pages back to the file and waits for them. O(N) | O(1)
+    bool sync();
+    // Unmaps and closes the file, if one is open. O(1) | O(1)
+    void close();
+
+    // Returns true if a file is open. O(1) | O(1)
+    bool is_open() const {return this->fd_ >= 0;}
+    // Returns the first mapped byte, or nullptr for empty files. O(1) | O(1)
+    char* data() const {return this->data_;}
+    // Returns the length of the file in bytes. O(1) | O(1)
+    size_t length() const {return this->length_;}
+
+  private:
+    // Maps the first length bytes of the open file. O(1) | O(1)
+    bool map(size_t length);
+    // Changes the mapping to the first length bytes of the open file, which
+    // has to be at least that long. Returns false if it fails, leaving the
+    // mapping as it was. O(1) | O(1)
+    bool remap(size_t length);
+
+    // File descriptor of the open file, -1 if none is open.
+    int fd_;
+    // Start of the mapping, nullptr if nothing is mapped.
+    char* data_;
+    // Mapped length, which is always the length of the file.
+    size_t length_;
+};
+
+// Class method implementations are included for consistency with the
+// templated classes.
+#include "file_map.tpp"
+
+#endif
@@ -0,0 +1,148 @@
+// The header is included primarily to get rid of IntelliSense squigglies.
+// The class should build and run properly without it. Header guard protection
+// prevents the apparent circular inclusion from causing any problems.
+#include "file_map.h"
+
+//======================================================================//
+//                                                                      //
+//                           file_map methods                           //
+//                                                                      //
+//======================================================================//
+
+#ifdef CPPDATA_MMAP
+
+inline bool file_map::open(const std::string& path)
+{
+  this->close();
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    return false;
+  }
+  this->fd_ = fd;
+  if (st.st_size > 0 && !this->map(static_cast<size_t>(st.st_size))) {
+    this->close();
+    return false;
+  }
+  return true;
+}
+
+inline bool file_map::resize(size_t length)
+{
+  if (this->fd_ < 0)
+    return false;
+  if (length == this->length_)
+    return true;
+  size_t old = this->length_;
+  if (length < old) {
+    // Touching mapped pages past the end of the file raises SIGBUS, so the
+    // mapping shrinks before the file does.
+    if (!this->remap(length))
+      return false;
+    if (::ftruncate(this->fd_, static_cast<off_t>(length)) != 0) {
+      this->remap(old);
+      return false;
+    }
+    return true;
+  }
+  // The file grows first, so that the mapping never extends past its end,
+  // and goes back to its old length if the mapping can't follow.
+  if (::ftruncate(this->fd_, static_cast<off_t>(length)) != 0)
+    return false;
+  if (!this->remap(length)) {
+    if (::ftruncate(this->fd_, static_cast<off_t>(old)) != 0)
+      std::cerr << "ERROR! Can't restore the length of a mapped file."
+                << std::endl;
+    return false;
+  }
+  return true;
+}
+
+inline bool file_map::advise(Advice advice)
+{
+  if (!this->data_)
+    return this->fd_ >= 0;
+  const int flags[] = {POSIX_MADV_NORMAL, POSIX_MADV_SEQUENTIAL,
+                       POSIX_MADV_RANDOM, POSIX_MADV_WILLNEED,
+                       POSIX_MADV_DONTNEED};
+  return ::posix_madvise(this->data_, this->length_, flags[advice]) == 0;
+}
+
+inline bool file_map::sync()
+{
+  if (!this->data_)
+    return this->fd_ >= 0;
+  return ::msync(this->data_, this->length_, MS_SYNC) == 0;
+}
+
+inline void file_map::close()
+{
+  if (this->data_)
+    ::munmap(this->data_, this->length_);
+  if (this->fd_ >= 0)
+    ::close(this->fd_);
+  this->fd_ = -1;
+  this->data_ = nullptr;
+  this->length_ = 0;
+}
+
+inline bool file_map::map(size_t length)
+{
+  void* data = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      this->fd_, 0);
+  if (data == MAP_FAILED)
+    return false;
+  this->data_ = static_cast<char*>(data);
+  this->length_ = length;
+  return true;
+}
+
+inline bool file_map::remap(size_t length)
+{
+  if (length == 0) {
+    if (this->data_)
+      ::munmap(this->data_, this->length_);
+    this->data_ = nullptr;
+    this->length_ = 0;
+    return true;
+  }
+  if (!this->data_)
+    return this->map(length);
+#ifdef MREMAP_MAYMOVE
+  // Linux can resize the mapping in place, or move its pages without copying.
+  void* data = ::mremap(this->data_, this->length_, length, MREMAP_MAYMOVE);
+  if (data == MAP_FAILED)
+    return false;
+#else
+  // The new mapping is made first, so that failures keep the old one.
+  void* data = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      this->fd_, 0);
+  if (data == MAP_FAILED)
+    return false;
+  ::munmap(this->data_, this->length_);
+#endif
+  this->data_ = static_cast<char*>(data);
+  this->length_ = length;
+  return true;
+}
+
+#else
+
+inline bool file_map::open(const std::string& path)
+{
+  std::cerr << "ERROR! Can't map " << path << " without POSIX mmap.";
+  std::cerr << std::endl;
+  return false;
+}
+
+inline bool file_map::resize(size_t) {return false;}
+inline bool file_map::advise(Advice) {return false;}
+inline bool file_map::sync() {return false;}
+inline void file_map::close() {}
+inline bool file_map::map(size_t) {return false;}
+inline bool file_map::remap(size_t) {return false;}
+
+#endif
@@ -7,17 +7,22 @@
 #include <initializer_list>
 #include <functional>
 #include <limits>
+#include <atomic>
+#include <cstdint>
 #include "dyn_array.h"
 #include "stack.h"
 
 template <class T> class graph_node;
 template <class T> class graph;
+template <class T> class csr_graph;
 template <class T> class stack;
 template <class K, class V> class hash_table;
 
 using sq_init_list = std::initializer_list<std::initializer_list<int> >;
 template <class T> using gn_ptrs = dyn_array<graph_node<T>*>;
 template <class T> using cgn_ptrs = dyn_array<const graph_node<T>*>;
+template <class T> using gn_adj = small_array<graph_node<T>*, 3>;
+using gn_wgt = small_array<int, 3>;
 
 // Node-only connected graph class where each node holds a value, an index and
 // a dyn_array to store pointers to its neighboring nodes.
@@ -26,6 +31,11 @@ template <class T> using cgn_ptrs = dyn_array<const graph_node<T>*>;
 // Per-node adjacency list representation is inherently capable of supporting
 // both directed and undirected graphs, and the use of dyn_array<T> unlocks
 // support for dynamic graphs.
+// The adjacency list is a small_array<graph_node<T>*, 3>, which keeps up to 3
+// neighbor pointers inside the node itself. This covers every node of the
+// binary_tree<T, P> hierarchy and most trie nodes, which then take a single
+// heap allocation each and keep their child pointers on the node's own cache
+// lines, while high-degree graph nodes spill over to the heap as before.
 //
 // The design intention is for graph_node<T> to also serve as a maximally-
 // configurable base class for all current and future self-referential tree
@@ -217,8 +227,8 @@ class graph_node
 
     // Node's value.
     T val_;
-    // Resizable array holds pointers to other nodes.
-    gn_ptrs<T> adj_;
+    // Resizable array holds pointers to other nodes, the first 3 inline.
+    gn_adj<T> adj_;
     // Node's private index. Utilized for different purposes by other classes.
     size_t ind_;
 };
@@ -265,8 +275,12 @@ class union_find
 // Global unscoped enum of Tarjan's algorithm modes.
 enum TarjanMode {SCC, BRIDGE, ARTICULATION};
 
-// Storage class that bundles all auxiliary variables passed between recursions
-// in Tarjan's algorithm. Allocates only the data structures required by the
+// Edge storage modes of graph<T>. Scoped, so that single node values can't
+// be mistaken for a storage mode by graph<T> constructors.
+enum class EdgeStorage {DENSE, SPARSE};
+
+// Storage class that bundles all auxiliary variables shared by the steps of
+// Tarjan's algorithm. Allocates only the data structures required by the
 // TarjanMode specified in its construction.
 class tarjan_bundle
 {
@@ -298,7 +312,7 @@ class tarjan_bundle
     dyn_array<int> parent;
     // Flags indicating for each node whether it's currently on DFT stack.
     dyn_array<bool> on_stack;
-    // Stack to track recursive node order to build connected components later.
+    // Stack to track depth-first node order to build connected components.
     stack<size_t> dft_stack;
     // Members to store outputs of different modes.
     dyn_array<dyn_array<size_t> > scc_arr;
@@ -334,8 +348,10 @@ class tarjan_bundle
 // adjacency matrix by unweighted graphs, with 0 elements indicating a lack of
 // an edge in either case.
 // This hybrid design also unlocks the complete set of graph_node<T> methods
-// for reuse, and indeed all graph<T> traversals are thin wrappers around their
-// graph_node<T> counterparts that merely convert pointers to indices.
+// for reuse. Traversals still run on graph<T>'s own engines, which visit nodes
+// in the same order as their graph_node<T> counterparts, but track visited
+// nodes and parents in flat arrays addressed by node index rather than in
+// hash tables keyed by pointers, and run on explicit stacks.
 //
 // None of the class methods expose mutable node pointers, and manual edits to
 // the node or edge structure of the graph are disallowed.
@@ -353,6 +369,14 @@ class tarjan_bundle
 // graph is weighted or not; and the class currently runs no compatibility
 // checks based on the contents of its matrix member.
 //
+// Graphs constructed with EdgeStorage::SPARSE skip the matrix and keep edge
+// weights in per-node small_array<int, 3> lists alongside the adjacency lists,
+// with the weight of the n-th adjacency list slot at index n. This sparse mode
+// takes O(N+E) memory, adds nodes in amortized O(1) and removes them in O(N+E),
+// but looks edges up in O(A) instead of O(1) time. Algorithms iterate adjacency
+// lists in both modes, except for neighbors and kahn, which keep visiting
+// neighbors in index order on dense graphs.
+//
 // Assumes T is default-constructable and has equality/inequality operators.
 // Supports 2 types of list/dyn_array inputs for construction and assignment:
 // - 1D list/array to assign values to existing nodes and create the missing
@@ -363,17 +387,26 @@ class tarjan_bundle
 template <class T>
 class graph
 {
+  friend class csr_graph<T>;
   public:
-    graph() {}
-    // Construct from a list of node values. O(1) | O(1)
-    graph(std::initializer_list<T> node_vals);
-    // Construct from a dyn_array of node values. O(N) | O(N)
-    graph(const dyn_array<T>& node_vals);
+    graph(): dense_(true) {}
+    // Construct an empty graph with or without the edge matrix. O(1) | O(1)
+    explicit graph(EdgeStorage storage)
+        : dense_(storage == EdgeStorage::DENSE) {}
+    // Construct from a list of node values. O(N^2) dense, O(N) sparse | O(N)
+    graph(std::initializer_list<T> node_vals,
+          EdgeStorage storage = EdgeStorage::DENSE);
+    // Construct from a dyn_array of node values.
+    // O(N^2) dense, O(N) sparse | O(N)
+    graph(const dyn_array<T>& node_vals,
+          EdgeStorage storage = EdgeStorage::DENSE);
     // Construct from edge matrix as a 2D initializer list. O(N^2) | O(N^2)
-    graph(sq_init_list adj_mat);
+    graph(sq_init_list adj_mat, EdgeStorage storage = EdgeStorage::DENSE);
     // Construct from edge matrix as a 2D dyn_array. O(N^2) | O(N^2)
-    graph(const dyn_array<dyn_array<int> >& adj_mat);
-    // Copy constructor for deep copy of nodes. O(N^2) | O(N^2)
+    graph(const dyn_array<dyn_array<int> >& adj_mat,
+          EdgeStorage storage = EdgeStorage::DENSE);
+    // Deep copy of nodes, edges, weights and storage mode.
+    // O(N^2) dense, O(N+E) sparse | O(N^2) dense, O(N+E) sparse
     graph(const graph<T>& source);
     // Destructor deletes each graph node. O(N) | O(1)
     ~graph();
@@ -391,11 +424,14 @@ class graph
     bool is_empty() const {return this->nodes_.is_empty();}
     // Returns the number of nodes using the node array. O(1) | O(1)
     size_t size() const {return this->nodes_.size();}
-    // Counts the edges using the adjacency/weight matrix. O(N^2) | O(1)
+    // Returns true if edges are also stored in the edge matrix. O(1) | O(1)
+    bool is_dense() const {return this->dense_;}
+    // Counts the edges using the adjacency lists. O(N+E) | O(1)
     size_t num_edges() const;
-    // Deletes nodes, then clears node array and edge matrix. O(N^2) | O(1)
+    // Deletes nodes, then clears node array and edge storage. O(N+E) | O(1)
     graph<T>& clear();
-    // Clears node adjacency lists and the edge matrix. O(N^2) | O(1)
+    // Clears node adjacency lists and edge weights.
+    // O(N^2) dense, O(N+E) sparse | O(1)
     graph<T>& clear_edges();
 
     // Equality check operators compare node values and edge structure.
@@ -409,7 +445,8 @@ class graph
     bool operator > (const graph<T>& other) const;
     bool operator <= (const graph<T>& other) const;
     bool operator >= (const graph<T>& other) const;
-    // Performs deep copies the node and edge structure. O(N^2+M^2) | O(N^2)
+    // Performs deep copies the node and edge structure, and takes over the
+    // storage mode of source. O(N^2+M^2) dense, O(N+E) sparse | O(N^2)
     graph<T>& operator = (const graph<T>& source);
     // Rebuilds graph edges from the given 2D square adjacency/weight matrix.
     // Preserves existing node values/indices while removing excess nodes.
@@ -431,14 +468,19 @@ class graph
     dyn_array<T> node_vals() const;
     // Returns dyn_array of all node indices with the given value. O(N) | O(N)
     dyn_array<size_t> node_inds(const T& val) const;
-    // Returns dyn_array of neighbors of the node at index ind. O(A) | O(A)
+    // Returns dyn_array of neighbors of the node at index ind, in index order.
+    // O(N) dense, O(AlogA) sparse | O(A)
     dyn_array<size_t> neighbors(size_t ind) const;
-    // Returns a copy of the edge matrix as 2D dyn_array O(N^2) | O(N^2).
-    const dyn_array<dyn_array<int> >& adj_mat() const {return this->edges_;}
+    // Returns the weight of the edge from node i to node j, 0 if there is
+    // none. O(1) dense, O(A) sparse | O(1)
+    int weight(size_t i, size_t j) const;
+    // Returns a copy of the edge matrix as 2D dyn_array, built from the
+    // adjacency lists in sparse mode. O(N^2) | O(N^2)
+    dyn_array<dyn_array<int> > adj_mat() const;
 
     // Creates a graph_node on heap memory holding the given value and no
     // neighbors, then adds it to the graph and returns its index.
-    // O(N) average, O(N^2) worst | O(N)
+    // O(N) average, O(N^2) worst dense, O(1) amortized sparse | O(N)
     size_t add_node(const T& val);
     // Adds a graph_node and all nodes connected to and reachable from it.
     // Matches indices of subgraph nodes to cloned node indices in the graph.
@@ -446,19 +488,24 @@ class graph
     // O((N*S)+(S^2)+E_S) average, O((N^2*S)+(S^2)+E_S) worst | O((N*S)+(S^2))
     size_t add_node(graph_node<T>* subgraph);
     // Removes the graph_node with the given index.
-    // Returns false if node with that index doesn't exist. O(N^2) | O(1)
+    // Returns false if node with that index doesn't exist.
+    // O(N^2) dense, O(N+E) sparse | O(1)
     bool remove_node(size_t ind);
     // Adds a directed edge going from node with index i to node with index j.
-    // Returns false if a node with either index doesn't exist. O(1) | O(1)
+    // Returns false if a node with either index doesn't exist.
+    // O(1) dense, O(A) sparse | O(1)
     bool add_edge(size_t i, size_t j);
-    // Adds a directed weighted edge from node w. index i to node w. index j.
-    // Returns false if a node with either index doesn't exist. O(1) | O(1)
+    // Adds a directed weighted edge from node w. index i to node w. index j,
+    // or updates the weight of an existing edge. Returns false if a node with
+    // either index doesn't exist. O(1) dense, O(A) sparse | O(1)
     bool add_edgew(size_t i, size_t j, int weight);
     // Adds an undirected edge between node with index i and node with index j.
-    // Returns false if a node with either index doesn't exist. O(1) | O(1)
+    // Returns false if a node with either index doesn't exist.
+    // O(1) dense, O(A) sparse | O(1)
     bool add_edge_undir(size_t i, size_t j);
     // Adds an undirected weighted edge between nodes with indices i and j.
-    // Returns false if a node with either index doesn't exist. O(1) | O(1)
+    // Returns false if a node with either index doesn't exist.
+    // O(1) dense, O(A) sparse | O(1)
     bool add_edgew_undir(size_t i, size_t j, int weight);
     // Removes the edge going from node with index i to the node with index j.
     // Returns false if the edge doesn't exist or if an index is out of bounds.
@@ -469,10 +516,10 @@ class graph
     // O(A) average, O(N) worst | O(1)
     bool remove_edge_undir(size_t i, size_t j);
 
-    // Depth-first traverse with graph_node<T> method. O(N+E) | O(N)
+    // Iterative depth-first traverse. O(N+E) | O(N)
     dyn_array<size_t> depth_first_traverse(size_t from_ind,
                                         std::ostream* os_ptr = nullptr) const;
-    // Breadth-first traverse with graph_node<T> method. O(N+E) | O(N)
+    // Breadth-first traverse. O(N+E) | O(N)
     dyn_array<size_t> breadth_first_traverse(size_t from_ind,
                                         std::ostream* os_ptr = nullptr) const;
     // Depth-first search. O(N_D+E_D) average, O(N+E) worst | O(N)
@@ -484,18 +531,25 @@ class graph
     // Bidirectional search. O(N_D/2 + E_D/2) average, O(N+E) worst | O(N)
     dyn_array<size_t> bidirectional_search(size_t i, size_t j,
                                         std::ostream* os_ptr = nullptr) const;
-
-    // Returns pointers to all the nodes with no incoming edges. O(N^2) | O(N)
+    // Level-synchronous parallel breadth-first traverse from src on the
+    // threads of pool, or thread_pool::shared() if pool is nullptr. Returns
+    // hop distances at index 0 and parents on the BFS tree at index 1, both
+    // -1 for unreachable nodes, with src as its own parent. Parents may vary
+    // between runs with more than one thread. O((N+E)/P) | O(N+E)
+    dyn_array<dyn_array<int> > par_breadth_first(size_t src,
+                                        thread_pool* pool = nullptr) const;
+
+    // Returns indices of all the nodes with no incoming edges. O(N+E) | O(N)
     dyn_array<size_t> find_roots() const;
-    // Runs 3-color depth-first traversal with hash tables. O(N+E) | O(N)
+    // Runs 3-color iterative depth-first traversal. O(N+E) | O(N)
     bool has_cycle() const;
     // Computes node in-degrees, then sorts with depth-first traversal. Returns
     // topologically sorted indices, empty if cycles exist. O(N+E) | O(N)
     dyn_array<T> topological_sort() const;
     // Finds strongly-connected components of a directed graph. O(N+E) | O(N)
     dyn_array<dyn_array<size_t> > strongly_conn_comp() const;
-    // Finds weakly-connected components using hashed depth-first traversal and
-    // union-find to return contiguous labels in index order. O(N+E) | O(N)
+    // Finds weakly-connected components using union-find to return
+    // contiguous labels in index order. O(N+E) | O(N)
     dyn_array<int> weakly_conn_comp() const;
     // Finds all cut-edges, which are edges whose deletion would increase the
     // graph's number of connected components. O(N+E) | O(N)
@@ -511,10 +565,12 @@ class graph
     // For unreachable nodes, returns -1 distance. O((N+E)*logN) | O(N*D)
     dyn_array<dyn_array<int> > dijkstra(size_t src, bool accumulate = 1) const;
     // Kahn's algorithm for topological sorting and cycle detection. Returns
-    // topologically sorted indices, incomplete if cycles exist. O(N+E) | O(N)
+    // topologically sorted indices, incomplete if cycles exist.
+    // O(N^2) dense, O(N+E) sparse | O(N)
     dyn_array<size_t> kahn() const;
     // Tarjan's algorithm with 3 different modes for finding strongly connected
-    // components, bridges and articulation points. O(N+E) | O(N)
+    // components, bridges and articulation points, on an explicit stack.
+    // O(N+E) | O(N)
     void tarjan(size_t ind, tarjan_bundle& tbun) const;
 
     // Prints node indices and values. O(N) | O(1)
@@ -533,22 +589,55 @@ class graph
   private:
     // Shared construction engine for all adjacency/weight matrix sources.
     graph<T>& build_adj_mat(const dyn_array<dyn_array<int> >& adj_mat);
-    // Recursive backend for cycle detection.
-    bool cycle_rec(size_t ind,
-                   hash_table<uintptr_t, bool>& visited,
-                   hash_table<uintptr_t, bool>& in_stack) const;
-    // Recursive backend for connected component labeling.
-    // Returns an array of labels encountered during traversal.
-    void comp_rec(size_t ind,
-                  hash_table<uintptr_t, int>& ht,
-                  dyn_array<int>& conn_lbl,
-                  union_find& uf) const;
+    // Sets up edge storage with no edges for sz nodes.
+    // O(N^2) dense, O(N) sparse | O(N^2) dense, O(N) sparse
+    void init_edges(size_t sz);
+    // Copies nodes, edges and weights of source into this empty graph.
+    void copy_from(const graph<T>& source);
+    // Returns the adjacency list slot of node i that points to node j, or
+    // the size of the list if there is none. O(A) | O(1)
+    size_t find_slot(size_t i, size_t j) const;
+    // Returns the weight of the edge in the n-th adjacency list slot of node
+    // i. O(1) | O(1)
+    int slot_w(size_t i, size_t n) const;
+    // Adds the edge from node i to node j with weight w, or updates its
+    // weight if it exists. O(1) dense, O(A) sparse | O(1)
+    void link(size_t i, size_t j, int w);
+    // Removes the edge from node i to node j. Returns false if there is none.
+    // O(A) | O(1)
+    bool unlink(size_t i, size_t j);
+    // Builds the incoming edges of all nodes in CSR form: sources of the edges
+    // into node v are srcs[offs[v], offs[v+1]). O((N+E)/P) | O(N+E)
+    void in_edges(dyn_array<size_t>& offs, dyn_array<size_t>& srcs,
+                  thread_pool& tp) const;
+    // Iterative depth-first engine that visits nodes in the same order as
+    // graph_node<T>::dft. Nodes count as visited once their parent index is
+    // set, which the caller does for from_ind, and unvisited ones hold size().
+    // Appends visited nodes to path in pre- or post-order, and returns true as
+    // soon as check accepts one. O(N+E) | O(N)
+    bool dft(size_t from_ind, const std::function<bool(size_t)>& check,
+             std::ostream* os_ptr, dyn_array<size_t>& parent,
+             dyn_array<size_t>& path, bool is_post = false) const;
+    // Breadth-first engine that returns the path to the first node check
+    // accepts, or the full traversal path if there is none. O(N+E) | O(N)
+    dyn_array<size_t> bft(size_t from_ind,
+                          const std::function<bool(size_t)>& check,
+                          std::ostream* os_ptr) const;
+    // Follows parent indices back from ind to the node that is its own
+    // parent, and returns the path in forward order. O(D) | O(D)
+    dyn_array<size_t> trace_path(size_t ind,
+                                 const dyn_array<size_t>& parent) const;
 
     // Method with template specializtions that determines printout widths.
     void get_dec(int& dec, int& off, int& num, int& max) const;
 
     dyn_array<graph_node<T>*> nodes_;
+    // Adjacency/weight matrix, empty in sparse mode.
     dyn_array<dyn_array<int> > edges_;
+    // Weights of the adjacency list slots of each node, empty in dense mode.
+    dyn_array<gn_wgt> wgts_;
+    // True if edges_ is kept, false for sparse mode.
+    bool dense_;
 };
 
 // Templated class method implementations need to be accessible at the
@@ -14,26 +14,26 @@
 
 template <class T>
 graph_node<T>::graph_node()
-    : val_(T()), adj_(gn_ptrs<T>(nullptr, 2)), ind_(0)
+    : val_(T()), adj_(nullptr, 2), ind_(0)
 {
 }
 
 template <class T>
 graph_node<T>::graph_node(size_t n)
-    : val_(T()), adj_(n > 0 ? gn_ptrs<T>(nullptr, n) : gn_ptrs<T>()), ind_(0)
+    : val_(T()), adj_(nullptr, n), ind_(0)
 {
 }
 
 template <class T>
 graph_node<T>::graph_node(const T& v, size_t n)
-    : val_(v), adj_(n > 0 ? gn_ptrs<T>(nullptr, n) : gn_ptrs<T>()), ind_(0)
+    : val_(v), adj_(nullptr, n), ind_(0)
 {
 }
 
 // Protected constructor for friends and descendants
 template <class T>
 graph_node<T>::graph_node(const T& v, size_t n, size_t i)
-    : val_(v), adj_(n > 0 ? gn_ptrs<T>(nullptr, n) : gn_ptrs<T>()), ind_(i)
+    : val_(v), adj_(nullptr, n), ind_(i)
 {
 }
 
@@ -676,7 +676,8 @@ std::ostream& operator << (std::ostream& os, const graph_node<T>& gn)
 //======================================================================//
 
 template <class T>
-graph<T>::graph(std::initializer_list<T> node_vals)
+graph<T>::graph(std::initializer_list<T> node_vals, EdgeStorage storage)
+    : dense_(storage == EdgeStorage::DENSE)
 {
   this->nodes_.realloc(node_vals.size());
   size_t ind = 0;
@@ -685,12 +686,12 @@ graph<T>::graph(std::initializer_list<T> node_vals)
     cur_node->ind_ = ind++;
     this->nodes_.add(cur_node);
   }
-  size_t sz = this->size();
-  this->edges_ = dyn_array<dyn_array<int> >(dyn_array<int>(0, sz), sz);
+  this->init_edges(this->size());
 }
 
 template <class T>
-graph<T>::graph(const dyn_array<T>& node_vals)
+graph<T>::graph(const dyn_array<T>& node_vals, EdgeStorage storage)
+    : dense_(storage == EdgeStorage::DENSE)
 {
   this->nodes_.realloc(node_vals.size());
   for (size_t ind = 0; ind < node_vals.size(); ++ind) {
@@ -698,12 +699,12 @@ graph<T>::graph(const dyn_array<T>& node_vals)
     cur_node->ind_ = ind;
     this->nodes_.add(cur_node);
   }
-  size_t sz = this->size();
-  this->edges_ = dyn_array<dyn_array<int> >(dyn_array<int>(0, sz), sz);
+  this->init_edges(this->size());
 }
 
 template <class T>
-graph<T>::graph(sq_init_list adj_mat)
+graph<T>::graph(sq_init_list adj_mat, EdgeStorage storage)
+    : dense_(storage == EdgeStorage::DENSE)
 {
   if (adj_mat.size() > 0) {
     size_t nrows = adj_mat.size();
@@ -719,7 +720,9 @@ graph<T>::graph(sq_init_list adj_mat)
 }
 
 template <class T>
-graph<T>::graph(const dyn_array<dyn_array<int> >& adj_mat)
+graph<T>::graph(const dyn_array<dyn_array<int> >& adj_mat,
+                EdgeStorage storage)
+    : dense_(storage == EdgeStorage::DENSE)
 {
   if (adj_mat.size() > 0) {
     size_t nrows = adj_mat.size();
@@ -734,21 +737,9 @@ graph<T>::graph(const dyn_array<dyn_array<int> >& adj_mat)
 }
 
 template <class T>
-graph<T>::graph(const graph<T>& source)
+graph<T>::graph(const graph<T>& source): dense_(source.dense_)
 {
-  this->nodes_.realloc(source.size());
-  // Copy nodes using graph_node copy constructor.
-  for (size_t i = 0; i < source.size(); ++i) {
-    graph_node<T>* cur_node = new graph_node<T>(source[i]);
-    cur_node->adj_.clear();
-    this->nodes_.add(cur_node);
-  }
-  size_t sz = this->size();
-  this->edges_ = dyn_array<dyn_array<int> >(dyn_array<int>(0, sz), sz);
-  // Link each node with its neighbors.
-  for (size_t i = 0; i < source.size(); ++i)
-    for (size_t n = 0; n < source[i].degree(); ++n)
-      this->add_edge(source[i].ind_, source[i](n)->ind_);
+  this->copy_from(source);
 }
 
 template <class T>
@@ -792,10 +783,8 @@ template <class T>
 size_t graph<T>::num_edges() const
 {
   size_t edg_count = 0;
-  for (size_t row = 0; row < this->size(); ++row)
-    for (size_t col = 0; col < this->size(); ++col)
-      if (this->edges_[row][col])
-        edg_count++;
+  for (size_t n = 0; n < this->size(); ++n)
+    edg_count += this->nodes_[n]->degree();
   return edg_count;
 }
 
@@ -808,6 +797,7 @@ graph<T>& graph<T>::clear()
   }
   this->nodes_.clear();
   this->edges_.clear();
+  this->wgts_.clear();
   return *this;
 }
 
@@ -817,7 +807,7 @@ graph<T>& graph<T>::clear_edges()
   size_t sz = this->size();
   for (size_t n = 0; n < sz; ++n)
     this->nodes_[n]->adj_.clear();
-  this->edges_ = dyn_array<dyn_array<int> >(dyn_array<int>(0, sz), sz);
+  this->init_edges(sz);
   return *this;
 }
 
@@ -877,21 +867,8 @@ graph<T>& graph<T>::operator = (const graph<T>& source)
   if (this == &source)
     return *this;
   this->clear();
-  if (source.is_empty())
-    return *this;
-  this->nodes_.realloc(source.size());
-  // Copy nodes using graph_node copy constructor.
-  for (size_t i = 0; i < source.size(); ++i) {
-    graph_node<T>* cur_node = new graph_node<T>(source[i]);
-    cur_node->adj_.clear();
-    this->nodes_.add(cur_node);
-  }
-  size_t sz = this->size();
-  this->edges_ = dyn_array<dyn_array<int> >(dyn_array<int>(0, sz), sz);
-  // Link each node with its neighbors.
-  for (size_t i = 0; i < source.size(); ++i)
-    for (size_t n = 0; n < source[i].degree(); ++n)
-      this->add_edge(source[i].ind_, source[i](n)->ind_);
+  this->dense_ = source.dense_;
+  this->copy_from(source);
   return *this;
 }
 
@@ -1014,9 +991,44 @@ dyn_array<size_t> graph<T>::neighbors(size_t ind) const
 {
   assert(ind < this->size() && "node index out of graph<T> bounds");
   dyn_array<size_t> ret;
-  for (size_t col = 0; col < this->size(); ++col)
-    if (this->edges_[ind][col])
-      ret.add(col);
+  if (this->dense_) {
+    for (size_t col = 0; col < this->size(); ++col)
+      if (this->edges_[ind][col])
+        ret.add(col);
+    return ret;
+  }
+  // Collect neighbor indices from the adjacency list and sort them.
+  const graph_node<T>* node = this->nodes_[ind];
+  for (size_t n = 0; n < node->capacity(); ++n)
+    if ((*node)[n])
+      ret.add((*node)[n]->ind_);
+  return ret.quick_sort();
+}
+
+template <class T>
+int graph<T>::weight(size_t i, size_t j) const
+{
+  if ((i >= this->size()) || (j >= this->size()))
+    return 0;
+  if (this->dense_)
+    return this->edges_[i][j];
+  size_t n = this->find_slot(i, j);
+  return (n < this->nodes_[i]->capacity()) ? this->wgts_[i][n] : 0;
+}
+
+template <class T>
+dyn_array<dyn_array<int> > graph<T>::adj_mat() const
+{
+  if (this->dense_)
+    return this->edges_;
+  size_t sz = this->size();
+  dyn_array<dyn_array<int> > ret(dyn_array<int>(0, sz), sz);
+  for (size_t i = 0; i < sz; ++i) {
+    const graph_node<T>* node = this->nodes_[i];
+    for (size_t n = 0; n < node->capacity(); ++n)
+      if ((*node)[n])
+        ret[i][(*node)[n]->ind_] = this->wgts_[i][n];
+  }
   return ret;
 }
 
@@ -1030,6 +1042,11 @@ size_t graph<T>::add_node(const T& val)
   new_node->ind_ = ret;
   // Add the node's pointer to the nodes_ list.
   this->nodes_.add(new_node);
+  // Sparse graphs only need an empty weight list for the node.
+  if (!this->dense_) {
+    this->wgts_.add(gn_wgt());
+    return ret;
+  }
   // Add a new column to the adjacency/weight matrix.
   for (size_t row = 0; row < ret; ++row)
     this->edges_[row].add(0);
@@ -1066,38 +1083,56 @@ bool graph<T>::remove_node(size_t ind)
   size_t degree = del_node->degree();
   for (size_t n = 0; n < degree; ++n)
     (*del_node)(0) = nullptr;
-  // Clear incoming edges using the adjacency/weight matrix
-  for (size_t row = 0; row < this->size(); ++row) {
-    if (this->edges_[row][ind]) {
+  if (!this->dense_) {
+    // Clear incoming edges by scanning all adjacency lists.
+    for (size_t row = 0; row < this->size(); ++row) {
       graph_node<T>* node_row = this->nodes_[row];
-      for (size_t n = 0; n < node_row->degree(); ++n) {
-        if ((*node_row)(n) == del_node) {
-          (*node_row)(n) = nullptr;
-          break;
+      for (size_t n = 0; n < node_row->capacity(); ++n) {
+        if ((*node_row)[n] == del_node) {
+          (*node_row)[n] = nullptr;
+          this->wgts_[row][n] = 0;
         }
       }
     }
+    // Move weight lists of the following nodes down by one.
+    for (size_t i = ind + 1; i < this->size(); ++i)
+      this->wgts_[i-1] = std::move(this->wgts_[i]);
+    this->wgts_.remove();
   }
-  // Remove its row and column from the adjacency/weight matrix.
-  size_t newsz = this->size() - 1;
-  dyn_array<dyn_array<int> > new_matrix(dyn_array<int>(0, newsz), newsz);
-  for (size_t row = 0; row < this->size(); ++row) {
-    for (size_t col = 0; col < this->size(); ++col) {
-      if ((row == ind) || (col == ind))
-        continue;
-      if (!this->edges_[row][col])
-        continue;
-      if ((row < ind) && (col < ind))
-        new_matrix[row][col] = this->edges_[row][col];
-      else if ((row < ind) && (col > ind))
-        new_matrix[row][col-1] = this->edges_[row][col];
-      else if ((row > ind) && (col < ind))
-        new_matrix[row-1][col] = this->edges_[row][col];
-      else if ((row > ind) && (col > ind))
-        new_matrix[row-1][col-1] = this->edges_[row][col];
+  else {
+    // Clear incoming edges using the adjacency/weight matrix
+    for (size_t row = 0; row < this->size(); ++row) {
+      if (this->edges_[row][ind]) {
+        graph_node<T>* node_row = this->nodes_[row];
+        for (size_t n = 0; n < node_row->degree(); ++n) {
+          if ((*node_row)(n) == del_node) {
+            (*node_row)(n) = nullptr;
+            break;
+          }
+        }
+      }
+    }
+    // Remove its row and column from the adjacency/weight matrix.
+    size_t newsz = this->size() - 1;
+    dyn_array<dyn_array<int> > new_matrix(dyn_array<int>(0, newsz), newsz);
+    for (size_t row = 0; row < this->size(); ++row) {
+      for (size_t col = 0; col < this->size(); ++col) {
+        if ((row == ind) || (col == ind))
+          continue;
+        if (!this->edges_[row][col])
+          continue;
+        if ((row < ind) && (col < ind))
+          new_matrix[row][col] = this->edges_[row][col];
+        else if ((row < ind) && (col > ind))
+          new_matrix[row][col-1] = this->edges_[row][col];
+        else if ((row > ind) && (col < ind))
+          new_matrix[row-1][col] = this->edges_[row][col];
+        else if ((row > ind) && (col > ind))
+          new_matrix[row-1][col-1] = this->edges_[row][col];
+      }
     }
+    this->edges_ = new_matrix;
   }
-  this->edges_ = new_matrix;
   // Update node indices that are greater than the deleted index.
   for (size_t i = ind + 1; i < this->size(); ++i) {
     this->nodes_[i-1] = this->nodes_[i];
@@ -1113,13 +1148,9 @@ bool graph<T>::add_edge(size_t i, size_t j)
 {
   if ((i >= this->size()) || (j >= this->size()))
     return false;
-  // Check/set the corresponding element in the adjacency/weight matrix.
-  if (this->edges_[i][j])
-    return true;
-  else
-    this->edges_[i][j] = 1;
-  // Add pointer to node j to the adjacency list of node i.
-  this->nodes_[i]->adj_.add(this->nodes_[j]);
+  // Existing edges keep their weights.
+  if (!this->weight(i, j))
+    this->link(i, j, 1);
   return true;
 }
 
@@ -1128,13 +1159,7 @@ bool graph<T>::add_edgew(size_t i, size_t j, int weight)
 {
   if ((i >= this->size()) || (j >= this->size()))
     return false;
-  // Check/set the corresponding element in the adjacency/weight matrix.
-  if (this->edges_[i][j] == weight)
-    return true;
-  else
-    this->edges_[i][j] = weight;
-  // Add pointer to node j to the adjacency list of node i.
-  this->nodes_[i]->adj_.add(this->nodes_[j]);
+  this->link(i, j, weight);
   return true;
 }
 
@@ -1143,15 +1168,11 @@ bool graph<T>::add_edge_undir(size_t i, size_t j)
 {
   if ((i >= this->size()) || (j >= this->size()))
     return false;
-  // Check/set the corresponding elements in the adjacency/weight matrix.
-  if (this->edges_[i][j] && this->edges_[j][i])
+  // Both directions weigh 1 unless both edges already exist.
+  if (this->weight(i, j) && this->weight(j, i))
     return true;
-  if (!this->edges_[i][j])
-    this->nodes_[i]->adj_.add(this->nodes_[j]);
-  this->edges_[i][j] = 1;
-  if (!this->edges_[j][i])
-    this->nodes_[j]->adj_.add(this->nodes_[i]);
-  this->edges_[j][i] = 1;
+  this->link(i, j, 1);
+  this->link(j, i, 1);
   return true;
 }
 
@@ -1160,15 +1181,8 @@ bool graph<T>::add_edgew_undir(size_t i, size_t j, int weight)
 {
   if ((i >= this->size()) || (j >= this->size()))
     return false;
-  // Check/set the corresponding elements in the adjacency/weight matrix.
-  if (this->edges_[i][j] == weight && this->edges_[j][i] == weight)
-    return true;
-  if (!this->edges_[i][j])
-    this->nodes_[i]->adj_.add(this->nodes_[j]);
-  this->edges_[i][j] = weight;
-  if (!this->edges_[j][i])
-    this->nodes_[j]->adj_.add(this->nodes_[i]);
-  this->edges_[j][i] = weight;
+  this->link(i, j, weight);
+  this->link(j, i, weight);
   return true;
 }
 
@@ -1177,19 +1191,7 @@ bool graph<T>::remove_edge(size_t i, size_t j)
 {
   if ((i >= this->size()) || (j >= this->size()))
     return false;
-  if (!this->edges_[i][j])
-    return false;
-  // Find and nullify the adjacency pointers.
-  graph_node<T>* node_i = this->nodes_[i];
-  for (size_t n = 0; n < node_i->degree(); ++n) {
-    if ((*node_i)(n) == this->nodes_[j]) {
-      (*node_i)(n) = nullptr;
-      break;
-    }
-  }
-  // Update the adjacency/weight matrix
-  this->edges_[i][j] = 0;
-  return true;
+  return this->unlink(i, j);
 }
 
 template <class T>
@@ -1197,38 +1199,10 @@ bool graph<T>::remove_edge_undir(size_t i, size_t j)
 {
   if ((i >= this->size()) || (j >= this->size()))
     return false;
-  if (!this->edges_[i][j] && !this->edges_[j][i])
-    return false;
-  // Find and nullify the adjacency pointers.
-  bool ret = true;
-  if (edges_[i][j]) {
-    graph_node<T>* node_i = this->nodes_[i];
-    for (size_t n = 0; n < node_i->degree(); ++n) {
-      if ((*node_i)(n) == this->nodes_[j]) {
-        (*node_i)(n) = nullptr;
-        break;
-      }
-    }
-  }
-  else {
-    ret = false;
-  }
-  if (edges_[j][i]) {
-    graph_node<T>* node_j = this->nodes_[j];
-    for (size_t n = 0; n < node_j->degree(); ++n) {
-      if ((*node_j)(n) == this->nodes_[i]) {
-        (*node_j)(n) = nullptr;
-        break;
-      }
-    }
-  }
-  else {
-    ret = false;
-  }
-  // Update the adjacency/weight matrix
-  this->edges_[i][j] = 0;
-  this->edges_[j][i] = 0;
-  return ret;
+  // Remove both directions, and report if either was missing.
+  bool ij = this->unlink(i, j);
+  bool ji = this->unlink(j, i);
+  return ij && ji;
 }
 
 template <class T>
@@ -1236,11 +1210,13 @@ dyn_array<size_t> graph<T>::depth_first_traverse(size_t from_ind,
                                                  std::ostream* os_ptr) const
 {
   assert(from_ind < this->size() && "node index out of graph<T> bounds");
-  gn_ptrs<T> p = this->nodes_[from_ind]->depth_first_traverse(os_ptr);
-  dyn_array<size_t> ret(0, p.size());
-  for (size_t i = 0; i < p.size(); ++i)
-    ret[i] = p[i]->ind_;
-  return ret;
+  dyn_array<size_t> parent(this->size(), this->size());
+  dyn_array<size_t> path;
+  // Lambda always returns false to fully traverse the graph.
+  auto check_none = [](size_t) -> bool {return false;};
+  parent[from_ind] = from_ind;
+  this->dft(from_ind, check_none, os_ptr, parent, path);
+  return path;
 }
 
 template <class T>
@@ -1248,11 +1224,8 @@ dyn_array<size_t> graph<T>::breadth_first_traverse(size_t from_ind,
                                                    std::ostream* os_ptr) const
 {
   assert(from_ind < this->size() && "node index out of graph<T> bounds");
-  gn_ptrs<T> p = this->nodes_[from_ind]->breadth_first_traverse(os_ptr);
-  dyn_array<size_t> ret(0, p.size());
-  for (size_t i = 0; i < p.size(); ++i)
-    ret[i] = p[i]->ind_;
-  return ret;
+  auto check_none = [](size_t) -> bool {return false;};
+  return this->bft(from_ind, check_none, os_ptr);
 }
 
 template <class T>
@@ -1260,11 +1233,17 @@ dyn_array<size_t> graph<T>::depth_first_search(size_t from_ind, const T& val,
                                                std::ostream* os_ptr) const
 {
   assert(from_ind < this->size() && "node index out of graph<T> bounds");
-  gn_ptrs<T> p = this->nodes_[from_ind]->depth_first_search(val, os_ptr);
-  dyn_array<size_t> ret(0, p.size());
-  for (size_t i = 0; i < p.size(); ++i)
-    ret[i] = p[i]->ind_;
-  return ret;
+  dyn_array<size_t> parent(this->size(), this->size());
+  dyn_array<size_t> path;
+  auto check_val = [this, &val](size_t ind) -> bool {
+    return this->nodes_[ind]->val() == val;
+  };
+  parent[from_ind] = from_ind;
+  // If target is found, reconstruct and return the path.
+  if (this->dft(from_ind, check_val, os_ptr, parent, path))
+    return this->trace_path(path.last(), parent);
+  // Otherwise return the full traversal path.
+  return path;
 }
 
 template <class T>
@@ -1272,11 +1251,10 @@ dyn_array<size_t> graph<T>::breadth_first_search(size_t from_ind, const T& val,
                                                  std::ostream* os_ptr) const
 {
   assert(from_ind < this->size() && "node index out of graph<T> bounds");
-  gn_ptrs<T> p = this->nodes_[from_ind]->breadth_first_search(val, os_ptr);
-  dyn_array<size_t> ret(0, p.size());
-  for (size_t i = 0; i < p.size(); ++i)
-    ret[i] = p[i]->ind_;
-  return ret;
+  auto check_val = [this, &val](size_t ind) -> bool {
+    return this->nodes_[ind]->val() == val;
+  };
+  return this->bft(from_ind, check_val, os_ptr);
 }
 
 template <class T>
@@ -1285,78 +1263,292 @@ dyn_array<size_t> graph<T>::bidirectional_search(size_t i, size_t j,
 {
   assert(i < this->size() && "node index i out of graph<T> bounds");
   assert(j < this->size() && "node index j out of graph<T> bounds");
-  gn_ptrs<T> p;
-  p = this->nodes_[i]->bidirectional_search(this->nodes_[j], os_ptr);
-  dyn_array<size_t> ret(0, p.size());
-  for (size_t i = 0; i < p.size(); ++i)
-    ret[i] = p[i]->ind_;
+  dyn_array<size_t> path;
+  // Quick return if the query is the same as the start node.
+  if (i == j)
+    return path.add(i);
+  size_t num_nodes = this->size();
+  // Parent indices of both searches, num_nodes for nodes they haven't reached.
+  dyn_array<size_t> par1(num_nodes, num_nodes), par2(num_nodes, num_nodes);
+  // Dequeued nodes stay in the queues, which hold the traversal paths.
+  dyn_array<size_t> que1, que2;
+  size_t head1 = 0, head2 = 0;
+  que1.add(i);
+  par1[i] = i;
+  que2.add(j);
+  par2[j] = j;
+  while (head1 < que1.size() && head2 < que2.size()) {
+    // Iterate and expand the first node.
+    size_t u1 = que1[head1++];
+    const graph_node<T>* node_u1 = this->nodes_[u1];
+    if (os_ptr)
+      *os_ptr << node_u1->val();
+    for (size_t n = 0; n < node_u1->capacity(); ++n) {
+      if (!(*node_u1)[n] || par1[(*node_u1)[n]->ind_] != num_nodes)
+        continue;
+      size_t v = (*node_u1)[n]->ind_;
+      // If the other search reached this node, it's the intersection.
+      if (par2[v] != num_nodes) {
+        if (os_ptr)
+          *os_ptr << " [Target Found]";
+        path = this->trace_path(u1, par1);
+        return path.append(this->trace_path(v, par2).reverse());
+      }
+      par1[v] = u1;
+      que1.add(v);
+    }
+    // Iterate and expand the second node.
+    size_t u2 = que2[head2++];
+    const graph_node<T>* node_u2 = this->nodes_[u2];
+    if (os_ptr)
+      *os_ptr << " (" << node_u2->val() << ")";
+    for (size_t n = 0; n < node_u2->capacity(); ++n) {
+      if (!(*node_u2)[n] || par2[(*node_u2)[n]->ind_] != num_nodes)
+        continue;
+      size_t v = (*node_u2)[n]->ind_;
+      if (par1[v] != num_nodes) {
+        path = this->trace_path(v, par1);
+        return path.append(this->trace_path(u2, par2).reverse());
+      }
+      par2[v] = u2;
+      que2.add(v);
+    }
+    if (head1 < que1.size() && head2 < que2.size() && os_ptr)
+      *os_ptr << " -> ";
+  }
+  // If path isn't found, return merged traversal paths.
+  path.realloc(head1 + head2);
+  for (size_t n = 0; n < head1; ++n)
+    path.add(que1[n]);
+  for (size_t n = 0; n < head2; ++n)
+    path.add(que2[n]);
+  return path;
+}
+
+template <class T>
+dyn_array<dyn_array<int> > graph<T>::par_breadth_first(size_t src,
+                                                     thread_pool* pool) const
+{
+  assert(src < this->size() && "par_breadth_first's src out of graph bounds");
+  size_t n = this->size();
+  thread_pool& tp = pool ? *pool : thread_pool::shared();
+  size_t p = tp.size();
+  // Beamer's heuristic goes bottom-up once edges out of the frontier exceed
+  // 1/alpha of unexplored edges, and back top-down once a shrinking frontier
+  // holds fewer than 1/beta of all nodes.
+  const size_t alpha = 14, beta = 24;
+  dyn_array<int> dist(-1, n), parent(-1, n);
+  int* d = &dist[0];
+  int* par = &parent[0];
+  d[src] = 0;
+  par[src] = static_cast<int>(src);
+  // Visited nodes and bottom-up frontiers are bitmaps of 64-bit words.
+  size_t words = (n + 63) / 64;
+  std::atomic<std::uint64_t>* visited = new std::atomic<std::uint64_t>[words];
+  for (size_t w = 0; w < words; ++w)
+    visited[w].store(0, std::memory_order_relaxed);
+  visited[src / 64].store(std::uint64_t(1) << (src % 64));
+  dyn_array<std::uint64_t> front_bits(0, words), next_bits(0, words);
+  // Top-down frontier is an index queue gathered from per-thread buffers.
+  dyn_array<size_t> front(src, 1);
+  dyn_array<dyn_array<size_t> > bufs(dyn_array<size_t>(), p);
+  dyn_array<size_t> counts(0, p), edges(0, p);
+  dyn_array<size_t>* buf = &bufs[0];
+  size_t* cnt = &counts[0];
+  size_t* cnt_e = &edges[0];
+  // Concatenates the per-thread buffers into the frontier queue.
+  auto gather = [&]() -> size_t {
+    size_t total = 0;
+    for (size_t t = 0; t < p; ++t) {
+      cnt[t] = total;
+      total += buf[t].size();
+    }
+    front.resize(total);
+    if (total) {
+      size_t* fr = &front[0];
+      tp.run(p, [&](size_t t) {
+        for (size_t i = 0; i < buf[t].size(); ++i)
+          fr[cnt[t] + i] = buf[t][i];
+      });
+    }
+    return total;
+  };
+  // Edges are counted in adjacency list slots, which is all the heuristic
+  // needs.
+  size_t unexplored = 0;
+  for (size_t u = 0; u < n; ++u)
+    unexplored += this->nodes_[u]->capacity();
+  size_t front_edges = this->nodes_[src]->capacity();
+  unexplored -= front_edges;
+  size_t front_size = 1, prev_size = 0;
+  bool bottom_up = false;
+  dyn_array<size_t> in_offs, in_srcs;
+  for (int level = 0; front_size > 0; ++level) {
+    if (!bottom_up && front_edges > unexplored / alpha) {
+      // Bottom-up steps look for parents among incoming edges.
+      if (in_offs.is_empty())
+        this->in_edges(in_offs, in_srcs, tp);
+      std::uint64_t* fb = &front_bits[0];
+      for (size_t w = 0; w < words; ++w)
+        fb[w] = 0;
+      for (size_t i = 0; i < front_size; ++i)
+        fb[front[i] / 64] |= std::uint64_t(1) << (front[i] % 64);
+      bottom_up = true;
+    }
+    else if (bottom_up && front_size < n / beta && front_size < prev_size) {
+      const std::uint64_t* fb = &front_bits[0];
+      size_t wchunk = (words + p - 1) / p;
+      tp.run(p, [&](size_t t) {
+        buf[t].clear();
+        for (size_t w = t * wchunk; w < (t + 1) * wchunk && w < words; ++w)
+          for (size_t b = 0; b < 64; ++b)
+            if ((fb[w] >> b) & 1)
+              buf[t].add(w * 64 + b);
+      });
+      gather();
+      bottom_up = false;
+    }
+    prev_size = front_size;
+    if (!bottom_up) {
+      // Top-down step: threads expand chunks of the frontier queue and claim
+      // unvisited neighbors by setting their visited bits atomically.
+      const size_t* fr = &front[0];
+      size_t chunk = (front_size + p - 1) / p;
+      tp.run(p, [&](size_t t) {
+        dyn_array<size_t>& out = buf[t];
+        out.clear();
+        size_t e = 0;
+        for (size_t i = t * chunk; i < (t + 1) * chunk && i < front_size; ++i) {
+          const graph_node<T>* node_u = this->nodes_[fr[i]];
+          for (size_t k = 0; k < node_u->capacity(); ++k) {
+            const graph_node<T>* node_v = (*node_u)[k];
+            if (!node_v)
+              continue;
+            size_t v = node_v->ind_;
+            std::uint64_t bit = std::uint64_t(1) << (v % 64);
+            std::atomic<std::uint64_t>& word = visited[v / 64];
+            if ((word.load(std::memory_order_relaxed) & bit) ||
+                (word.fetch_or(bit, std::memory_order_relaxed) & bit))
+              continue;
+            d[v] = level + 1;
+            par[v] = static_cast<int>(fr[i]);
+            out.add(v);
+            e += node_v->capacity();
+          }
+        }
+        cnt_e[t] = e;
+      });
+      front_size = gather();
+    }
+    else {
+      // Bottom-up step: threads own ranges of bitmap words, and each of their
+      // unvisited nodes stops at the first incoming edge from the frontier.
+      const std::uint64_t* fb = &front_bits[0];
+      std::uint64_t* nb = &next_bits[0];
+      const size_t* io = &in_offs[0];
+      const size_t* is = in_srcs.is_empty() ? nullptr : &in_srcs[0];
+      size_t wchunk = (words + p - 1) / p;
+      tp.run(p, [&](size_t t) {
+        size_t awake = 0, e = 0;
+        for (size_t w = t * wchunk; w < (t + 1) * wchunk && w < words; ++w) {
+          std::uint64_t seen = visited[w].load(std::memory_order_relaxed);
+          std::uint64_t found = 0;
+          for (size_t b = 0; b < 64 && w * 64 + b < n; ++b) {
+            if ((seen >> b) & 1)
+              continue;
+            size_t v = w * 64 + b;
+            for (size_t k = io[v]; k < io[v+1]; ++k) {
+              size_t u = is[k];
+              if ((fb[u / 64] >> (u % 64)) & 1) {
+                d[v] = level + 1;
+                par[v] = static_cast<int>(u);
+                found |= std::uint64_t(1) << b;
+                awake++;
+                e += this->nodes_[v]->capacity();
+                break;
+              }
+            }
+          }
+          nb[w] = found;
+          visited[w].store(seen | found, std::memory_order_relaxed);
+        }
+        cnt[t] = awake;
+        cnt_e[t] = e;
+      });
+      std::swap(front_bits, next_bits);
+      front_size = 0;
+      for (size_t t = 0; t < p; ++t)
+        front_size += cnt[t];
+    }
+    front_edges = 0;
+    for (size_t t = 0; t < p; ++t)
+      front_edges += cnt_e[t];
+    unexplored -= (front_edges < unexplored) ? front_edges : unexplored;
+  }
+  delete[] visited;
+  dyn_array<dyn_array<int> > ret;
+  ret.add(std::move(dist)).add(std::move(parent));
   return ret;
 }
 
 template <class T>
 dyn_array<size_t> graph<T>::find_roots() const
 {
-  // Use edge matrix columns to find nodes with no incoming edges.
-  dyn_array<size_t> root_nodes;
-  for (size_t col = 0; col < this->size(); ++col) {
-    bool no_incoming = true;
-    for (size_t row = 0; row < this->size(); ++row) {
-      if (this->edges_[row][col]) {
-        no_incoming = false;
-        break;
-      }
-    }
-    if (no_incoming)
-      root_nodes.add(col);
+  // Mark targets of all edges to find nodes with no incoming edges.
+  dyn_array<bool> has_incoming(false, this->size());
+  for (size_t u = 0; u < this->size(); ++u) {
+    const graph_node<T>* node_u = this->nodes_[u];
+    for (size_t n = 0; n < node_u->capacity(); ++n)
+      if ((*node_u)[n])
+        has_incoming[(*node_u)[n]->ind_] = true;
   }
+  dyn_array<size_t> root_nodes;
+  for (size_t v = 0; v < this->size(); ++v)
+    if (!has_incoming[v])
+      root_nodes.add(v);
   return root_nodes;
 }
 
 template <class T>
 bool graph<T>::has_cycle() const
 {
-  if (this->is_empty())
-    return false;
-  hash_table<uintptr_t, bool> visited;
-  hash_table<uintptr_t, bool> in_stack;
-  for (size_t n = 0; n < this->size(); ++n) {
-    uintptr_t key = reinterpret_cast<uintptr_t>(this->nodes_[n]);
-    if (!visited.contains(key)) {
-      if (this->cycle_rec(n, visited, in_stack))
+  size_t num_nodes = this->size();
+  // 0: unvisited, 1: on the current path (gray), 2: finished (black).
+  dyn_array<int> color(0, num_nodes);
+  // Each frame of the explicit stack holds a node and its next slot.
+  dyn_array<size_t> nodes, slots;
+  for (size_t s = 0; s < num_nodes; ++s) {
+    if (color[s])
+      continue;
+    color[s] = 1;
+    nodes.add(s);
+    slots.add(0);
+    while (!nodes.is_empty()) {
+      const graph_node<T>* cur = this->nodes_[nodes.last()];
+      size_t& n = slots[slots.size()-1];
+      while (n < cur->capacity() && !(*cur)[n])
+        ++n;
+      // Pop from stack (black now).
+      if (n == cur->capacity()) {
+        color[nodes.remove()] = 2;
+        slots.remove();
+        continue;
+      }
+      size_t v = (*cur)[n++]->ind_;
+      // Back-edge to current path: cycle.
+      if (color[v] == 1)
         return true;
+      // Finished or cross nodes are safe, unvisited ones go on the stack.
+      if (color[v] == 0) {
+        color[v] = 1;
+        nodes.add(v);
+        slots.add(0);
+      }
     }
   }
   return false;
 }
 
-template <class T>
-bool graph<T>::cycle_rec(size_t ind,
-                         hash_table<uintptr_t, bool>& visited,
-                         hash_table<uintptr_t, bool>& in_stack) const
-{
-  // DFS cycle detect with global visited + local stack.
-  uintptr_t key = reinterpret_cast<uintptr_t>(this->nodes_[ind]);
-  // Back-edge to current path: cycle.
-  if (in_stack.contains(key))
-    return true;
-  // Finished or cross: safe.
-  if (visited.contains(key))
-    return false;
-  // Mark visited.
-  visited.insert(key, true);
-  // Mark in-stack (gray).
-  in_stack.insert(key, true);
-  const graph_node<T>* cur = this->nodes_[ind];
-  for (size_t n = 0; n < cur->degree(); ++n) {
-    uintptr_t neigh_key = reinterpret_cast<uintptr_t>((*cur)(n));
-    if (this->cycle_rec((*cur)(n)->ind_, visited, in_stack))
-      return true;
-  }
-  // Pop from stack (black now).
-  in_stack.remove(key);
-  return false;
-}
-
 template <class T>
 dyn_array<T> graph<T>::topological_sort() const
 {
@@ -1381,20 +1573,18 @@ dyn_array<T> graph<T>::topological_sort() const
   for (size_t u = 0; u < num_nodes; ++u)
     if (in_degree[u] == 0)
       start_nodes.add(u);
-  // Use hash table to keep track of visited nodes and pass to dft method.
-  hash_table<uintptr_t, uintptr_t> ht;
+  // Share parent indices between traversals to keep track of visited nodes.
+  dyn_array<size_t> parent(num_nodes, num_nodes);
   // Lambda always returns false to fully traverse the graph.
-  auto check_none = [](const graph_node<T>*) -> bool {return false;};
-  dyn_array<uintptr_t> addr_path;
+  auto check_none = [](size_t) -> bool {return false;};
+  dyn_array<size_t> path;
   for (size_t i = 0; i < start_nodes.size(); ++i) {
-    const graph_node<T>* cur = this->nodes_[start_nodes[i]];
-    ht.insert(reinterpret_cast<uintptr_t>(cur),
-              reinterpret_cast<uintptr_t>(nullptr));
-    cur->dft(check_none, nullptr, ht, addr_path, true);
+    parent[start_nodes[i]] = start_nodes[i];
+    this->dft(start_nodes[i], check_none, nullptr, parent, path, true);
   }
-  gn_ptrs<T> path;
-  for (size_t i = 0; i < addr_path.size(); ++i)
-    ret.add(reinterpret_cast<graph_node<T>*>(addr_path[i])->val());
+  ret.realloc(path.size());
+  for (size_t i = 0; i < path.size(); ++i)
+    ret.add(this->nodes_[path[i]]->val());
   return ret;
 }
 
@@ -1418,57 +1608,29 @@ dyn_array<int> graph<T>::weakly_conn_comp() const
 {
   if (this->is_empty())
     return dyn_array<int>();
-  // -1 is reserved for not visited, indicates an issue with graph object.
-  dyn_array<int> ret(-1, this->size());
-  // Use hash table to keep track of visited nodes and their labels.
-  hash_table<uintptr_t, int> ht;
-  // Create union-find for merging during traversal.
-  union_find uf(static_cast<int>(this->size()));
-  // Recursively traverse from each node and label until all nodes are visited.
-  for (size_t n = 0; n < this->size(); ++n)
-    if (!ht.contains(reinterpret_cast<uintptr_t>(this->nodes_[n])))
-      this->comp_rec(n, ht, ret, uf);
-  // Map roots to contiguous labels + update hash_table selectively.
-  dyn_array<int> root_map(-1, this->size());
+  size_t num_nodes = this->size();
+  // Union the endpoints of every edge, regardless of its direction.
+  union_find uf(static_cast<int>(num_nodes));
+  for (size_t u = 0; u < num_nodes; ++u) {
+    const graph_node<T>* node_u = this->nodes_[u];
+    for (size_t n = 0; n < node_u->capacity(); ++n)
+      if ((*node_u)[n])
+        uf.union_sets(static_cast<int>(u),
+                      static_cast<int>((*node_u)[n]->ind_));
+  }
+  // Map roots to contiguous labels in order of their first node.
+  dyn_array<int> ret(-1, num_nodes);
+  dyn_array<int> root_map(-1, num_nodes);
   int label = 0;
-  for (size_t i = 0; i < this->size(); ++i) {
-    int r = uf.find(static_cast<int>(i));
-    if (root_map[static_cast<size_t>(r)] == -1)
-      root_map[static_cast<size_t>(r)] = label++;
-    ret[i] = root_map[static_cast<size_t>(r)];
-    // Selective ht update (like original): only for visited keys.
-    uintptr_t key = reinterpret_cast<uintptr_t>(this->nodes_[i]);
-    // Replace labels in the hash table with updated ones.
-    if (ht.contains(key))
-      ht.insert(key, ret[i]);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    size_t r = static_cast<size_t>(uf.find(static_cast<int>(i)));
+    if (root_map[r] == -1)
+      root_map[r] = label++;
+    ret[i] = root_map[r];
   }
   return ret;
 }
 
-template <class T>
-void graph<T>::comp_rec(size_t ind,
-                        hash_table<uintptr_t, int>& ht,
-                        dyn_array<int>& conn_lbl,
-                        union_find& uf) const
-{
-  const graph_node<T>* cur = this->nodes_[ind];
-  uintptr_t key = reinterpret_cast<uintptr_t>(cur);
-  // Mark recursed node as visited with -1.
-  ht.insert(key, -1);
-  // Also mark label array, eventual label will be assigned later.
-  conn_lbl[cur->ind_] = -1;
-  for (size_t i = 0; i < cur->degree(); ++i) {
-    uintptr_t neigh_key = reinterpret_cast<uintptr_t>((*cur)(i));
-    size_t neigh_ind = (*cur)(i)->ind_;
-    // Union on every neighbor (weak connectivity).
-    uf.union_sets(static_cast<int>(ind), static_cast<int>(neigh_ind));
-    // Recurse into each unvisited neighbor.
-    if (!ht.contains(key))
-      this->comp_rec(neigh_ind, ht, conn_lbl, uf);
-  }
-  return;
-}
-
 template <class T>
 dyn_array<dyn_array<size_t> > graph<T>::bridges() const
 {
@@ -1514,28 +1676,26 @@ dyn_array<dyn_array<int>> graph<T>::dijkstra(size_t src, bool accumulate) const
   dist[src] = 0;
   // Initialize predecessor vector with -1 values.
   dyn_array<int> pred(-1, this->size());
-  // Insert (distance, index) pairs as 2-element dyn_arrays into min heap.
-  heap<dyn_array<int> > min_heap(false);
-  dyn_array<int> pair(0, 2), buf(0, 2);
-  pair[1] = static_cast<int>(src);
-  min_heap.insert(pair);
-  int v, dist_v;
-  graph_node<T> node_u;
+  // Queue each node at most once, keyed by its tentative distance. Ties are
+  // broken by the smaller index.
+  index_heap<int> min_heap(this->size());
+  min_heap.insert(src, 0);
   // Process nodes until heap is empty.
   while (!min_heap.is_empty()) {
-    pair = min_heap.remove();
-    // Access neighbors from adjacency lists for efficiency.
-    node_u = *(this->nodes_[pair[1]]);
-    for (int n = 0; n < node_u.degree(); ++n) {
-      v = static_cast<int>(node_u(n)->ind_);
+    size_t u = min_heap.remove();
+    // Access neighbors and weights from adjacency list slots for efficiency.
+    const graph_node<T>* node_u = this->nodes_[u];
+    for (size_t n = 0; n < node_u->capacity(); ++n) {
+      if (!(*node_u)[n])
+        continue;
+      size_t v = (*node_u)[n]->ind_;
       // Update distance to v if a shorter distance is found through u.
-      dist_v = this->edges_[pair[1]][v] + dist[pair[1]];
+      int dist_v = this->slot_w(u, n) + dist[u];
       if (dist[v] == -1 || dist_v < dist[v]) {
         dist[v] = dist_v;
-        pred[v] = pair[1];
-        buf = {dist[v], static_cast<int>(v)};
-        // Add v with its updated distance to min heap.
-        min_heap.insert(buf);
+        pred[v] = static_cast<int>(u);
+        // Queue v, or move it up if it's already queued.
+        min_heap.push(v, dist_v);
       }
     }
   }
@@ -1591,10 +1751,21 @@ dyn_array<size_t> graph<T>::kahn() const
   while (!nodes.is_empty()) {
     cur_ind = nodes.dequeue();
     ret.add(cur_ind);
-    for (size_t edge = 0; edge < this->edges_[cur_ind].size(); ++edge) {
-      if (this->edges_[cur_ind][edge])
-        if (--in_degree[edge] == 0)
-          nodes.enqueue(edge);
+    // Dense graphs release neighbors in index order, sparse graphs in
+    // adjacency list order.
+    if (this->dense_) {
+      for (size_t edge = 0; edge < this->edges_[cur_ind].size(); ++edge) {
+        if (this->edges_[cur_ind][edge])
+          if (--in_degree[edge] == 0)
+            nodes.enqueue(edge);
+      }
+      continue;
+    }
+    const graph_node<T>* node_cur = this->nodes_[cur_ind];
+    for (size_t n = 0; n < node_cur->capacity(); ++n) {
+      const graph_node<T>* node_v = (*node_cur)[n];
+      if (node_v && --in_degree[node_v->ind_] == 0)
+        nodes.enqueue(node_v->ind_);
     }
   }
   return ret;
@@ -1603,74 +1774,90 @@ dyn_array<size_t> graph<T>::kahn() const
 template <class T>
 void graph<T>::tarjan(size_t ind, tarjan_bundle& tbun) const
 {
-  tbun.disc[ind] = tbun.low[ind] = tbun.timestamp();
+  // Each frame of the explicit stack holds a node and its next slot.
+  dyn_array<size_t> nodes, slots;
   int children = 0;
+  tbun.disc[ind] = tbun.low[ind] = tbun.timestamp();
   if (tbun.mode() == SCC) {
     tbun.push(ind);
     tbun.on_stack[ind] = true;
   }
-  size_t v, scc_node;
-  const graph_node<T> cur = *(this->nodes_[ind]);
-  for (size_t n = 0; n < cur.degree(); ++n) {
-    v = cur(n)->ind_;
-    // Recurse into each unvisited neighbor of current node with index ind.
-    if (tbun.disc[v] == -1) {
-      children++;
-      if (tbun.mode() == BRIDGE || tbun.mode() == ARTICULATION)
-        tbun.parent[v] = static_cast<int>(ind);
-      this->tarjan(v, tbun);
-      // If recursion found a lower discovery time reachable from v, it is by
-      // definition reachable from u as well, so propagate the new min up.
-      if (tbun.low[v] < tbun.low[ind])
-        tbun.low[ind] = tbun.low[v];
-      // Bridge check.
-      if (tbun.mode() == BRIDGE && tbun.low[v] > tbun.disc[ind]) {
-        dyn_array<size_t> br_edge;
-        (ind < v) ? (br_edge = {ind, v}) : (br_edge = {v, ind});
-        tbun.bridges.add(br_edge);
+  nodes.add(ind);
+  slots.add(0);
+  while (!nodes.is_empty()) {
+    size_t u = nodes.last();
+    const graph_node<T>* node_u = this->nodes_[u];
+    size_t& n = slots[slots.size()-1];
+    while (n < node_u->capacity() && !(*node_u)[n])
+      ++n;
+    if (n < node_u->capacity()) {
+      size_t v = (*node_u)[n++]->ind_;
+      // Descend into each unvisited neighbor of the node on top.
+      if (tbun.disc[v] == -1) {
+        if (u == ind)
+          children++;
+        if (tbun.mode() == BRIDGE || tbun.mode() == ARTICULATION)
+          tbun.parent[v] = static_cast<int>(u);
+        tbun.disc[v] = tbun.low[v] = tbun.timestamp();
+        if (tbun.mode() == SCC) {
+          tbun.push(v);
+          tbun.on_stack[v] = true;
+        }
+        nodes.add(v);
+        slots.add(0);
       }
-      // Articultion point check for non-root.
-      if (tbun.mode() == ARTICULATION)
-        if (tbun.parent[ind] != -1 && tbun.low[v] >= tbun.disc[ind])
-          tbun.art_pts[ind] = true;
-    }
-    // If neighbor is already visited, handle back edges.
-    else {
-      // If neighbor is visited and is on the stack, this is a back edge.
-      // Neighbor is an ancestor and current node can reach its discovery time.
-      if (tbun.mode() == SCC)
-        if (tbun.on_stack[v])
-          if (tbun.disc[v] < tbun.low[ind])
-            tbun.low[ind] = tbun.disc[v];
-      // In bridge or articulation mode, update only if neighbor is not parent.
-      if (tbun.mode() == BRIDGE || tbun.mode() == ARTICULATION)
-        if (v != tbun.parent[ind])
-          if (tbun.disc[v] < tbun.low[ind])
-            tbun.low[ind] = tbun.disc[v];
+      // If neighbor is already visited, handle back edges.
+      else {
+        // If neighbor is on the stack, it is an ancestor whose discovery
+        // time the node on top can reach.
+        if (tbun.mode() == SCC)
+          if (tbun.on_stack[v])
+            if (tbun.disc[v] < tbun.low[u])
+              tbun.low[u] = tbun.disc[v];
+        // In bridge or articulation mode, skip the edge back to the parent.
+        if (tbun.mode() == BRIDGE || tbun.mode() == ARTICULATION)
+          if (static_cast<int>(v) != tbun.parent[u])
+            if (tbun.disc[v] < tbun.low[u])
+              tbun.low[u] = tbun.disc[v];
+      }
+      continue;
     }
-  }
-  // Strongly-connected component in scc_arr is ready if cur is its root.
-  // Pop the stack until current node is popped and added to the component.
-  if (tbun.mode() == SCC) {
-    if (tbun.low[ind] == tbun.disc[ind]) {
+    // All neighbors of u are done. Pop its component if u is its root.
+    if (tbun.mode() == SCC && tbun.low[u] == tbun.disc[u]) {
       dyn_array<size_t> scc;
       while (!tbun.is_empty()) {
-        scc_node = tbun.pop();
+        size_t scc_node = tbun.pop();
         tbun.on_stack[scc_node] = false;
         scc.add(scc_node);
-        if (scc_node == ind)
+        if (scc_node == u)
           break;
       }
       tbun.scc_arr.add(scc);
     }
+    nodes.remove();
+    slots.remove();
+    if (nodes.is_empty())
+      break;
+    // Return to the parent p. If u reached a lower discovery time, it is by
+    // definition reachable from p as well, so propagate the new min up.
+    size_t p = nodes.last();
+    if (tbun.low[u] < tbun.low[p])
+      tbun.low[p] = tbun.low[u];
+    // Bridge check.
+    if (tbun.mode() == BRIDGE && tbun.low[u] > tbun.disc[p]) {
+      dyn_array<size_t> br_edge;
+      (p < u) ? (br_edge = {p, u}) : (br_edge = {u, p});
+      tbun.bridges.add(br_edge);
+    }
+    // Articulation point check for non-root.
+    if (tbun.mode() == ARTICULATION)
+      if (tbun.parent[p] != -1 && tbun.low[u] >= tbun.disc[p])
+        tbun.art_pts[p] = true;
   }
   // Root with children is an articulation point.
-  else if (tbun.mode() == ARTICULATION) {
-    if (tbun.parent[ind] == -1)
-      if (children > 1)
-        tbun.art_pts[ind] = true;
-  }
-  return;
+  if (tbun.mode() == ARTICULATION)
+    if (tbun.parent[ind] == -1 && children > 1)
+      tbun.art_pts[ind] = true;
 }
 
 template <class T>
@@ -1686,9 +1873,8 @@ graph<T>& graph<T>::build_adj_mat(const dyn_array<dyn_array<int> >& adj_mat)
       this->nodes_[n] = new graph_node<T>(0);
       this->nodes_[n]->ind_ = n;
     }
-    // Initialize edge matrix.
-    dyn_array<int> zero_row(0, num_nodes);
-    this->edges_ = dyn_array<dyn_array<int> >(zero_row, num_nodes);
+    // Initialize edge matrix or weight lists.
+    this->init_edges(num_nodes);
   }
   // Assigning to an existing non-empty graph.
   else {
@@ -1711,6 +1897,239 @@ graph<T>& graph<T>::build_adj_mat(const dyn_array<dyn_array<int> >& adj_mat)
   return *this;
 }
 
+template <class T>
+void graph<T>::init_edges(size_t sz)
+{
+  if (this->dense_) {
+    this->edges_ = dyn_array<dyn_array<int> >(dyn_array<int>(0, sz), sz);
+    this->wgts_.clear();
+  }
+  else {
+    this->edges_.clear();
+    this->wgts_ = dyn_array<gn_wgt>(gn_wgt(), sz);
+  }
+}
+
+template <class T>
+void graph<T>::copy_from(const graph<T>& source)
+{
+  this->nodes_.realloc(source.size());
+  // Copy nodes using graph_node copy constructor.
+  for (size_t i = 0; i < source.size(); ++i) {
+    graph_node<T>* cur_node = new graph_node<T>(source[i]);
+    cur_node->adj_.clear();
+    this->nodes_.add(cur_node);
+  }
+  this->init_edges(this->size());
+  // Link each node with its neighbors, keeping edge weights.
+  for (size_t i = 0; i < source.size(); ++i) {
+    const graph_node<T>* node_i = source.nodes_[i];
+    for (size_t n = 0; n < node_i->capacity(); ++n)
+      if ((*node_i)[n])
+        this->link(i, (*node_i)[n]->ind_, source.slot_w(i, n));
+  }
+}
+
+template <class T>
+size_t graph<T>::find_slot(size_t i, size_t j) const
+{
+  const graph_node<T>* node_i = this->nodes_[i];
+  const graph_node<T>* node_j = this->nodes_[j];
+  for (size_t n = 0; n < node_i->capacity(); ++n)
+    if ((*node_i)[n] == node_j)
+      return n;
+  return node_i->capacity();
+}
+
+template <class T>
+int graph<T>::slot_w(size_t i, size_t n) const
+{
+  if (this->dense_)
+    return this->edges_[i][(*this->nodes_[i])[n]->ind_];
+  return this->wgts_[i][n];
+}
+
+template <class T>
+void graph<T>::link(size_t i, size_t j, int w)
+{
+  if (this->dense_) {
+    // Add pointer to node j to the adjacency list of node i if it's new.
+    if (!this->edges_[i][j])
+      this->nodes_[i]->adj_.add(this->nodes_[j]);
+    this->edges_[i][j] = w;
+    return;
+  }
+  size_t n = this->find_slot(i, j);
+  if (n < this->nodes_[i]->capacity()) {
+    this->wgts_[i][n] = w;
+    return;
+  }
+  this->nodes_[i]->adj_.add(this->nodes_[j]);
+  this->wgts_[i].add(w);
+}
+
+template <class T>
+bool graph<T>::unlink(size_t i, size_t j)
+{
+  if (this->dense_ && !this->edges_[i][j])
+    return false;
+  size_t n = this->find_slot(i, j);
+  if (n == this->nodes_[i]->capacity())
+    return false;
+  // Nullify the adjacency pointer and its weight.
+  (*this->nodes_[i])[n] = nullptr;
+  if (this->dense_)
+    this->edges_[i][j] = 0;
+  else
+    this->wgts_[i][n] = 0;
+  return true;
+}
+
+template <class T>
+void graph<T>::in_edges(dyn_array<size_t>& offs, dyn_array<size_t>& srcs,
+                        thread_pool& tp) const
+{
+  size_t n = this->size();
+  size_t p = tp.size();
+  size_t chunk = (n + p - 1) / p;
+  // Count incoming edges of every node, then turn counts into offsets.
+  std::atomic<size_t>* cur = new std::atomic<size_t>[n];
+  for (size_t v = 0; v < n; ++v)
+    cur[v].store(0, std::memory_order_relaxed);
+  tp.run(p, [&](size_t t) {
+    for (size_t u = t * chunk; u < (t + 1) * chunk && u < n; ++u) {
+      const graph_node<T>* node_u = this->nodes_[u];
+      for (size_t k = 0; k < node_u->capacity(); ++k)
+        if ((*node_u)[k])
+          cur[(*node_u)[k]->ind_].fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+  offs = dyn_array<size_t>(0, n + 1);
+  for (size_t v = 0; v < n; ++v) {
+    offs[v+1] = offs[v] + cur[v].load(std::memory_order_relaxed);
+    cur[v].store(offs[v], std::memory_order_relaxed);
+  }
+  // Each edge claims the next free position among the sources of its target.
+  srcs = dyn_array<size_t>(0, offs[n]);
+  size_t* s = srcs.is_empty() ? nullptr : &srcs[0];
+  tp.run(p, [&](size_t t) {
+    for (size_t u = t * chunk; u < (t + 1) * chunk && u < n; ++u) {
+      const graph_node<T>* node_u = this->nodes_[u];
+      for (size_t k = 0; k < node_u->capacity(); ++k) {
+        const graph_node<T>* node_v = (*node_u)[k];
+        if (node_v)
+          s[cur[node_v->ind_].fetch_add(1, std::memory_order_relaxed)] = u;
+      }
+    }
+  });
+  delete[] cur;
+}
+
+template <class T>
+bool graph<T>::dft(size_t from_ind, const std::function<bool(size_t)>& check,
+                   std::ostream* os_ptr, dyn_array<size_t>& parent,
+                   dyn_array<size_t>& path, bool is_post) const
+{
+  size_t num_nodes = this->size();
+  // Visits a node, and returns true if it's the target.
+  auto visit = [&](size_t v) -> bool {
+    if (os_ptr)
+      *os_ptr << this->nodes_[v]->val();
+    path.add(v);
+    if (!check(v))
+      return false;
+    if (os_ptr)
+      *os_ptr << " [Target Found]";
+    return true;
+  };
+  // If not post-order, visit each node before any of its neighbors.
+  if (!is_post && visit(from_ind))
+    return true;
+  // Each frame of the explicit stack holds a node and its next slot.
+  dyn_array<size_t> nodes, slots;
+  nodes.add(from_ind);
+  slots.add(0);
+  while (!nodes.is_empty()) {
+    size_t u = nodes.last();
+    const graph_node<T>* node_u = this->nodes_[u];
+    size_t& n = slots[slots.size()-1];
+    while (n < node_u->capacity() &&
+           (!(*node_u)[n] || parent[(*node_u)[n]->ind_] != num_nodes))
+      ++n;
+    // Descend into the next unvisited neighbor.
+    if (n < node_u->capacity()) {
+      size_t v = (*node_u)[n++]->ind_;
+      parent[v] = u;
+      if (os_ptr && !is_post)
+        *os_ptr << " -> ";
+      if (!is_post && visit(v))
+        return true;
+      nodes.add(v);
+      slots.add(0);
+      continue;
+    }
+    // If post-order, visit each node after all its neighbors.
+    nodes.remove();
+    slots.remove();
+    if (is_post) {
+      if (visit(u))
+        return true;
+      if (os_ptr && !nodes.is_empty())
+        *os_ptr << " -> ";
+    }
+  }
+  return false;
+}
+
+template <class T>
+dyn_array<size_t> graph<T>::bft(size_t from_ind,
+                                const std::function<bool(size_t)>& check,
+                                std::ostream* os_ptr) const
+{
+  size_t num_nodes = this->size();
+  // Parent index of each visited node, num_nodes for unvisited nodes.
+  dyn_array<size_t> parent(num_nodes, num_nodes);
+  // Dequeued nodes stay in the array, which ends up as the traversal path.
+  dyn_array<size_t> path;
+  path.add(from_ind);
+  parent[from_ind] = from_ind;
+  for (size_t head = 0; head < path.size(); ++head) {
+    size_t u = path[head];
+    const graph_node<T>* node_u = this->nodes_[u];
+    if (os_ptr)
+      *os_ptr << node_u->val();
+    // If target is found, reconstruct the path from target and return it.
+    if (check(u)) {
+      if (os_ptr)
+        *os_ptr << " [Target Found]";
+      return this->trace_path(u, parent);
+    }
+    // Enqueue all the unvisited neighbors of the current node.
+    for (size_t n = 0; n < node_u->capacity(); ++n) {
+      if ((*node_u)[n] && parent[(*node_u)[n]->ind_] == num_nodes) {
+        parent[(*node_u)[n]->ind_] = u;
+        path.add((*node_u)[n]->ind_);
+      }
+    }
+    if (head + 1 < path.size() && os_ptr)
+      *os_ptr << " -> ";
+  }
+  return path;
+}
+
+template <class T>
+dyn_array<size_t> graph<T>::trace_path(size_t ind,
+                                       const dyn_array<size_t>& parent) const
+{
+  dyn_array<size_t> path;
+  path.add(ind);
+  while (parent[ind] != ind) {
+    ind = parent[ind];
+    path.add(ind);
+  }
+  return path.reverse();
+}
+
 template <class T>
 std::ostream& graph<T>::print_nodes(std::ostream& os) const
 {
@@ -1771,11 +2190,12 @@ std::ostream& graph<T>::print_adj_matrix(std::ostream& os) const
     return os;
   int dec, off, num, max;
   this->get_dec(dec, off, num, max);
+  const dyn_array<dyn_array<int> > mat = this->adj_mat();
   for (size_t row = 0; row < this->size(); ++row) {
     os << std::setw(off) << row << " ";
     os << std::setw(dec) << this->nodes_[row]->val() << ": ";
     for (size_t col = 0; col < this->size(); ++col) {
-      os << std::setw(dec) << static_cast<int>(this->edges_[row][col]);
+      os << std::setw(dec) << static_cast<int>(mat[row][col]);
       ((col < num) ? (os << " ") : (os << std::endl));
     }
   }
@@ -6,26 +6,38 @@
 #include <string>
 #include <sstream>
 #include <bitset>
+#include <type_traits>
+#include <iterator>
+#include <cstddef>
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
 #include "dyn_array.h"
 #include "linked_list.h"
 
 // Simple hash node class.
-// Holds key-value pairs for hash_table.
+// Holds key-value pairs for hash_table, along with the full 64-bit hash value
+// of the key computed at insertion, which lets entries move between tables
+// without rehashing their keys, and rules out most mismatching keys without
+// deep comparisons.
 // Uses matching template parameters to hash_table.
 template <class K, class V>
 class hash_node
 {
   public:
-    hash_node() {}
-    hash_node(const K& key, const V& val): key_(key), val_(val) {}
+    hash_node(): hash_(0) {}
+    hash_node(const K& key, const V& val): key_(key), val_(val), hash_(0) {}
     ~hash_node() {}
     bool operator == (const hash_node<K, V>& n) {return this->key_ == n.key_;}
     K key_;
     V val_;
+    unsigned long long hash_;
 };
 
 // Unscoped global enum to pick hash function for pointer types.
 enum PtrHashType {FNV, JENKINS, MURMUR};
+// Unscoped global enum to pick the family of hash functions for all key types.
+enum HashPolicy {CLASSIC, WIDE};
 
 // Hash function class templated on key type that automatically selects and
 // applies the hash function most suitable for keys of type K.
@@ -41,19 +53,45 @@ enum PtrHashType {FNV, JENKINS, MURMUR};
 // - floating-point: unsigned modulus on floating-point bit pattern (mod_float)
 //     float, double
 // - string container: rolling polynomial (poly_roll)
-//     std::string, trie
+//     std::string
 // - pointer: fowler-noll-vo (fnv), jenkins or murmur depending on PtrHashType.
 //     uintptr_t
-// - templated cppdata: rolling polynomial on ostream string (static poly_roll)
+// - cppdata: structural digest combining element digests (digest)
 //     dyn_array, node, linked_list, stack, queue, graph_node, graph, heap,
-//     binary_tree, binary_search_tree, heap_tree, avl_tree, red_black_tree
+//     binary_tree, binary_search_tree, heap_tree, avl_tree, red_black_tree,
+//     trie
+//
+// The functions above make up the CLASSIC HashPolicy. Modulus-based functions
+// map nearby keys to nearby values and the rolling polynomial is limited to
+// 1e9+7 distinct values, which is fine for prime-sized tables but clusters in
+// power-of-two tables and in large tables. The WIDE HashPolicy replaces them
+// with 64-bit mixing functions that use every bit of the key:
+// - integral, floating-point and pointer: seeded 64-bit finalizer (wide_int)
+// - std::string: seeded wyhash-style multiply-fold over 8 bytes at a time
+//     (wide_str)
+// - cppdata: structural digest remixed with the seed (wide_int)
+// Each hash_fn<K> instance carries a seed that only affects WIDE hashing, so
+// that tables with different seeds place the same keys differently.
+//
+// Structural digests walk the container and fold the 64-bit digest of each
+// element into a running value, without formatting anything to a string.
+// Elements are hashed recursively with hash_fn<T>::digest, so containers of
+// containers work out of the box. Arithmetic elements are hashed by value,
+// pointer elements by the value they point to to match deep equality, and
+// element types without a dedicated digest by their streamed representation.
+// Containers whose equality ignores element order, namely graph_node, graph
+// and trie, combine element digests with a commutative sum instead.
 template <class K>
 class hash_fn
 {
   public:
-    hash_fn(): size_(1009), ptr_hash_(FNV) {}
-    hash_fn(size_t s): size_(s), ptr_hash_(FNV) {}
-    hash_fn(size_t s, PtrHashType ptr_h): size_(s), ptr_hash_(ptr_h) {}
+    hash_fn(): size_(1009), ptr_hash_(FNV), policy_(CLASSIC), seed_(0) {}
+    hash_fn(size_t s): size_(s), ptr_hash_(FNV), policy_(CLASSIC), seed_(0) {}
+    hash_fn(size_t s, PtrHashType ptr_h)
+        : size_(s), ptr_hash_(ptr_h), policy_(CLASSIC), seed_(0) {}
+    hash_fn(size_t s, PtrHashType ptr_h, HashPolicy policy,
+            unsigned long long seed)
+        : size_(s), ptr_hash_(ptr_h), policy_(policy), seed_(seed) {}
     ~hash_fn() {}
 
     size_t run(const K& key) const {
@@ -61,6 +99,15 @@ class hash_fn
       return 0;
     }
 
+    // Structural 64-bit digest of a container element. O(1) or O(L) | O(1)
+    static unsigned long long digest(const K& key);
+    // Finalizer that spreads the entropy of h across all 64 bits. O(1) | O(1)
+    static unsigned long long mix(unsigned long long h);
+    // Order-sensitive combination of a running digest with the next one.
+    // O(1) | O(1)
+    static unsigned long long combine(unsigned long long seed,
+                                      unsigned long long h);
+
     // Simple, modulus-based hash function for unsigned keys.
     size_t mod_unsigned(unsigned key) const;
     // Modulus-based hash function for float bit pattern keys.
@@ -80,10 +127,34 @@ class hash_fn
     size_t jenkins(const uintptr_t& key) const;
     // Simplified version of MurmurHash function for uintptr_t pointer keys.
     size_t murmur(const uintptr_t& key) const;
+    // Seeded 64-bit finalizer for integral, bit pattern and digest keys.
+    size_t wide_int(unsigned long long key) const;
+    // Seeded wyhash-style multiply-fold hash function for string keys.
+    size_t wide_str(const std::string& key) const;
+    // Static wyhash-style implementation shared with string digests.
+    static unsigned long long wy_hash(const char* data, size_t len,
+                                      unsigned long long seed);
+    // Reduces a structural digest to the table size under the selected
+    // policy. Used by full class specializations for container keys.
+    size_t reduce(unsigned long long digest) const;
 
-  private:
+  protected:
     size_t size_;
     PtrHashType ptr_hash_;
+    HashPolicy policy_;
+    unsigned long long seed_;
+
+  private:
+    // Full 128-bit product of a and b, folded to 64 bits with xor. O(1) | O(1)
+    static unsigned long long mum(unsigned long long a, unsigned long long b);
+
+    // Digest categories picked by digest for arithmetic, pointer and other K.
+    typedef std::integral_constant<int, 0> arithmetic_key;
+    typedef std::integral_constant<int, 1> pointer_key;
+    typedef std::integral_constant<int, 2> other_key;
+    static unsigned long long digest(const K& key, arithmetic_key);
+    static unsigned long long digest(const K& key, pointer_key);
+    static unsigned long long digest(const K& key, other_key);
 };
 
 // Type-aware hash table that supports all fundamental data types, std::string,
@@ -91,19 +162,56 @@ class hash_fn
 // Represents its table with raw array of node<hash_node<K, V>, false> chains.
 // All hash functions are encapsulated in hash_fn<K> member, which picks the
 // optimal hash function for each supported K key type.
-// Hash functions generate an index for the fixed-size raw array from keys,
+// Hash functions generate an index for the growable raw array from keys,
 // then actual searches, insertions and deletions at that index are executed
 // using node<T, D> methods and equality operators defined by K type.
 // If an existing key is inserted again, its new value will replace the old.
 // Owns all its memory. Manages raw array memory directly, and the memory for
 // the linked lists from their head nodes.
 //
-// The consistent availability of deep equality check == and friend ostream <<
-// operators on all non-utility cppdata classes permits hash_table<K, V> to use
-// them to generate strings that fully describe the internal structure of each
-// class instance, and then hash these strings with polynomial rolling hash
-// just like regular std::string keys; and execute deep structural comparisons
-// for keys that are part of the same linked list.
+// The table grows when the number of entries exceeds max load times the table
+// size, switching to a new table with a prime size at least twice as large.
+// To avoid a stop-the-world rehash, the previous table is kept alongside the
+// new one and its buckets are migrated a few at a time at the start of every
+// insert, contains, operator [] and remove call, relinking existing nodes
+// without any allocations. Lookups consult both tables until migration is
+// complete. Each growth sizes the number of buckets every call migrates by
+// how many insertions the next growth is away, so that even with a small max
+// load a migration always completes first. Key hashes are computed once with
+// a 64-bit prime modulus and stored in hash_node<K, V>, then reduced to
+// either table size, so migration never rehashes keys.
+//
+// Since they migrate buckets too, const lookups such as contains, find and
+// operator [] write to mutable members. Concurrent const reads of the same
+// table are therefore a data race, and need a lock around every call or a
+// sharded_hash_table<K, V> instead.
+//
+// Entries can optionally be allocated from a node_pool owned by the table,
+// which recycles the memory of removed entries and returns all of it to the
+// heap at once when the table is cleared or destroyed. This takes the heap
+// allocator out of workloads that keep inserting and removing keys.
+//
+// Searches compare stored hashes before keys, so colliding entries cost O(1)
+// each instead of a deep O(L) comparison of container keys. Callers that look
+// up the same key repeatedly can compute its hash once with hash_code and pass
+// it to the insert and contains overloads that take a precomputed hash.
+//
+// Batch lookups with find_many and contains_many hash a group of keys first,
+// prefetching their buckets, then prefetch the first entry of each bucket,
+// and only then resolve the keys, so that the cache misses of all the keys in
+// the group overlap instead of being paid one after the other.
+//
+// Entries can be traversed without any allocations, either with forward
+// iterators that also work with range-based for loops, or by passing a
+// callback to visit. Both complete any pending migration first, so that
+// lookups during traversal don't move entries. Insertions and removals
+// invalidate iterators, since they can grow the table or delete the entry.
+//
+// The consistent availability of deep equality check == operators on all
+// non-utility cppdata classes permits hash_table<K, V> to hash each class
+// instance with a structural digest of the same elements that equality
+// compares, and execute deep structural comparisons for keys that are part of
+// the same linked list.
 // Heap-only classes need to grant hash_node<K, V> utility class friend access
 // in order to be hashable, otherwise they can't be copied to its key_ member.
 //
@@ -139,65 +247,264 @@ class hash_fn
 template <class K, class V>
 class hash_table
 {
+  private:
+    typedef node<hash_node<K, V>, false> hash_list;
+
   public:
+    // Forward iterator over table entries in bucket order. N is either
+    // hash_node<K, V> or its const counterpart. Keys must not be modified
+    // through an iterator, since that would strand entries in wrong buckets.
+    template <class N>
+    class entry_iterator
+    {
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef N value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef N* pointer;
+        typedef N& reference;
+
+        // Default constructor creates a singular iterator. O(1) | O(1)
+        entry_iterator(): table_(nullptr), size_(0), bucket_(0),
+                          entry_(nullptr) {}
+        // Converts iterators to const iterators. O(1) | O(1)
+        template <class M>
+        entry_iterator(const entry_iterator<M>& other)
+            : table_(other.table_),
+              size_(other.size_),
+              bucket_(other.bucket_),
+              entry_(other.entry_) {}
+
+        // Returns the current entry. O(1) | O(1)
+        N& operator * () const {return this->entry_->val();}
+        // Accesses members of the current entry. O(1) | O(1)
+        N* operator -> () const {return &(this->entry_->val());}
+        // Moves to the next entry, skipping empty buckets. O(T/N) avg | O(1)
+        entry_iterator<N>& operator ++ ();
+        // Postfix version of the increment operator. O(T/N) avg | O(1)
+        entry_iterator<N> operator ++ (int);
+        // Iterators are equal if they point to the same entry. O(1) | O(1)
+        template <class M>
+        bool operator == (const entry_iterator<M>& other) const
+            {return this->entry_ == other.entry_;}
+        template <class M>
+        bool operator != (const entry_iterator<M>& other) const
+            {return this->entry_ != other.entry_;}
+
+      private:
+        friend class hash_table<K, V>;
+        template <class M>
+        friend class entry_iterator;
+        // Starts at the first entry at or after the given bucket. O(T) | O(1)
+        entry_iterator(hash_list** table, size_t size, size_t bucket);
+
+        // Bucket array being traversed.
+        hash_list** table_;
+        // Number of buckets in the array.
+        size_t size_;
+        // Bucket of the current entry.
+        size_t bucket_;
+        // Current entry, nullptr past the last one.
+        hash_list* entry_;
+    };
+    typedef entry_iterator<hash_node<K, V> > iterator;
+    typedef entry_iterator<const hash_node<K, V> > const_iterator;
+
     // Default constructor uses a prime array size of 1009. O(1) | O(1)
     hash_table()
         : size_(1009),
-          hash_(hash_fn<K>(this->size_)),
-          table_(new hash_list*[this->size_]()) {}
+          count_(0),
+          max_load_(1.0f),
+          hash_(hash_fn<K>(hash_table::wide)),
+          table_(new hash_list*[this->size_]()),
+          old_size_(0),
+          migrate_(0),
+          step_(hash_table::migrate_steps),
+          old_table_(nullptr),
+          pool_(nullptr) {}
     // Constructs with specified size for array of linked lists. O(T) | O(T)
     hash_table(size_t table_size)
         : size_(table_size),
-          hash_(hash_fn<K>(this->size_)),
-          table_(new hash_list*[this->size_]()) {}
+          count_(0),
+          max_load_(1.0f),
+          hash_(hash_fn<K>(hash_table::wide)),
+          table_(new hash_list*[this->size_]()),
+          old_size_(0),
+          migrate_(0),
+          step_(hash_table::migrate_steps),
+          old_table_(nullptr),
+          pool_(nullptr) {}
     // Constructs with size and hash function for pointer keys. O(T) | O(T)
     hash_table(size_t table_size, PtrHashType ptr_h)
         : size_(table_size),
-          hash_(hash_fn<K>(this->size_, ptr_h)),
-          table_(new hash_list*[this->size_]()) {}
-    // Destructor deallocates the array member. O(N+T) | O(N/T)
+          count_(0),
+          max_load_(1.0f),
+          hash_(hash_fn<K>(hash_table::wide, ptr_h)),
+          table_(new hash_list*[this->size_]()),
+          old_size_(0),
+          migrate_(0),
+          step_(hash_table::migrate_steps),
+          old_table_(nullptr),
+          pool_(nullptr) {}
+    // Constructs with size, hash policy and seed for all keys. O(T) | O(T)
+    hash_table(size_t table_size, HashPolicy policy,
+               unsigned long long seed = 0)
+        : size_(table_size),
+          count_(0),
+          max_load_(1.0f),
+          hash_(hash_fn<K>(hash_table::wide, FNV, policy, seed)),
+          table_(new hash_list*[this->size_]()),
+          old_size_(0),
+          migrate_(0),
+          step_(hash_table::migrate_steps),
+          old_table_(nullptr),
+          pool_(nullptr) {}
+    // Destructor deallocates the array members. O(N+T) | O(N/T)
     ~hash_table();
 
     // Returns a copy of key's value. O(1) average, O(N) worst | O(1)
     V operator [] (const K& key) const;
     // Returns true if key is in hash_table. O(1) average, O(N) worst | O(1)
     bool contains(const K& key) const;
+    // Same as contains, with key's hash precomputed by hash_code.
+    // O(1) average, O(N) worst | O(1)
+    bool contains(const K& key, unsigned long long h) const;
+    // Returns the full hash value of key used to place it in the table.
+    // O(1) for fundamental types, O(L) for containers | O(1)
+    unsigned long long hash_code(const K& key) const {return this->hash(key);}
+    // Looks up a batch of keys, setting each element of vals to point to the
+    // matching value or to nullptr if the key is missing. Resizes vals only if
+    // its size differs from keys. Returns the number of keys found.
+    // O(M) average, O(M*N) worst | O(1)
+    size_t find_many(const dyn_array<K>& keys, dyn_array<V*>& vals) const;
+    // Checks a batch of keys, setting each element of found to true if the
+    // matching key is in hash_table. Resizes found only if its size differs
+    // from keys. Returns the number of keys found.
+    // O(M) average, O(M*N) worst | O(1)
+    size_t contains_many(const dyn_array<K>& keys,
+                         dyn_array<bool>& found) const;
     // Returns the size of raw array member, which is tracked. O(1) | O(1)
     size_t size() const {return this->size_;}
+    // Returns the number of key-value pairs, which is tracked. O(1) | O(1)
+    size_t count() const {return this->count_;}
+    // Returns the ratio of entries to table size. O(1) | O(1)
+    float load_factor() const {return static_cast<float>(this->count_) /
+                                      static_cast<float>(this->size_);}
+    // Sets the load factor that triggers growth, 0 disables it. O(1) | O(1)
+    hash_table<K, V>& set_max_load(float max_load);
     // Deletes all linked lists and nullifies array elements. O(N+T) | O(N/T)
     hash_table<K, V>& clear();
+    // Switches between allocating entries from a node pool owned by the table
+    // and allocating each entry separately. Only allowed on an empty table.
+    // O(1) | O(1)
+    hash_table<K, V>& use_pool(bool enable);
 
     // Inserts a key-value pair to the table. O(1) average, O(N) worst | O(1)
     hash_table<K, V>& insert(const K& key, const V& val);
     // Inserts a hash_node to the table. O(1) average, O(N) worst | O(1)
     hash_table<K, V>& insert(const hash_node<K, V>& hn);
-    // Deletes the first matching entry in given key's hash bucket.
+    // Same as insert, with key's hash precomputed by hash_code.
+    // O(1) average, O(N) worst | O(1)
+    hash_table<K, V>& insert(const K& key, const V& val, unsigned long long h);
+    // Deletes the matching entry in given key's hash bucket.
     // O(1) average, O(N) worst | O(1)
     hash_table<K, V>& remove(const K& key);
+    // Same as remove, with key's hash precomputed by hash_code.
+    // O(1) average, O(N) worst | O(1)
+    hash_table<K, V>& remove(const K& key, unsigned long long h);
     // Return pointers to all the keys in the hash table. O(N+T) | O(N)
     dyn_array<K*> keys() const;
     // Return pointers to all the values in the hash table. O(N+T) | O(N)
     dyn_array<V*> vals() const;
+    // Returns an iterator to the first entry, completing any pending
+    // migration first. O(T) | O(1)
+    iterator begin();
+    const_iterator begin() const;
+    // Returns an iterator past the last entry. O(1) | O(1)
+    iterator end() {return iterator();}
+    const_iterator end() const {return const_iterator();}
+    // Calls f(key, val) on every entry, completing any pending migration
+    // first. Values can be modified through non-const tables. O(N+T) | O(1)
+    template <class F>
+    void visit(F f);
+    template <class F>
+    void visit(F f) const;
 
     // Prints hash table contents to output stream. O(N+T) | O(1)
     template <class Key, class Val>
     friend std::ostream& operator << (std::ostream& os,
                                       const hash_table<Key, Val>& ht);
+    // Open-addressing table shares the prefetch helper for batch lookups.
+    template <class Key, class Val>
+    friend class open_hash_table;
+    // Sharded table looks up entries with hash values computed outside locks.
+    template <class Key, class Val>
+    friend class sharded_hash_table;
 
   private:
-    typedef node<hash_node<K, V>, false> hash_list;
+    // Largest prime below 2^64 (2^32 on 32-bit platforms), used as modulus
+    // for full-range hash values.
+    static const size_t wide = sizeof(size_t) >= 8
+        ? static_cast<size_t>(18446744073709551557ULL) : 4294967291UL;
+    // Least number of old table buckets migrated by each operation.
+    static const size_t migrate_steps = 4;
+    // Number of keys whose memory accesses are overlapped by batch lookups.
+    static const size_t batch_size = 16;
+
     // Hash function is run through the hash_fn class.
     // O(1) for fundamental types, O(L) for containers | O(1)
-    size_t hash(const K& key) const {return this->hash_.run(key);}
+    unsigned long long hash(const K& key) const {return this->hash_.run(key);}
     // Method for internal search. O(1) average, O(N) worst | O(1)
     hash_list* find(const K& key) const;
+    // Internal search with precomputed key hash. O(1) avg, O(N) worst | O(1)
+    hash_list* find(const K& key, unsigned long long h) const;
+    // Runs batch lookups, calling out(i, entry) with the entry of each key.
+    // O(M) average, O(M*N) worst | O(1)
+    template <class Out>
+    size_t lookup_many(const dyn_array<K>& keys, Out out) const;
+    // Hints the processor to start loading addr into cache. O(1) | O(1)
+    static void prefetch(const void* addr);
+    // Searches a single bucket, comparing keys only on matching hashes.
+    // O(1) average, O(N) worst | O(1)
+    static hash_list* search(hash_list* entry, const K& key,
+                             unsigned long long h);
+    // Inserts or updates an entry with its precomputed key hash.
+    // O(1) average, O(N) worst | O(1)
+    hash_table<K, V>& insert_node(const hash_node<K, V>& hn,
+                                  unsigned long long h);
+    // Creates a single entry, from the node pool if there is one. O(1) | O(1)
+    hash_list* create_entry(const hash_node<K, V>& hn);
+    // Deletes a bucket chain, from its head to tail. O(N/T) | O(1)
+    void delete_chain(hash_list* entry);
+    // Deletes the entries of both tables and nullifies buckets. O(N+T) | O(1)
+    void delete_all();
+    // Moves up to steps buckets from old to new table. O(steps) | O(1)
+    void migrate(size_t steps) const;
+    // Starts migrating entries to a table twice as large. O(T) | O(T)
+    void grow();
+    // Returns the smallest prime that is not less than n. O(sqrt(N)) | O(1)
+    static size_t next_prime(size_t n);
 
     // Size of the member array.
     size_t size_;
-    // Hashing function used to build indices.
+    // Number of key-value pairs in both tables.
+    size_t count_;
+    // Load factor that triggers growth, 0 if growth is disabled.
+    float max_load_;
+    // Hashing function used to build full-range hash values.
     hash_fn<K> hash_;
     // Array of pointers to singly-linked lists of key-value pairs.
     hash_list** table_;
+    // Size of the table being migrated, if any.
+    mutable size_t old_size_;
+    // Index of the next old table bucket to migrate.
+    mutable size_t migrate_;
+    // Number of old table buckets migrated by each operation, set by grow.
+    size_t step_;
+    // Table being migrated, or nullptr when there is none.
+    mutable hash_list** old_table_;
+    // Pool that owns the memory of all entries, or nullptr if not pooled.
+    node_pool<hash_node<K, V>, false>* pool_;
 };
 
 // Templated class method implementations need to be accessible at the
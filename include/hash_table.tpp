@@ -25,6 +25,9 @@ std::ostream& operator << (std::ostream& os, const binary_tree<T, P>& bt);
 template <class T>
 std::ostream& operator << (std::ostream& os, const heap<T>& h);
 std::ostream& operator << (std::ostream& os, const trie& tr);
+// Defined in trie.tpp, since the structural digest needs trie to be complete.
+template<>
+unsigned long long hash_fn<trie>::digest(const trie& key);
 
 #include "trie.h"
 
@@ -164,6 +167,177 @@ size_t hash_fn<K>::murmur(const uintptr_t& key) const
   return static_cast<size_t>(hash_value % this->size_);
 }
 
+template <class K>
+size_t hash_fn<K>::wide_int(unsigned long long key) const
+{
+  // Offset by the golden ratio so that seed and key 0 don't map to 0.
+  unsigned long long h = key ^ (this->seed_ + 0x9e3779b97f4a7c15ULL);
+  return static_cast<size_t>(hash_fn<K>::mix(h) % this->size_);
+}
+
+template <class K>
+size_t hash_fn<K>::wide_str(const std::string& key) const
+{
+  unsigned long long h = hash_fn<K>::wy_hash(key.data(), key.size(),
+                                             this->seed_);
+  return static_cast<size_t>(h % this->size_);
+}
+
+template <class K>
+unsigned long long hash_fn<K>::wy_hash(const char* data, size_t len,
+                                       unsigned long long seed)
+{
+  // Odd constants with balanced bits, as used by wyhash.
+  const unsigned long long s0 = 0xa0761d6478bd642fULL;
+  const unsigned long long s1 = 0xe7037ed1a0b428dbULL;
+  const unsigned long long s2 = 0x8ebc6af09c88c6e3ULL;
+  const unsigned long long s3 = 0x589965cc75374cc3ULL;
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+  // Reads 4 or 8 bytes at once; memcpy keeps unaligned reads well-defined.
+  struct read {
+    static unsigned long long r8(const unsigned char* p) {
+      uint64_t v;
+      std::memcpy(&v, p, 8);
+      return v;
+    }
+    static unsigned long long r4(const unsigned char* p) {
+      uint32_t v;
+      std::memcpy(&v, p, 4);
+      return v;
+    }
+  };
+  seed ^= hash_fn<K>::mum(seed ^ s0, s1);
+  unsigned long long a = 0;
+  unsigned long long b = 0;
+  if (len <= 16) {
+    // Short strings are covered by two possibly overlapping reads.
+    if (len >= 4) {
+      size_t off = (len >> 3) << 2;
+      a = (read::r4(p) << 32) | read::r4(p + off);
+      b = (read::r4(p + len - 4) << 32) | read::r4(p + len - 4 - off);
+    }
+    else if (len > 0) {
+      a = (static_cast<unsigned long long>(p[0]) << 16) |
+          (static_cast<unsigned long long>(p[len >> 1]) << 8) | p[len - 1];
+    }
+  }
+  else {
+    size_t i = len;
+    // Long strings are consumed 48 bytes at a time in three lanes.
+    if (i > 48) {
+      unsigned long long see1 = seed;
+      unsigned long long see2 = seed;
+      do {
+        seed = hash_fn<K>::mum(read::r8(p) ^ s1, read::r8(p + 8) ^ seed);
+        see1 = hash_fn<K>::mum(read::r8(p + 16) ^ s2, read::r8(p + 24) ^ see1);
+        see2 = hash_fn<K>::mum(read::r8(p + 32) ^ s3, read::r8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = hash_fn<K>::mum(read::r8(p) ^ s1, read::r8(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+    // The last 16 bytes are read in full, overlapping the previous block.
+    a = read::r8(p + i - 16);
+    b = read::r8(p + i - 8);
+  }
+  return hash_fn<K>::mum(s1 ^ len, hash_fn<K>::mum(a ^ s1, b ^ seed));
+}
+
+template <class K>
+unsigned long long hash_fn<K>::mum(unsigned long long a, unsigned long long b)
+{
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+  return static_cast<unsigned long long>(r) ^
+         static_cast<unsigned long long>(r >> 64);
+#else
+  // Portable 64x64 to 128-bit multiplication from 32-bit halves.
+  unsigned long long a_lo = a & 0xffffffffULL, a_hi = a >> 32;
+  unsigned long long b_lo = b & 0xffffffffULL, b_hi = b >> 32;
+  unsigned long long ll = a_lo * b_lo, lh = a_lo * b_hi;
+  unsigned long long hl = a_hi * b_lo, hh = a_hi * b_hi;
+  unsigned long long mid = (ll >> 32) + (lh & 0xffffffffULL) +
+                           (hl & 0xffffffffULL);
+  unsigned long long lo = (ll & 0xffffffffULL) | (mid << 32);
+  unsigned long long hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+  return lo ^ hi;
+#endif
+}
+
+template <class K>
+size_t hash_fn<K>::reduce(unsigned long long digest) const
+{
+  if (this->policy_ == WIDE)
+    return this->wide_int(digest);
+  return static_cast<size_t>(digest % this->size_);
+}
+
+template <class K>
+unsigned long long hash_fn<K>::digest(const K& key)
+{
+  return hash_fn<K>::digest(key, std::integral_constant<int,
+      std::is_arithmetic<K>::value ? 0 :
+      (std::is_pointer<K>::value ? 1 : 2)>());
+}
+
+template <class K>
+unsigned long long hash_fn<K>::digest(const K& key, arithmetic_key)
+{
+  unsigned long long bits;
+  if (std::is_floating_point<K>::value) {
+    // Hash the bit pattern of floating-point values, with -0.0 mapped to 0.0
+    // since they compare equal.
+    double dbl = (key == 0) ? 0.0 : static_cast<double>(key);
+    std::memcpy(&bits, &dbl, sizeof(dbl));
+  }
+  else {
+    bits = static_cast<unsigned long long>(key);
+  }
+  return hash_fn<K>::mix(bits);
+}
+
+template <class K>
+unsigned long long hash_fn<K>::digest(const K& key, pointer_key)
+{
+  // Pointer elements are compared by the values they point to.
+  typedef typename std::remove_cv<
+      typename std::remove_pointer<K>::type>::type pointee;
+  return key ? hash_fn<pointee>::digest(*key) : 0;
+}
+
+template <class K>
+unsigned long long hash_fn<K>::digest(const K& key, other_key)
+{
+  // Fallback for element types without a dedicated digest.
+  std::stringstream ss;
+  ss << key;
+  return hash_fn<std::string>::digest(ss.str());
+}
+
+template <class K>
+unsigned long long hash_fn<K>::mix(unsigned long long h)
+{
+  // Finalizer of the splitmix64 generator.
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return h;
+}
+
+template <class K>
+unsigned long long hash_fn<K>::combine(unsigned long long seed,
+                                       unsigned long long h)
+{
+  return seed ^ (h + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
 // Full template-specialized implementations of the run method picl
 // specific hash functions that are optimal for each key data type
 // provided by the template argument K.
@@ -172,32 +346,44 @@ size_t hash_fn<K>::murmur(const uintptr_t& key) const
 template<>
 size_t hash_fn<int>::run(const int& key) const
 {
+  if (this->policy_ == WIDE)
+    return this->wide_int(static_cast<unsigned long long>(key));
   return this->mod_signed(key);
 }
 template<>
 size_t hash_fn<short>::run(const short& key) const
 {
+  if (this->policy_ == WIDE)
+    return this->wide_int(static_cast<unsigned long long>(key));
   return this->mod_signed(static_cast<int>(key));
 }
 template<>
 size_t hash_fn<char>::run(const char& key) const
 {
+  if (this->policy_ == WIDE)
+    return this->wide_int(static_cast<unsigned long long>(key));
   return this->mod_signed(static_cast<int>(key));
 }
 // Unsigned integral types: unsigned | unsigned short | unsigned char
 template<>
 size_t hash_fn<unsigned>::run(const unsigned& key) const
 {
+  if (this->policy_ == WIDE)
+    return this->wide_int(key);
   return this->mod_unsigned(key);
 }
 template<>
 size_t hash_fn<unsigned short>::run(const unsigned short& key) const
 {
+  if (this->policy_ == WIDE)
+    return this->wide_int(key);
   return this->mod_unsigned(static_cast<unsigned>(key));
 }
 template<>
 size_t hash_fn<unsigned char>::run(const unsigned char& key) const
 {
+  if (this->policy_ == WIDE)
+    return this->wide_int(key);
   return this->mod_unsigned(static_cast<unsigned>(key));
 }
 // Floating-point types: float | double
@@ -206,6 +392,8 @@ size_t hash_fn<float>::run(const float& key) const
 {
   uint32_t bits;
   std::memcpy(&bits, &key, sizeof(key));
+  if (this->policy_ == WIDE)
+    return this->wide_int(bits);
   return this->mod_float(bits);
 }
 template <>
@@ -213,25 +401,35 @@ size_t hash_fn<double>::run(const double& key) const
 {
   uint64_t bits;
   std::memcpy(&bits, &key, sizeof(key));
+  if (this->policy_ == WIDE)
+    return this->wide_int(bits);
   return this->mod_double(bits);
 }
 // String container types: std::string | trie
 template<>
 size_t hash_fn<std::string>::run(const std::string& key) const
 {
+  if (this->policy_ == WIDE)
+    return this->wide_str(key);
   return this->poly_roll(key);
 }
 template<>
+unsigned long long hash_fn<std::string>::digest(const std::string& key)
+{
+  // Unseeded, since digests have to agree across tables.
+  return hash_fn<std::string>::wy_hash(key.data(), key.size(), 0);
+}
+template<>
 size_t hash_fn<trie>::run(const trie& key) const
 {
-  std::stringstream ss;
-  ss << key;
-  return this->poly_roll(ss.str());
+  return this->reduce(hash_fn<trie>::digest(key));
 }
 // Pointer types: uintptr_t
 template<>
 size_t hash_fn<uintptr_t>::run(const uintptr_t& key) const
 {
+  if (this->policy_ == WIDE)
+    return this->wide_int(key);
   switch (this->ptr_hash_)
   {
     case FNV:     return this->fnv(key);
@@ -242,208 +440,244 @@ size_t hash_fn<uintptr_t>::run(const uintptr_t& key) const
 }
 
 // Full-class specializations for hash_fn class are needed to use templated
-// data structures to be used as keys. All templated data structures in this
-// library overload << operator and are capable of streaming their contents.
-// These full-class specializations use the poly_roll hash function originally
-// defined for std::string by streaming their contents to a stringstream, then
-// using the resulting string as their key. Since all of these full class
-// specializations will use poly_roll, it is implemented as a static method
-// in hash_fn<K> class so that code duplications are minimized.
+// data structures to be used as keys. All of them implement a static digest
+// method that structurally hashes their elements with hash_fn<T>::digest, so
+// that they can in turn be used as elements of other containers, and a run
+// method that reduces the digest to the table size. Since the mix and combine
+// helpers are the same for all of them, they are implemented as static
+// methods in hash_fn<K> and called through hash_fn<std::string>, so that code
+// duplications are minimized. For the same reason, they all inherit their
+// constructors, table size, policy and seed from hash_fn<unsigned long long>,
+// along with the reduce method that applies the selected policy.
 
 // Full class specialization for dyn_array<T>.
 template <class T>
-class hash_fn<dyn_array<T> > {
+class hash_fn<dyn_array<T> >
+    : public hash_fn<unsigned long long> {
   public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const dyn_array<T>& key) const {
-      std::stringstream ss;
-      ss << key;
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    static unsigned long long digest(const dyn_array<T>& key) {
+      unsigned long long h = key.size();
+      for (size_t i = 0; i < key.size(); ++i)
+        h = hash_fn<std::string>::combine(h, hash_fn<T>::digest(key[i]));
+      return hash_fn<std::string>::mix(h);
     }
-  private:
-    size_t size_;
 };
 // Full class specialization for node<T, D>.
 template <class T, bool D>
-class hash_fn<node<T, D> > {
+class hash_fn<node<T, D> >
+    : public hash_fn<unsigned long long> {
   public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const node<T, D>& key) const {
-      std::stringstream ss;
-      ss << key;
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    // Hashes the entire chain from its head, matching node equality.
+    static unsigned long long digest(const node<T, D>& key) {
+      unsigned long long h = 0;
+      for (const node<T, D>* n = key.find_head(); n; n = n->next())
+        h = hash_fn<std::string>::combine(h, hash_fn<T>::digest(n->val()));
+      return hash_fn<std::string>::mix(h);
     }
-  private:
-    size_t size_;
 };
 // Full class specialization for linked_list<T, D>.
 template <class T, bool D>
-class hash_fn<linked_list<T, D> > {
+class hash_fn<linked_list<T, D> >
+    : public hash_fn<unsigned long long> {
 public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const linked_list<T, D>& key) const {
-      std::stringstream ss;
-      ss << key;
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    // Hashes values from head to tail, which also terminates looped lists.
+    static unsigned long long digest(const linked_list<T, D>& key) {
+      unsigned long long h = 0;
+      for (const node<T, D>* n = key.head(); n; n = n->next()) {
+        h = hash_fn<std::string>::combine(h, hash_fn<T>::digest(n->val()));
+        if (n == key.tail())
+          break;
+      }
+      return hash_fn<std::string>::mix(h);
     }
-private:
-    size_t size_;
 };
 // Full class specialization for stack<T>.
 template <class T>
-class hash_fn<stack<T> > {
+class hash_fn<stack<T> >
+    : public hash_fn<unsigned long long> {
 public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const stack<T>& key) const {
-      std::stringstream ss;
-      ss << key;
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    static unsigned long long digest(const stack<T>& key) {
+      if (!key.list_)
+        return 0;
+      return hash_fn<node<T, false> >::digest(*key.list_);
     }
-private:
-    size_t size_;
 };
 // Full class specialization for queue<T>.
 template <class T>
-class hash_fn<queue<T> > {
+class hash_fn<queue<T> >
+    : public hash_fn<unsigned long long> {
 public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const queue<T>& key) const {
-      std::stringstream ss;
-      ss << key;
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    static unsigned long long digest(const queue<T>& key) {
+      return hash_fn<linked_list<T, true> >::digest(key.list_);
     }
-private:
-    size_t size_;
 };
 // Full class specialization for graph_node<T>.
 template <class T>
-class hash_fn<graph_node<T> > {
+class hash_fn<graph_node<T> >
+    : public hash_fn<unsigned long long> {
 public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const graph_node<T>& key) const {
-      std::stringstream ss;
-      key.print_sorted(ss);
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    // Sums neighbor value digests since equality ignores neighbor order.
+    static unsigned long long digest(const graph_node<T>& key) {
+      unsigned long long deg = 0, sum = 0;
+      for (size_t n = 0; n < key.capacity(); ++n) {
+        if (key[n]) {
+          sum += hash_fn<std::string>::mix(hash_fn<T>::digest(key[n]->val()));
+          deg++;
+        }
+      }
+      unsigned long long h = hash_fn<T>::digest(key.val());
+      h = hash_fn<std::string>::combine(h, deg);
+      return hash_fn<std::string>::mix(hash_fn<std::string>::combine(h, sum));
     }
-private:
-    size_t size_;
 };
 // Full class specialization for graph<T>.
 template <class T>
-class hash_fn<graph<T> > {
+class hash_fn<graph<T> >
+    : public hash_fn<unsigned long long> {
 public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const graph<T>& key) const {
-      std::stringstream ss;
-      key.print_sorted_adj_lists(ss);
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    // Sums node digests since equality ignores node order.
+    static unsigned long long digest(const graph<T>& key) {
+      unsigned long long sum = 0;
+      for (size_t i = 0; i < key.size(); ++i)
+        sum += hash_fn<std::string>::mix(
+            hash_fn<graph_node<T> >::digest(key[i]));
+      return hash_fn<std::string>::mix(
+          hash_fn<std::string>::combine(key.size(), sum));
     }
-private:
-    size_t size_;
 };
 // Full class specialization for binary_tree<T, P>.
 template <class T, bool P>
-class hash_fn<binary_tree<T, P> > {
+class hash_fn<binary_tree<T, P> >
+    : public hash_fn<unsigned long long> {
 public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const binary_tree<T, P>& key) const {
-      std::stringstream ss;
-      ss << key;
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    // Pre-order walk over values and child presence, matching tree equality.
+    // Shared by all the binary tree classes derived from binary_tree<T, P>.
+    static unsigned long long digest(const binary_tree<T, P>& key) {
+      unsigned long long h = 0;
+      dyn_array<const binary_tree<T, P>*> path;
+      path.add(&key);
+      while (!path.is_empty()) {
+        const binary_tree<T, P>* bt = path.remove();
+        unsigned long long kids = (bt->left() ? 1 : 0) | (bt->right() ? 2 : 0);
+        h = hash_fn<std::string>::combine(h, hash_fn<T>::digest(bt->val()));
+        h = hash_fn<std::string>::combine(h, kids);
+        if (bt->right())
+          path.add(bt->right());
+        if (bt->left())
+          path.add(bt->left());
+      }
+      return hash_fn<std::string>::mix(h);
     }
-private:
-    size_t size_;
 };
 // Full class specialization for binary_search_tree<T, P>.
 template <class T, bool P>
-class hash_fn<binary_search_tree<T, P> > {
+class hash_fn<binary_search_tree<T, P> >
+    : public hash_fn<unsigned long long> {
 public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const binary_search_tree<T, P>& key) const {
-      std::stringstream ss;
-      ss << key;
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    static unsigned long long digest(const binary_search_tree<T, P>& key) {
+      return hash_fn<binary_tree<T, P> >::digest(key);
     }
-private:
-    size_t size_;
 };
 // Full class specialization for heap_tree<T, P>.
 template <class T, bool P, bool M>
-class hash_fn<heap_tree<T, P, M> > {
+class hash_fn<heap_tree<T, P, M> >
+    : public hash_fn<unsigned long long> {
 public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const heap_tree<T, P, M>& key) const {
-      std::stringstream ss;
-      ss << key;
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    static unsigned long long digest(const heap_tree<T, P, M>& key) {
+      return hash_fn<binary_tree<T, P> >::digest(key);
     }
-private:
-    size_t size_;
 };
 // Full class specialization for avl_tree<T, P>.
 template <class T, bool P>
-class hash_fn<avl_tree<T, P> > {
+class hash_fn<avl_tree<T, P> >
+    : public hash_fn<unsigned long long> {
 public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const avl_tree<T, P>& key) const {
-      std::stringstream ss;
-      ss << key;
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    static unsigned long long digest(const avl_tree<T, P>& key) {
+      return hash_fn<binary_tree<T, P> >::digest(key);
     }
-private:
-    size_t size_;
 };
 // Full class specialization for red_black_tree<T>.
 template <class T>
-class hash_fn<red_black_tree<T> > {
+class hash_fn<red_black_tree<T> >
+    : public hash_fn<unsigned long long> {
 public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const red_black_tree<T>& key) const {
-      std::stringstream ss;
-      ss << key;
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    static unsigned long long digest(const red_black_tree<T>& key) {
+      return hash_fn<binary_tree<T, true> >::digest(key);
     }
-private:
-    size_t size_;
 };
 // Full class specialization for heap<T>.
 template <class T>
-class hash_fn<heap<T> > {
+class hash_fn<heap<T> >
+    : public hash_fn<unsigned long long> {
 public:
-    hash_fn() : size_(1009) {}
-    hash_fn(size_t s) : size_(s) {}
+    using hash_fn<unsigned long long>::hash_fn;
     ~hash_fn() {}
     size_t run(const heap<T>& key) const {
-      std::stringstream ss;
-      ss << key;
-      return hash_fn<std::string>::poly_roll(ss.str(), this->size_);
+      return this->reduce(digest(key));
+    }
+    static unsigned long long digest(const heap<T>& key) {
+      return hash_fn<dyn_array<T> >::digest(key.arr_);
     }
-private:
-    size_t size_;
 };
 
 //======================================================================//
@@ -452,18 +686,62 @@ private:
 //                                                                      //
 //======================================================================//
 
+template <class K, class V>
+template <class N>
+hash_table<K, V>::entry_iterator<N>::entry_iterator(hash_list** table,
+                                                    size_t size,
+                                                    size_t bucket)
+    : table_(table),
+      size_(size),
+      bucket_(bucket),
+      entry_(nullptr)
+{
+  // Skip empty buckets up to the first entry, if there is any.
+  while (this->bucket_ < this->size_ && !this->table_[this->bucket_])
+    this->bucket_++;
+  if (this->bucket_ < this->size_)
+    this->entry_ = this->table_[this->bucket_];
+}
+
+template <class K, class V>
+template <class N>
+typename hash_table<K, V>::template entry_iterator<N>&
+hash_table<K, V>::entry_iterator<N>::operator ++ ()
+{
+  this->entry_ = this->entry_->next();
+  if (this->entry_)
+    return *this;
+  // Chain is exhausted, move on to the next non-empty bucket.
+  do {
+    this->bucket_++;
+  } while (this->bucket_ < this->size_ && !this->table_[this->bucket_]);
+  if (this->bucket_ < this->size_)
+    this->entry_ = this->table_[this->bucket_];
+  return *this;
+}
+
+template <class K, class V>
+template <class N>
+typename hash_table<K, V>::template entry_iterator<N>
+hash_table<K, V>::entry_iterator<N>::operator ++ (int)
+{
+  entry_iterator<N> prev = *this;
+  ++(*this);
+  return prev;
+}
+
 template <class K, class V>
 hash_table<K, V>::~hash_table()
 {
-  for (size_t i = 0; i < this->size_; ++i)
-    if (this->table_[i])
-      delete this->table_[i];
+  this->delete_all();
   delete[] this->table_;
+  delete this->pool_;
 }
 
 template <class K, class V>
 V hash_table<K, V>::operator [] (const K& key) const
 {
+  this->migrate(this->step_);
   hash_list* l_ptr = this->find(key);
   if (l_ptr)
     return l_ptr->val().val_;
@@ -474,10 +752,52 @@ V hash_table<K, V>::operator [] (const K& key) const
 template <class K, class V>
 bool hash_table<K, V>::contains(const K& key) const
 {
+  this->migrate(this->step_);
   hash_list* l_ptr = this->find(key);
   return (l_ptr != nullptr);
 }
 
+template <class K, class V>
+bool hash_table<K, V>::contains(const K& key, unsigned long long h) const
+{
+  this->migrate(this->step_);
+  hash_list* l_ptr = this->find(key, h);
+  return (l_ptr != nullptr);
+}
+
+template <class K, class V>
+size_t hash_table<K, V>::find_many(const dyn_array<K>& keys,
+                                   dyn_array<V*>& vals) const
+{
+  if (vals.size() != keys.size())
+    vals.resize(keys.size());
+  return this->lookup_many(keys, [&vals](size_t i, hash_list* entry) {
+    vals[i] = entry ? &(entry->val().val_) : nullptr;
+  });
+}
+
+template <class K, class V>
+size_t hash_table<K, V>::contains_many(const dyn_array<K>& keys,
+                                       dyn_array<bool>& found) const
+{
+  if (found.size() != keys.size())
+    found.resize(keys.size());
+  return this->lookup_many(keys, [&found](size_t i, hash_list* entry) {
+    found[i] = entry != nullptr;
+  });
+}
+
+template <class K, class V>
+hash_table<K, V>& hash_table<K, V>::set_max_load(float max_load)
+{
+  if (max_load < 0) {
+    std::cerr << "ERROR! Max load cannot be negative." << std::endl;
+    return *this;
+  }
+  this->max_load_ = max_load;
+  return *this;
+}
+
 template <class K, class V>
 hash_table<K, V>& hash_table<K, V>::insert(const K& key, const V& val)
 {
@@ -487,41 +807,89 @@ hash_table<K, V>& hash_table<K, V>::insert(const K& key, const V& val)
 template <class K, class V>
 hash_table<K, V>& hash_table<K, V>::insert(const hash_node<K, V>& hn)
 {
-  // Compute the table index from the node key using hash function.
-  size_t i = this->hash(hn.key_);
-  // If table element is empty, create a new head node with key-value pair.
-  if (!this->table_[i]) {
-    this->table_[i] = hash_list::create(hn);
-  // Otherwise search for the new key in the linked list and index ind.
-  }
-  else {
-    hash_list* l_ptr = this->find(hn.key_);
-    // If key exists, update its value.
-    if (l_ptr)
-      l_ptr->set_val(hn);
-    // If key doesn't exist, append the key-value pair to list.
-    else
-      this->table_[i] = this->table_[i]->prepend(hn);
+  // Compute the hash value once for both search and insertion.
+  return this->insert_node(hn, this->hash(hn.key_));
+}
+
+template <class K, class V>
+hash_table<K, V>& hash_table<K, V>::insert(const K& key, const V& val,
+                                           unsigned long long h)
+{
+  return this->insert_node(hash_node<K, V>(key, val), h);
+}
+
+template <class K, class V>
+hash_table<K, V>& hash_table<K, V>::insert_node(const hash_node<K, V>& hn,
+                                                unsigned long long h)
+{
+  this->migrate(this->step_);
+  // If key exists in either table, update its value.
+  hash_list* l_ptr = this->find(hn.key_, h);
+  if (l_ptr) {
+    // Keep the stored hash that determines the bucket of existing entry.
+    unsigned long long stored = l_ptr->val().hash_;
+    l_ptr->set_val(hn);
+    l_ptr->val().hash_ = stored;
+    return *this;
   }
+  // New keys always go to the current table, prepended to their bucket.
+  size_t i = h % this->size_;
+  hash_list* entry = this->create_entry(hn);
+  entry->val().hash_ = h;
+  entry->next() = this->table_[i];
+  this->table_[i] = entry;
+  this->count_++;
+  if (this->max_load_ > 0 && this->load_factor() > this->max_load_)
+    this->grow();
   return *this;
 }
 
 template <class K, class V>
 hash_table<K, V>& hash_table<K, V>::remove(const K& key)
 {
-  // Compute the table index from the key using hash function.
-  size_t i = this->hash(key);
-  // If a hash_list exists at this index, delete node with the matching key.
-  if (this->table_[i])
-    this->table_[i] = this->table_[i]->delete_node(hash_node<K, V>(key, V()));
-  else
+  return this->remove(key, this->hash(key));
+}
+
+template <class K, class V>
+hash_table<K, V>& hash_table<K, V>::remove(const K& key, unsigned long long h)
+{
+  this->migrate(this->step_);
+  // Find the bucket holding the key, checking the old table first.
+  hash_list** bucket = nullptr;
+  hash_list* target = nullptr;
+  if (this->old_table_) {
+    bucket = &(this->old_table_[h % this->old_size_]);
+    target = hash_table::search(*bucket, key, h);
+  }
+  if (!target) {
+    bucket = &(this->table_[h % this->size_]);
+    target = hash_table::search(*bucket, key, h);
+  }
+  if (!target) {
     std::cout << "Warning: Key not found, skipped removal." << std::endl;
+    return *this;
+  }
+  // Unlink the entry found by hash without comparing keys all over again.
+  if (*bucket == target) {
+    *bucket = target->next();
+  }
+  else {
+    hash_list* prev = *bucket;
+    while (prev->next() != target)
+      prev = prev->next();
+    prev->next() = target->next();
+  }
+  target->next() = nullptr;
+  this->delete_chain(target);
+  this->count_--;
   return *this;
 }
 
 template <class K, class V>
 dyn_array<K*> hash_table<K, V>::keys() const
 {
+  // Complete any pending migration to collect keys from a single table.
+  this->migrate(this->old_size_);
   dyn_array<K*> keys;
   for (size_t i = 0; i < this->size_; ++i) {
     hash_list* entry = table_[i];
@@ -539,6 +907,8 @@ dyn_array<K*> hash_table<K, V>::keys() const
 template <class K, class V>
 dyn_array<V*> hash_table<K, V>::vals() const
 {
+  // Complete any pending migration to collect values from a single table.
+  this->migrate(this->old_size_);
   dyn_array<V*> vals;
   for (size_t i = 0; i < this->size_; ++i) {
     hash_list* entry = table_[i];
@@ -553,14 +923,58 @@ dyn_array<V*> hash_table<K, V>::vals() const
   return vals;
 }
 
+template <class K, class V>
+typename hash_table<K, V>::iterator hash_table<K, V>::begin()
+{
+  // Complete any pending migration so that lookups can't move entries.
+  this->migrate(this->old_size_);
+  return iterator(this->table_, this->size_, 0);
+}
+
+template <class K, class V>
+typename hash_table<K, V>::const_iterator hash_table<K, V>::begin() const
+{
+  // Complete any pending migration so that lookups can't move entries.
+  this->migrate(this->old_size_);
+  return const_iterator(this->table_, this->size_, 0);
+}
+
+template <class K, class V>
+template <class F>
+void hash_table<K, V>::visit(F f)
+{
+  for (iterator it = this->begin(); it != this->end(); ++it)
+    f(static_cast<const K&>(it->key_), it->val_);
+}
+
+template <class K, class V>
+template <class F>
+void hash_table<K, V>::visit(F f) const
+{
+  for (const_iterator it = this->begin(); it != this->end(); ++it)
+    f(it->key_, it->val_);
+}
+
 template <class K, class V>
 hash_table<K, V>& hash_table<K, V>::clear()
 {
-  for (size_t i = 0; i < this->size_; ++i) {
-    if (this->table_[i]) {
-      delete this->table_[i];
-      this->table_[i] = nullptr;
-    }
+  this->delete_all();
+  return *this;
+}
+
+template <class K, class V>
+hash_table<K, V>& hash_table<K, V>::use_pool(bool enable)
+{
+  if (this->count_ > 0) {
+    std::cerr << "ERROR! Node pool can only be switched on an empty table.";
+    std::cerr << std::endl;
+    return *this;
+  }
+  if (enable && !this->pool_)
+    this->pool_ = new node_pool<hash_node<K, V>, false>();
+  else if (!enable && this->pool_) {
+    delete this->pool_;
+    this->pool_ = nullptr;
   }
   return *this;
 }
@@ -568,16 +982,200 @@ hash_table<K, V>& hash_table<K, V>::clear()
 template <class K, class V>
 node<hash_node<K, V>, false>* hash_table<K, V>::find(const K& key) const
 {
-  // Compute the table index from the node key using hash function.
-  size_t ind = this->hash(key);
-  if (!this->table_[ind])
-    return nullptr;
-  return this->table_[ind]->search(hash_node<K, V>(key, V()));
+  return this->find(key, this->hash(key));
+}
+
+template <class K, class V>
+node<hash_node<K, V>, false>*
+hash_table<K, V>::find(const K& key, unsigned long long h) const
+{
+  // Buckets that are not migrated yet still live in the old table.
+  if (this->old_table_) {
+    hash_list* l_ptr =
+        hash_table::search(this->old_table_[h % this->old_size_], key, h);
+    if (l_ptr)
+      return l_ptr;
+  }
+  return hash_table::search(this->table_[h % this->size_], key, h);
+}
+
+template <class K, class V>
+template <class Out>
+size_t hash_table<K, V>::lookup_many(const dyn_array<K>& keys, Out out) const
+{
+  unsigned long long hashes[hash_table::batch_size];
+  size_t found = 0;
+  for (size_t first = 0; first < keys.size(); first += hash_table::batch_size) {
+    size_t count = keys.size() - first;
+    if (count > hash_table::batch_size)
+      count = hash_table::batch_size;
+    // Keep migrating at the same pace as individual lookups would.
+    this->migrate(this->step_ * count);
+    // Hash all keys first, prefetching the bucket pointers they map to.
+    for (size_t j = 0; j < count; ++j) {
+      hashes[j] = this->hash(keys[first + j]);
+      hash_table::prefetch(this->table_ + hashes[j] % this->size_);
+      if (this->old_table_)
+        hash_table::prefetch(this->old_table_ + hashes[j] % this->old_size_);
+    }
+    // Bucket pointers should have arrived, so prefetch the first entries.
+    for (size_t j = 0; j < count; ++j) {
+      hash_list* head = this->table_[hashes[j] % this->size_];
+      if (head)
+        hash_table::prefetch(head);
+    }
+    // Resolve all keys once their memory is on its way to the cache.
+    for (size_t j = 0; j < count; ++j) {
+      hash_list* entry = this->find(keys[first + j], hashes[j]);
+      if (entry)
+        found++;
+      out(first + j, entry);
+    }
+  }
+  return found;
+}
+
+template <class K, class V>
+void hash_table<K, V>::prefetch(const void* addr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(addr);
+#elif defined(_MSC_VER)
+  _mm_prefetch(static_cast<const char*>(addr), _MM_HINT_T0);
+#else
+  (void)addr;
+#endif
+}
+
+template <class K, class V>
+node<hash_node<K, V>, false>*
+hash_table<K, V>::search(hash_list* entry, const K& key, unsigned long long h)
+{
+  // Deep key comparisons only run for entries with matching hashes.
+  for (; entry; entry = entry->next())
+    if (entry->val().hash_ == h && entry->val().key_ == key)
+      return entry;
+  return nullptr;
+}
+
+template <class K, class V>
+node<hash_node<K, V>, false>*
+hash_table<K, V>::create_entry(const hash_node<K, V>& hn)
+{
+  if (this->pool_)
+    return this->pool_->create(hn);
+  return hash_list::create(hn);
+}
+
+template <class K, class V>
+void hash_table<K, V>::delete_chain(hash_list* entry)
+{
+  if (this->pool_) {
+    this->pool_->destroy_chain(entry);
+    return;
+  }
+  // Unlink entries one by one rather than recursing through long chains.
+  while (entry) {
+    hash_list* next = entry->next();
+    entry->next() = nullptr;
+    delete entry;
+    entry = next;
+  }
+}
+
+template <class K, class V>
+void hash_table<K, V>::delete_all()
+{
+  // Pooled entries without destructors to run are freed in bulk, without
+  // visiting them at all.
+  bool bulk = this->pool_ && std::is_trivially_destructible<K>::value &&
+              std::is_trivially_destructible<V>::value;
+  for (size_t i = 0; i < this->size_; ++i) {
+    if (this->table_[i] && !bulk)
+      this->delete_chain(this->table_[i]);
+    this->table_[i] = nullptr;
+  }
+  if (this->old_table_) {
+    for (size_t i = this->migrate_; i < this->old_size_ && !bulk; ++i)
+      if (this->old_table_[i])
+        this->delete_chain(this->old_table_[i]);
+    delete[] this->old_table_;
+    this->old_table_ = nullptr;
+  }
+  // All entries are gone, so the pool can return its slabs to the heap.
+  if (this->pool_)
+    this->pool_->release();
+  this->count_ = 0;
+}
+
+template <class K, class V>
+void hash_table<K, V>::migrate(size_t steps) const
+{
+  if (!this->old_table_)
+    return;
+  for (; steps > 0 && this->migrate_ < this->old_size_; --steps) {
+    // Relink each node of the bucket to the head of its new bucket.
+    hash_list* entry = this->old_table_[this->migrate_];
+    while (entry) {
+      hash_list* next = entry->next();
+      size_t i = entry->val().hash_ % this->size_;
+      entry->next() = this->table_[i];
+      this->table_[i] = entry;
+      entry = next;
+    }
+    this->old_table_[this->migrate_++] = nullptr;
+  }
+  if (this->migrate_ == this->old_size_) {
+    delete[] this->old_table_;
+    this->old_table_ = nullptr;
+  }
+}
+
+template <class K, class V>
+void hash_table<K, V>::grow()
+{
+  // Only lowering the max load can leave a migration pending by now.
+  this->migrate(this->old_size_);
+  this->old_table_ = this->table_;
+  this->old_size_ = this->size_;
+  this->migrate_ = 0;
+  this->size_ = hash_table::next_prime(2 * this->size_ + 1);
+  this->table_ = new hash_list*[this->size_]();
+  // The next growth is at least room insertions away, each of which has to
+  // migrate its share of the old buckets. Rounding room down leaves a margin.
+  double room = static_cast<double>(this->max_load_) * this->size_ -
+                static_cast<double>(this->count_);
+  size_t calls = room > 1 ? static_cast<size_t>(room) : 1;
+  this->step_ = (this->old_size_ + calls - 1) / calls;
+  if (this->step_ < hash_table::migrate_steps)
+    this->step_ = hash_table::migrate_steps;
+}
+
+template <class K, class V>
+size_t hash_table<K, V>::next_prime(size_t n)
+{
+  if (n <= 2)
+    return 2;
+  if (n % 2 == 0)
+    n++;
+  for (;; n += 2) {
+    bool prime = true;
+    for (size_t d = 3; d * d <= n; d += 2) {
+      if (n % d == 0) {
+        prime = false;
+        break;
+      }
+    }
+    if (prime)
+      return n;
+  }
 }
 
 template <class K, class V>
 std::ostream& operator << (std::ostream& os, const hash_table<K, V>& ht)
 {
+  // Complete any pending migration to print a single table.
+  ht.migrate(ht.old_size_);
   // Compute the number of decimal places needed for hash table indices.
   size_t buf = ht.size_;
   size_t dec = 1;
@@ -6,6 +6,7 @@
 #include "dyn_array.h"
 
 template <class T, bool P, bool M> class heap_tree;
+template <class K> class hash_fn;
 
 // Array-based min/max heap that is more efficient than its tree-based sibling.
 // almost across the board, but especially in terms of cache locality, direct
@@ -32,6 +33,8 @@ class heap
   friend class heap_tree<T, 0, false>;
   friend class heap_tree<T, 1, true>;
   friend class heap_tree<T, 1, false>;
+  // Allows hash_fn to digest the internal array for structural hashing.
+  friend class hash_fn<heap<T> >;
 
   public:
     // Creates an empty heap. O(1) | O(1)
@@ -103,6 +106,80 @@ class heap
     bool is_max_;
 };
 
+// Array-based 4-ary min/max heap of ids in [0, N), each with a key of type K,
+// for priority queues whose elements change priority while queued, such as
+// the frontier of Dijkstra's algorithm. Holds (key, id) entries in heap order
+// in one dyn_array, and tracks the heap position and the key of every id in
+// two more, so contains() and key() are O(1) and decrease_key() sifts an id
+// up from its current position instead of inserting a duplicate entry.
+// Each id is in the heap at most once, so there are no stale entries to skip.
+// Four children per node halve the height of a binary heap, and the children
+// of a node share a cache line, which makes sifting down cheaper despite the
+// extra comparisons.
+// Ties between equal keys are broken by the smaller id, so removal order is
+// deterministic. Assumes K is default-constructable with relational operators.
+template <class K>
+class index_heap
+{
+  public:
+    // Creates an empty heap for ids in [0, n) of given type. O(N) | O(N)
+    explicit index_heap(size_t n = 0, bool is_max = false);
+
+    // Returns true if max heap. O(1) | O(1)
+    bool is_max() const {return this->is_max_;}
+    // Returns true if no ids are queued. O(1) | O(1)
+    bool is_empty() const {return this->heap_.is_empty();}
+    // Returns the number of queued ids. O(1) | O(1)
+    size_t size() const {return this->heap_.size();}
+    // Returns the number of ids the heap can hold. O(1) | O(1)
+    size_t capacity() const {return this->pos_.size();}
+    // Returns true if id is queued. O(1) | O(1)
+    bool contains(size_t id) const;
+    // Returns the key id was last queued with. O(1) | O(1)
+    const K& key(size_t id) const;
+    // Removes all ids while keeping capacity. O(1) | O(1)
+    index_heap<K>& clear() {this->heap_.clear(); return *this;}
+
+    // Queues id with the given key. Returns false if id is out of range or
+    // already queued. O(logN) | O(1)
+    bool insert(size_t id, const K& key);
+    // Moves a queued id towards the root with a smaller key on min heaps, or
+    // a larger key on max heaps. Returns false if id isn't queued or key
+    // wouldn't move it up. O(logN) | O(1)
+    bool decrease_key(size_t id, const K& key);
+    // Inserts id if it isn't queued, decreases its key otherwise. Returns
+    // true if the heap changed. O(logN) | O(1)
+    bool push(size_t id, const K& key);
+    // Removes root and returns its id. O(logN) | O(1)
+    size_t remove();
+    // Peek at the id with min/max key without removing it. O(1) | O(1)
+    size_t peek() const;
+
+  private:
+    // Number of children per node.
+    static const size_t arity = 4;
+    // Keys are stored next to their ids so that sifts compare siblings
+    // without looking up keys elsewhere.
+    struct entry
+    {
+      K key;
+      size_t id;
+    };
+    // Returns true if entry a belongs above entry b. O(1) | O(1)
+    bool before(const entry& a, const entry& b) const;
+    // Methods to sift up and sift down ids by heap position. O(logN) | O(1)
+    void sift_up(size_t i);
+    void sift_down(size_t i);
+
+    // Queued ids and their keys in heap order.
+    dyn_array<entry> heap_;
+    // Position of each id in heap_, only valid while the id is queued.
+    dyn_array<size_t> pos_;
+    // Last key of each id.
+    dyn_array<K> keys_;
+    bool is_max_;
+};
+
 // Templated class method implementations need to be accessible at the
 // point of instantiation.
 #include "heap.tpp"
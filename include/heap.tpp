@@ -259,4 +259,151 @@ std::ostream& operator << (std::ostream& os, const heap<T>& hp)
 {
   os << hp.arr_;
   return os;
-}
\ No newline at end of file
+}
+
+//======================================================================//
+//                                                                      //
+//                         index_heap<K> methods                        //
+//                                                                      //
+//======================================================================//
+
+template <class K>
+index_heap<K>::index_heap(size_t n, bool is_max)
+    : pos_(0, n), keys_(K(), n), is_max_(is_max)
+{
+  this->heap_.realloc(n);
+}
+
+template <class K>
+bool index_heap<K>::contains(size_t id) const
+{
+  // Positions of removed ids may point at other ids, so check both ways.
+  if (id >= this->capacity())
+    return false;
+  size_t i = this->pos_[id];
+  return i < this->heap_.size() && this->heap_[i].id == id;
+}
+
+template <class K>
+const K& index_heap<K>::key(size_t id) const
+{
+  assert(id < this->capacity() && "index_heap id out of bounds");
+  return this->keys_[id];
+}
+
+template <class K>
+bool index_heap<K>::insert(size_t id, const K& key)
+{
+  if (id >= this->capacity()) {
+    std::cerr << "ERROR! Cannot insert out-of-range id into index_heap.";
+    std::cerr << std::endl;
+    return false;
+  }
+  if (this->contains(id))
+    return false;
+  this->keys_[id] = key;
+  this->heap_.add(entry{key, id});
+  this->sift_up(this->heap_.size() - 1);
+  return true;
+}
+
+template <class K>
+bool index_heap<K>::decrease_key(size_t id, const K& key)
+{
+  if (!this->contains(id))
+    return false;
+  const K& old_key = this->keys_[id];
+  if (this->is_max_ ? !(old_key < key) : !(key < old_key))
+    return false;
+  this->keys_[id] = key;
+  this->heap_[this->pos_[id]].key = key;
+  this->sift_up(this->pos_[id]);
+  return true;
+}
+
+template <class K>
+bool index_heap<K>::push(size_t id, const K& key)
+{
+  if (this->contains(id))
+    return this->decrease_key(id, key);
+  return this->insert(id, key);
+}
+
+template <class K>
+size_t index_heap<K>::remove()
+{
+  if (this->is_empty()) {
+    std::cerr << "ERROR! Cannot remove from an empty index_heap." << std::endl;
+    return this->capacity();
+  }
+  size_t ret = this->heap_[0].id;
+  entry last = this->heap_.remove();
+  // Move the last id to the root and sift it down unless it was the root.
+  if (!this->is_empty()) {
+    this->heap_[0] = last;
+    this->sift_down(0);
+  }
+  return ret;
+}
+
+template <class K>
+size_t index_heap<K>::peek() const
+{
+  if (this->is_empty()) {
+    std::cerr << "ERROR! Cannot peek at an empty index_heap." << std::endl;
+    return this->capacity();
+  }
+  return this->heap_[0].id;
+}
+
+template <class K>
+bool index_heap<K>::before(const entry& a, const entry& b) const
+{
+  if (this->is_max_ ? (b.key < a.key) : (a.key < b.key))
+    return true;
+  if (this->is_max_ ? (a.key < b.key) : (b.key < a.key))
+    return false;
+  return a.id < b.id;
+}
+
+template <class K>
+void index_heap<K>::sift_up(size_t i)
+{
+  // Shift parents down into the hole until the entry's position is found.
+  entry e = this->heap_[i];
+  while (i > 0) {
+    size_t p = (i - 1) / arity;
+    if (!this->before(e, this->heap_[p]))
+      break;
+    this->heap_[i] = this->heap_[p];
+    this->pos_[this->heap_[i].id] = i;
+    i = p;
+  }
+  this->heap_[i] = e;
+  this->pos_[e.id] = i;
+}
+
+template <class K>
+void index_heap<K>::sift_down(size_t i)
+{
+  // Shift the best child up into the hole until the entry's position is found.
+  entry e = this->heap_[i];
+  size_t n = this->heap_.size();
+  while (true) {
+    size_t first = arity * i + 1;
+    if (first >= n)
+      break;
+    size_t last = (first + arity < n) ? first + arity : n;
+    size_t best = first;
+    for (size_t c = first + 1; c < last; ++c)
+      if (this->before(this->heap_[c], this->heap_[best]))
+        best = c;
+    if (!this->before(this->heap_[best], e))
+      break;
+    this->heap_[i] = this->heap_[best];
+    this->pos_[this->heap_[i].id] = i;
+    i = best;
+  }
+  this->heap_[i] = e;
+  this->pos_[e.id] = i;
+}
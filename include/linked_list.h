@@ -3,9 +3,12 @@
 
 #include <iostream>
 #include <initializer_list>
+#include <type_traits>
+#include <new>
 
 template <class T> class dyn_array;
 template <class T, bool D> class node;
+template <class T, bool D> class node_pool;
 template <class K, class V> class hash_node;
 
 // Base class that only holds next_ pointer for singly linked lists, and
@@ -92,6 +95,8 @@ class node : public node_base<T, D>
   // Allows hash_node access to the protected copy constructor for hashing.
   template <class K, class V> friend class hash_node;
   template <class U> friend class dyn_array;
+  // Allows node_pool to construct nodes in pooled memory.
+  template <class U, bool B> friend class node_pool;
 
   public:
     // Creates a new node on the heap. O(1) | O(1)
@@ -203,6 +208,78 @@ class node : public node_base<T, D>
     node<T, D>* merge(bool inc, node<T, D>* low_ptr, node<T, D>* high_ptr);
 };
 
+// Slab allocator that creates node<T, D> instances in large blocks of raw
+// memory instead of allocating each one separately on the heap.
+// Destroyed nodes are kept on a free list and recycled by later creations, so
+// workloads that keep creating and destroying nodes settle into a steady state
+// without any heap allocations. Slabs double in size as the pool grows, and
+// are only returned to the heap all at once by release, or when the pool
+// itself is destroyed.
+//
+// Pooled nodes don't own their memory and must never be deleted directly;
+// they can only be disposed of through destroy, destroy_chain or release.
+// Destroying a single node ignores its links, so it has to be detached from
+// its chain first. Releasing the pool abandons nodes that are still in use
+// without running their destructors, which is only safe for values that are
+// trivially destructible. Cannot be copied.
+template <class T, bool D>
+class node_pool
+{
+  public:
+    // Default constructor allocates no memory up front. O(1) | O(1)
+    node_pool()
+        : slabs_(nullptr),
+          slab_size_(node_pool::min_slab),
+          bump_(nullptr),
+          end_(nullptr),
+          free_(nullptr),
+          live_(0) {}
+    // Destructor returns all slabs to the heap. O(S) | O(1)
+    ~node_pool() {this->release();}
+
+    // Creates a node holding val in pooled memory. O(1) amortized | O(1)
+    node<T, D>* create(const T& val);
+    // Destroys a single node and recycles its memory. O(1) | O(1)
+    void destroy(node<T, D>* n_ptr);
+    // Destroys a node and its forward chain one by one. O(N) | O(1)
+    void destroy_chain(node<T, D>* n_ptr);
+    // Returns all slabs to the heap at once. O(S) | O(1)
+    node_pool<T, D>& release();
+    // Returns the number of nodes in use. O(1) | O(1)
+    size_t live() const {return this->live_;}
+
+  private:
+    // Smallest and largest number of nodes in a single slab.
+    static const size_t min_slab = 32;
+    static const size_t max_slab = 8192;
+
+    // Raw memory for a single node, which links free slots while unused.
+    // First slot of each slab links the previously allocated slab instead.
+    union slot {
+      slot* next;
+      typename std::aligned_storage<sizeof(node<T, D>),
+                                    alignof(node<T, D>)>::type storage;
+    };
+
+    // Pools own raw memory that can't be meaningfully duplicated.
+    node_pool(const node_pool<T, D>& source);
+    node_pool<T, D>& operator = (const node_pool<T, D>& source);
+    // Allocates the next slab, doubling its size up to max_slab. O(1) | O(S)
+    void grow();
+
+    // Most recently allocated slab, which links all the previous ones.
+    slot* slabs_;
+    // Number of nodes in the next slab to be allocated.
+    size_t slab_size_;
+    // Next never-used slot of the current slab and the end of that slab.
+    slot* bump_;
+    slot* end_;
+    // Singly-linked list of recycled slots.
+    slot* free_;
+    // Number of nodes created but not yet destroyed.
+    size_t live_;
+};
+
 // Linked list wrapper class manages a node chain by continuously tracking its
 // head and tail nodes only, and represents its empty state by nullifying both.
 // Provides a cleaner way to manage and interact with linked list chains.
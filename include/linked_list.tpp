@@ -867,6 +867,83 @@ std::ostream& operator << (std::ostream& os, const node<T, D>& n_ins)
   return os;
 }
 
+//======================================================================//
+//                                                                      //
+//                       node_pool<T, D> methods                        //
+//                                                                      //
+//======================================================================//
+
+template <class T, bool D>
+node<T, D>* node_pool<T, D>::create(const T& val)
+{
+  slot* s;
+  // Recycled slots take priority over fresh ones to keep memory compact.
+  if (this->free_) {
+    s = this->free_;
+    this->free_ = s->next;
+  }
+  else {
+    if (this->bump_ == this->end_)
+      this->grow();
+    s = this->bump_++;
+  }
+  this->live_++;
+  return new (&s->storage) node<T, D>(val);
+}
+
+template <class T, bool D>
+void node_pool<T, D>::destroy(node<T, D>* n_ptr)
+{
+  // Unlink first so that the destructor doesn't delete the chain.
+  n_ptr->next() = nullptr;
+  n_ptr->prev() = nullptr;
+  n_ptr->~node();
+  slot* s = reinterpret_cast<slot*>(n_ptr);
+  s->next = this->free_;
+  this->free_ = s;
+  this->live_--;
+}
+
+template <class T, bool D>
+void node_pool<T, D>::destroy_chain(node<T, D>* n_ptr)
+{
+  while (n_ptr) {
+    node<T, D>* next = n_ptr->next();
+    this->destroy(n_ptr);
+    n_ptr = next;
+  }
+}
+
+template <class T, bool D>
+node_pool<T, D>& node_pool<T, D>::release()
+{
+  while (this->slabs_) {
+    slot* prev = this->slabs_->next;
+    ::operator delete(this->slabs_);
+    this->slabs_ = prev;
+  }
+  this->slab_size_ = node_pool::min_slab;
+  this->bump_ = nullptr;
+  this->end_ = nullptr;
+  this->free_ = nullptr;
+  this->live_ = 0;
+  return *this;
+}
+
+template <class T, bool D>
+void node_pool<T, D>::grow()
+{
+  // Reserve one extra slot at the front to link the previous slab.
+  slot* slab = static_cast<slot*>(
+      ::operator new((this->slab_size_ + 1) * sizeof(slot)));
+  slab->next = this->slabs_;
+  this->slabs_ = slab;
+  this->bump_ = slab + 1;
+  this->end_ = slab + 1 + this->slab_size_;
+  if (this->slab_size_ < node_pool::max_slab)
+    this->slab_size_ *= 2;
+}
+
 //======================================================================//
 //                                                                      //
 //                      linked_list<T, D> methods                       //
@@ -887,6 +964,7 @@ linked_list<T, D>::linked_list(const linked_list<T, D>& source)
   if (source.is_empty()) {
     this->head_ = nullptr;
     this->tail_ = nullptr;
+    return;
   }
   else {
     this->head_ = source.head_->clone_node();
@@ -0,0 +1,95 @@
+#ifndef mapped_array_h_
+#define mapped_array_h_
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include "dyn_array.h"
+#include "file_map.h"
+
+// File-backed variant of dyn_array<T> for datasets of trivially copyable
+// records that don't fit in memory. Maps a file holding a 64-byte header and
+// the raw array of elements into memory, and adopts the mapped elements as
+// its dyn_array<T> base storage, so that every dyn_array<T> method works on
+// the file in place while the kernel pages records in and out as needed.
+// Growing past capacity extends the file and remaps it, which may move the
+// elements to a different address. Sync and destruction write the size and
+// the sorted_ flag to the header, and destruction trims the file to its size,
+// so reopening a sorted file binary searches it right away.
+// Sorts and searches that touch the whole array benefit from advising the
+// kernel of their access pattern: SEQUENTIAL for scans and the passes of
+// merge and radix sorts, RANDOM for binary searches. Note that sorts other
+// than quick_sort, intro_sort and heap_sort allocate heap buffers as large
+// as the array.
+// Opening a file fails with an error message if its header doesn't match T,
+// or on platforms without POSIX mmap, in which case the array falls back to
+// heap storage and is not saved. Copies and moves of dyn_array<T> work both
+// ways, but mapped_array itself can't be copied, since it owns its file.
+template <class T>
+class mapped_array : public dyn_array<T>
+{
+  public:
+    // Opens the file at path, creating an empty array if it doesn't exist.
+    // O(1) | O(1)
+    explicit mapped_array(const std::string& path);
+    // Files are owned by a single array, which can't be copied.
+    mapped_array(const mapped_array<T>& source) = delete;
+    // Saves the header, trims the file and closes it. O(1) | O(1)
+    ~mapped_array();
+
+    // Assignment operators copy or move source elements to the file.
+    // O(N) | O(N)
+    mapped_array<T>& operator = (const mapped_array<T>& source);
+    mapped_array<T>& operator = (const dyn_array<T>& source);
+    mapped_array<T>& operator = (dyn_array<T>&& source);
+
+    // Returns true if the elements are stored in the file. O(1) | O(1)
+    bool is_open() const {return this->mapped_;}
+    // Returns the path of the file. O(1) | O(1)
+    const std::string& path() const {return this->path_;}
+    // Advises the kernel of the upcoming access pattern. O(1) | O(1)
+    mapped_array<T>& advise(file_map::Advice advice);
+    // Saves the header and writes all changes to the file. O(N) | O(1)
+    mapped_array<T>& sync();
+
+  private:
+    // File layout version, bumped whenever the header changes.
+    static const std::uint32_t version = 1;
+    // Header at the start of the file, followed by the elements.
+    struct header
+    {
+      char magic[8];
+      std::uint32_t version;
+      std::uint32_t elem_size;
+      std::uint64_t size;
+      std::int32_t sorted;
+      char reserved[36];
+    };
+    static_assert(sizeof(header) == 64, "Header must take 64 bytes");
+
+    // Growth hook installed as dyn_array<T>::remap_, which dyn_array<T>
+    // calls when mapped storage runs out of capacity. Mapped storage only
+    // ever belongs to a mapped_array, so arr is always one. O(1) | O(1)
+    static void remap_hook(dyn_array<T>& arr, size_t n);
+    // Extends the file to n elements and adopts the new mapping. Throws
+    // std::bad_alloc if the file can't grow, like failed heap allocations.
+    // O(1) | O(1)
+    void remap(size_t n);
+    // Returns the header at the start of the mapping. O(1) | O(1)
+    header* head() const {return reinterpret_cast<header*>(this->file_.data());}
+    // Writes size_ and sorted_ to the header. O(1) | O(1)
+    void save();
+
+    // Path of the file, kept for error messages.
+    std::string path_;
+    // Mapping of the whole file.
+    file_map file_;
+};
+
+// Templated class method implementations need to be accessible at the
+// point of instantiation.
+#include "mapped_array.tpp"
+
+#endif
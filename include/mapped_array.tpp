@@ -0,0 +1,132 @@
+// The header is included primarily to get rid of IntelliSense squigglies.
+// The class should build and run properly without it. Header guard protection
+// prevents the apparent circular inclusion from causing any problems.
+#include "mapped_array.h"
+
+//======================================================================//
+//                                                                      //
+//                        mapped_array<T> methods                       //
+//                                                                      //
+//======================================================================//
+
+template <class T>
+mapped_array<T>::mapped_array(const std::string& path): path_(path)
+{
+  // Checked here rather than in the class, which dyn_array<T> names for all T.
+  static_assert(std::is_trivially_copyable<T>::value,
+                "mapped_array elements must be trivially copyable");
+  static_assert(alignof(T) <= 64, "mapped_array elements must fit alignment");
+  if (!this->file_.open(path)) {
+    std::cerr << "ERROR! Could not open " << path << " for mapping.";
+    std::cerr << std::endl;
+    return;
+  }
+  // New files start with a header and no elements.
+  if (this->file_.length() == 0) {
+    if (!this->file_.resize(sizeof(header))) {
+      std::cerr << "ERROR! Could not write a header to " << path << ".";
+      std::cerr << std::endl;
+      this->file_.close();
+      return;
+    }
+    std::memcpy(this->head()->magic, "cppdata", 8);
+    this->head()->version = version;
+    this->head()->elem_size = sizeof(T);
+  }
+  size_t len = this->file_.length();
+  size_t cap = len < sizeof(header) ? 0 : (len - sizeof(header)) / sizeof(T);
+  if (len < sizeof(header) || std::memcmp(this->head()->magic, "cppdata", 8) ||
+      this->head()->version != version ||
+      this->head()->elem_size != sizeof(T) || this->head()->size > cap) {
+    std::cerr << "ERROR! " << path << " doesn't hold a mapped_array of ";
+    std::cerr << sizeof(T) << "-byte elements." << std::endl;
+    this->file_.close();
+    return;
+  }
+  this->list_ = reinterpret_cast<T*>(this->file_.data() + sizeof(header));
+  this->capacity_ = cap;
+  this->size_ = static_cast<size_t>(this->head()->size);
+  this->sorted_ = this->head()->sorted;
+  dyn_array<T>::remap_.store(&mapped_array<T>::remap_hook,
+                             std::memory_order_relaxed);
+  this->mapped_ = true;
+}
+
+template <class T>
+mapped_array<T>::~mapped_array()
+{
+  if (!this->mapped_)
+    return;
+  this->save();
+  // Spare capacity is dropped, the kernel writes back dirty pages on its own.
+  this->file_.resize(sizeof(header) + this->size_ * sizeof(T));
+  this->file_.close();
+  // Leave nothing for the dyn_array<T> destructor to release.
+  this->list_ = nullptr;
+  this->size_ = 0;
+  this->capacity_ = 0;
+  this->mapped_ = false;
+}
+
+template <class T>
+mapped_array<T>& mapped_array<T>::operator = (const mapped_array<T>& source)
+{
+  dyn_array<T>::operator = (source);
+  return *this;
+}
+
+template <class T>
+mapped_array<T>& mapped_array<T>::operator = (const dyn_array<T>& source)
+{
+  dyn_array<T>::operator = (source);
+  return *this;
+}
+
+template <class T>
+mapped_array<T>& mapped_array<T>::operator = (dyn_array<T>&& source)
+{
+  dyn_array<T>::operator = (std::move(source));
+  return *this;
+}
+
+template <class T>
+mapped_array<T>& mapped_array<T>::advise(file_map::Advice advice)
+{
+  this->file_.advise(advice);
+  return *this;
+}
+
+template <class T>
+mapped_array<T>& mapped_array<T>::sync()
+{
+  if (this->mapped_) {
+    this->save();
+    this->file_.sync();
+  }
+  return *this;
+}
+
+template <class T>
+void mapped_array<T>::remap_hook(dyn_array<T>& arr, size_t n)
+{
+  static_cast<mapped_array<T>&>(arr).remap(n);
+}
+
+template <class T>
+void mapped_array<T>::remap(size_t n)
+{
+  if (!this->file_.resize(sizeof(header) + n * sizeof(T))) {
+    std::cerr << "ERROR! Could not grow " << this->path_ << " to " << n;
+    std::cerr << " elements." << std::endl;
+    throw std::bad_alloc();
+  }
+  this->list_ = reinterpret_cast<T*>(this->file_.data() + sizeof(header));
+  this->capacity_ = n;
+}
+
+template <class T>
+void mapped_array<T>::save()
+{
+  this->head()->size = this->size_;
+  this->head()->sorted = this->sorted_;
+}
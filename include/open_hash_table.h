@@ -0,0 +1,162 @@
+#ifndef open_hash_table_h_
+#define open_hash_table_h_
+
+#include <iostream>
+#include <iomanip>
+#include "hash_table.h"
+
+// Open-addressing counterpart of hash_table<K, V> with the same interface.
+// Stores key-value pairs in a contiguous raw array of hash_node<K, V> slots
+// instead of chains of heap-allocated nodes, so lookups walk adjacent memory
+// rather than chasing pointers.
+// Capacity is always a power of two and doubles whenever the load factor
+// would exceed 7/8, so the table never degrades into long probe sequences no
+// matter how many keys are inserted.
+//
+// Collisions are resolved with Robin Hood linear probing. A parallel metadata
+// array holds a single byte per slot: 0 marks an empty slot, otherwise it is
+// the 1-based distance of its entry from its home slot. Insertions steal the
+// slot of any entry that is closer to its home than the incoming one, which
+// keeps probe distances short and uniform. Lookups stop as soon as they reach
+// a slot whose entry is closer to home than the searched key would be, so
+// misses are as cheap as hits. Removals shift the following entries one slot
+// back instead of leaving tombstones, keeping the invariant intact.
+//
+// Uses the same hash_fn<K> specializations as hash_table<K, V>, constructed
+// with a 64-bit prime modulus so that they produce full-range hash values.
+// These values are stored in each hash_node<K, V> slot to avoid recomputing
+// them on resize and to skip deep key comparisons on mismatching hashes. They
+// are mapped to slot indices with Fibonacci multiplicative hashing, which
+// spreads out the consecutive values that modulus-based hash functions produce.
+// A hash function that maps more than 254 distinct keys to the same value
+// makes the table grow on every insertion and must be avoided.
+//
+// Batch lookups with find_many and contains_many hash a group of keys first,
+// prefetching their home slots, and only then probe them, so that the cache
+// misses of all the keys in the group overlap.
+template <class K, class V>
+class open_hash_table
+{
+  public:
+    // Default constructor starts with 16 slots. O(1) | O(1)
+    open_hash_table() {this->init(16, hash_fn<K>(open_hash_table::wide));}
+    // Constructs with at least the specified capacity. O(T) | O(T)
+    open_hash_table(size_t capacity)
+        {this->init(capacity, hash_fn<K>(open_hash_table::wide));}
+    // Constructs with capacity and hash function for pointer keys. O(T) | O(T)
+    open_hash_table(size_t capacity, PtrHashType ptr_h)
+        {this->init(capacity, hash_fn<K>(open_hash_table::wide, ptr_h));}
+    // Constructs with capacity, hash policy and seed for all keys.
+    // O(T) | O(T)
+    open_hash_table(size_t capacity, HashPolicy policy,
+                    unsigned long long seed = 0)
+        {this->init(capacity,
+                    hash_fn<K>(open_hash_table::wide, FNV, policy, seed));}
+    // Copy constructor. O(T) | O(T)
+    open_hash_table(const open_hash_table<K, V>& other);
+    // Destructor deallocates the array members. O(T) | O(T)
+    ~open_hash_table();
+
+    // Copy assignment operator. O(T) | O(T)
+    open_hash_table<K, V>& operator = (const open_hash_table<K, V>& other);
+    // Returns a copy of key's value. O(1) average, O(N) worst | O(1)
+    V operator [] (const K& key) const;
+    // Returns true if key is in the table. O(1) average, O(N) worst | O(1)
+    bool contains(const K& key) const;
+    // Same as contains, with key's hash precomputed by hash_code.
+    // O(1) average, O(N) worst | O(1)
+    bool contains(const K& key, unsigned long long h) const;
+    // Returns the full hash value of key used to place it in the table.
+    // O(1) for fundamental types, O(L) for containers | O(1)
+    unsigned long long hash_code(const K& key) const {return this->hash(key);}
+    // Looks up a batch of keys, setting each element of vals to point to the
+    // matching value or to nullptr if the key is missing. Resizes vals only if
+    // its size differs from keys. Returns the number of keys found.
+    // O(M) average, O(M*N) worst | O(1)
+    size_t find_many(const dyn_array<K>& keys, dyn_array<V*>& vals) const;
+    // Checks a batch of keys, setting each element of found to true if the
+    // matching key is in the table. Resizes found only if its size differs
+    // from keys. Returns the number of keys found.
+    // O(M) average, O(M*N) worst | O(1)
+    size_t contains_many(const dyn_array<K>& keys,
+                         dyn_array<bool>& found) const;
+    // Returns the number of slots in the table, which is tracked. O(1) | O(1)
+    size_t size() const {return this->cap_;}
+    // Returns the number of key-value pairs in the table. O(1) | O(1)
+    size_t count() const {return this->count_;}
+    // Removes all entries while keeping the capacity. O(T) | O(1)
+    open_hash_table<K, V>& clear();
+    // Grows the table to hold n entries without resizing. O(N+T) | O(T)
+    open_hash_table<K, V>& reserve(size_t n);
+
+    // Inserts a key-value pair to the table. O(1) amortized, O(N) worst | O(1)
+    open_hash_table<K, V>& insert(const K& key, const V& val);
+    // Inserts a hash_node to the table. O(1) amortized, O(N) worst | O(1)
+    open_hash_table<K, V>& insert(const hash_node<K, V>& hn);
+    // Same as insert, with key's hash precomputed by hash_code.
+    // O(1) amortized, O(N) worst | O(1)
+    open_hash_table<K, V>& insert(const K& key, const V& val,
+                                  unsigned long long h);
+    // Deletes the entry with the given key. O(1) average, O(N) worst | O(1)
+    open_hash_table<K, V>& remove(const K& key);
+    // Return pointers to all the keys in the table. O(T) | O(N)
+    dyn_array<K*> keys() const;
+    // Return pointers to all the values in the table. O(T) | O(N)
+    dyn_array<V*> vals() const;
+
+    // Prints table contents to output stream. O(T) | O(1)
+    template <class Key, class Val>
+    friend std::ostream& operator << (std::ostream& os,
+                                      const open_hash_table<Key, Val>& ht);
+
+  private:
+    // Largest prime below 2^64 (2^32 on 32-bit platforms), used as modulus
+    // for full-range hash values.
+    static const size_t wide = sizeof(size_t) >= 8
+        ? static_cast<size_t>(18446744073709551557ULL) : 4294967291UL;
+    // Largest 1-based probe distance a slot can record.
+    static const unsigned char max_dist = 255;
+    // Number of keys whose memory accesses are overlapped by batch lookups.
+    static const size_t batch_size = 16;
+
+    // Allocates empty arrays for at least the given capacity. O(T) | O(T)
+    void init(size_t capacity, const hash_fn<K>& hash);
+    // Hash function is run through the hash_fn class.
+    // O(1) for fundamental types, O(L) for containers | O(1)
+    unsigned long long hash(const K& key) const {return this->hash_.run(key);}
+    // Maps a hash value to its home slot. O(1) | O(1)
+    size_t home(unsigned long long h) const;
+    // Returns the slot index of key or cap_ if missing. O(1) average | O(1)
+    size_t find(const K& key, unsigned long long h) const;
+    // Runs batch lookups, calling out(i, slot) with the slot of each key.
+    // O(M) average, O(M*N) worst | O(1)
+    template <class Out>
+    size_t lookup_many(const dyn_array<K>& keys, Out out) const;
+    // Inserts or updates an entry with its precomputed key hash.
+    // O(1) amortized, O(N) worst | O(1)
+    open_hash_table<K, V>& insert_node(const hash_node<K, V>& hn,
+                                       unsigned long long h);
+    // Robin Hood insertion of an entry known to be absent. O(1) avg | O(1)
+    void place(hash_node<K, V> hn, unsigned long long h);
+    // Moves all entries to a table with the given capacity. O(N+T) | O(T)
+    void rehash(size_t capacity);
+
+    // Number of slots, always a power of two.
+    size_t cap_;
+    // Number of occupied slots.
+    size_t count_;
+    // Right shift that maps 64-bit products to slot indices.
+    unsigned shift_;
+    // Hashing function used to build full-range hash values.
+    hash_fn<K> hash_;
+    // Contiguous array of key-value slots.
+    hash_node<K, V>* slots_;
+    // Probe distance metadata, 0 for empty slots.
+    unsigned char* dist_;
+};
+
+// Templated class method implementations need to be accessible at the
+// point of instantiation.
+#include "open_hash_table.tpp"
+
+#endif
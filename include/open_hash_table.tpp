@@ -0,0 +1,337 @@
+// The header is included primarily to get rid of IntelliSense squigglies.
+// The class should build and run properly without it. Header guard protection
+// prevents the apparent circular inclusion from causing any problems.
+#include "open_hash_table.h"
+
+//======================================================================//
+//                                                                      //
+//                    open_hash_table<K, V> methods                     //
+//                                                                      //
+//======================================================================//
+
+template <class K, class V>
+open_hash_table<K, V>::open_hash_table(const open_hash_table<K, V>& other)
+    : cap_(other.cap_),
+      count_(other.count_),
+      shift_(other.shift_),
+      hash_(other.hash_),
+      slots_(new hash_node<K, V>[other.cap_]),
+      dist_(new unsigned char[other.cap_])
+{
+  for (size_t i = 0; i < this->cap_; ++i) {
+    this->dist_[i] = other.dist_[i];
+    if (other.dist_[i])
+      this->slots_[i] = other.slots_[i];
+  }
+}
+
+template <class K, class V>
+open_hash_table<K, V>::~open_hash_table()
+{
+  delete[] this->slots_;
+  delete[] this->dist_;
+}
+
+template <class K, class V>
+open_hash_table<K, V>&
+open_hash_table<K, V>::operator = (const open_hash_table<K, V>& other)
+{
+  if (this == &other)
+    return *this;
+  open_hash_table<K, V> copy(other);
+  std::swap(this->cap_, copy.cap_);
+  std::swap(this->count_, copy.count_);
+  std::swap(this->shift_, copy.shift_);
+  std::swap(this->hash_, copy.hash_);
+  std::swap(this->slots_, copy.slots_);
+  std::swap(this->dist_, copy.dist_);
+  return *this;
+}
+
+template <class K, class V>
+V open_hash_table<K, V>::operator [] (const K& key) const
+{
+  size_t i = this->find(key, this->hash(key));
+  if (i < this->cap_)
+    return this->slots_[i].val_;
+  std::cerr << "ERROR! Key not found: " << key << std::endl;
+  return V();
+}
+
+template <class K, class V>
+bool open_hash_table<K, V>::contains(const K& key) const
+{
+  return this->find(key, this->hash(key)) < this->cap_;
+}
+
+template <class K, class V>
+bool open_hash_table<K, V>::contains(const K& key, unsigned long long h) const
+{
+  return this->find(key, h) < this->cap_;
+}
+
+template <class K, class V>
+size_t open_hash_table<K, V>::find_many(const dyn_array<K>& keys,
+                                        dyn_array<V*>& vals) const
+{
+  if (vals.size() != keys.size())
+    vals.resize(keys.size());
+  const open_hash_table<K, V>* ht = this;
+  return this->lookup_many(keys, [&vals, ht](size_t i, size_t slot) {
+    vals[i] = slot < ht->cap_ ? &(ht->slots_[slot].val_) : nullptr;
+  });
+}
+
+template <class K, class V>
+size_t open_hash_table<K, V>::contains_many(const dyn_array<K>& keys,
+                                            dyn_array<bool>& found) const
+{
+  if (found.size() != keys.size())
+    found.resize(keys.size());
+  const open_hash_table<K, V>* ht = this;
+  return this->lookup_many(keys, [&found, ht](size_t i, size_t slot) {
+    found[i] = slot < ht->cap_;
+  });
+}
+
+template <class K, class V>
+open_hash_table<K, V>& open_hash_table<K, V>::clear()
+{
+  for (size_t i = 0; i < this->cap_; ++i) {
+    if (this->dist_[i]) {
+      // Reset the slot to release any memory held by its key and value.
+      this->slots_[i] = hash_node<K, V>();
+      this->dist_[i] = 0;
+    }
+  }
+  this->count_ = 0;
+  return *this;
+}
+
+template <class K, class V>
+open_hash_table<K, V>& open_hash_table<K, V>::reserve(size_t n)
+{
+  // Find the smallest capacity that holds n entries within the max load.
+  size_t capacity = this->cap_;
+  while (n * 8 > capacity * 7)
+    capacity <<= 1;
+  if (capacity > this->cap_)
+    this->rehash(capacity);
+  return *this;
+}
+
+template <class K, class V>
+open_hash_table<K, V>& open_hash_table<K, V>::insert(const K& key, const V& val)
+{
+  return this->insert(hash_node<K, V>(key, val));
+}
+
+template <class K, class V>
+open_hash_table<K, V>&
+open_hash_table<K, V>::insert(const hash_node<K, V>& hn)
+{
+  return this->insert_node(hn, this->hash(hn.key_));
+}
+
+template <class K, class V>
+open_hash_table<K, V>&
+open_hash_table<K, V>::insert(const K& key, const V& val, unsigned long long h)
+{
+  return this->insert_node(hash_node<K, V>(key, val), h);
+}
+
+template <class K, class V>
+open_hash_table<K, V>&
+open_hash_table<K, V>::insert_node(const hash_node<K, V>& hn,
+                                   unsigned long long h)
+{
+  size_t mask = this->cap_ - 1;
+  size_t i = this->home(h);
+  // If key exists, update its value. Search stops at the first slot whose
+  // entry is closer to its home than the key would be at that position.
+  for (unsigned d = 1; d <= this->dist_[i]; ++d, i = (i + 1) & mask) {
+    if (this->slots_[i].hash_ == h && this->slots_[i].key_ == hn.key_) {
+      this->slots_[i].val_ = hn.val_;
+      return *this;
+    }
+  }
+  // Grow before placing the new entry if it would exceed the max load.
+  if ((this->count_ + 1) * 8 > this->cap_ * 7)
+    this->rehash(this->cap_ << 1);
+  this->place(hn, h);
+  return *this;
+}
+
+template <class K, class V>
+open_hash_table<K, V>& open_hash_table<K, V>::remove(const K& key)
+{
+  size_t i = this->find(key, this->hash(key));
+  if (i == this->cap_) {
+    std::cout << "Warning: Key not found, skipped removal." << std::endl;
+    return *this;
+  }
+  // Backward-shift deletion: pull each following entry that isn't at its
+  // home slot one step closer to it, until an empty or home slot is reached.
+  size_t mask = this->cap_ - 1;
+  size_t j = (i + 1) & mask;
+  while (this->dist_[j] > 1) {
+    this->slots_[i] = this->slots_[j];
+    this->dist_[i] = this->dist_[j] - 1;
+    i = j;
+    j = (j + 1) & mask;
+  }
+  this->slots_[i] = hash_node<K, V>();
+  this->dist_[i] = 0;
+  this->count_--;
+  return *this;
+}
+
+template <class K, class V>
+dyn_array<K*> open_hash_table<K, V>::keys() const
+{
+  dyn_array<K*> keys;
+  for (size_t i = 0; i < this->cap_; ++i)
+    if (this->dist_[i])
+      keys.add(&(this->slots_[i].key_));
+  return keys;
+}
+
+template <class K, class V>
+dyn_array<V*> open_hash_table<K, V>::vals() const
+{
+  dyn_array<V*> vals;
+  for (size_t i = 0; i < this->cap_; ++i)
+    if (this->dist_[i])
+      vals.add(&(this->slots_[i].val_));
+  return vals;
+}
+
+template <class K, class V>
+void open_hash_table<K, V>::init(size_t capacity, const hash_fn<K>& hash)
+{
+  // Round capacity up to a power of two no smaller than 8.
+  this->cap_ = 8;
+  this->shift_ = 61;
+  while (this->cap_ < capacity) {
+    this->cap_ <<= 1;
+    this->shift_--;
+  }
+  this->count_ = 0;
+  this->hash_ = hash;
+  this->slots_ = new hash_node<K, V>[this->cap_];
+  this->dist_ = new unsigned char[this->cap_]();
+}
+
+template <class K, class V>
+size_t open_hash_table<K, V>::home(unsigned long long h) const
+{
+  // Multiply by 2^64 divided by the golden ratio and keep the top bits.
+  const unsigned long long fib = 11400714819323198485ULL;
+  return static_cast<size_t>((h * fib) >> this->shift_);
+}
+
+template <class K, class V>
+size_t open_hash_table<K, V>::find(const K& key, unsigned long long h) const
+{
+  size_t mask = this->cap_ - 1;
+  size_t i = this->home(h);
+  for (unsigned d = 1; d <= this->dist_[i]; ++d, i = (i + 1) & mask)
+    if (this->slots_[i].hash_ == h && this->slots_[i].key_ == key)
+      return i;
+  return this->cap_;
+}
+
+template <class K, class V>
+template <class Out>
+size_t open_hash_table<K, V>::lookup_many(const dyn_array<K>& keys,
+                                          Out out) const
+{
+  unsigned long long hashes[open_hash_table::batch_size];
+  size_t found = 0;
+  for (size_t first = 0; first < keys.size();
+       first += open_hash_table::batch_size) {
+    size_t count = keys.size() - first;
+    if (count > open_hash_table::batch_size)
+      count = open_hash_table::batch_size;
+    // Hash all keys first, prefetching the metadata and slots they map to.
+    for (size_t j = 0; j < count; ++j) {
+      hashes[j] = this->hash(keys[first + j]);
+      size_t i = this->home(hashes[j]);
+      hash_table<K, V>::prefetch(this->dist_ + i);
+      hash_table<K, V>::prefetch(this->slots_ + i);
+    }
+    // Probe all keys once their memory is on its way to the cache.
+    for (size_t j = 0; j < count; ++j) {
+      size_t slot = this->find(keys[first + j], hashes[j]);
+      if (slot < this->cap_)
+        found++;
+      out(first + j, slot);
+    }
+  }
+  return found;
+}
+
+template <class K, class V>
+void open_hash_table<K, V>::place(hash_node<K, V> hn, unsigned long long h)
+{
+  hn.hash_ = h;
+  size_t mask = this->cap_ - 1;
+  size_t i = this->home(h);
+  unsigned char d = 1;
+  while (this->dist_[i]) {
+    // Robin Hood: take the slot from an entry closer to its home, then
+    // continue probing to find a new slot for the displaced entry.
+    if (this->dist_[i] < d) {
+      std::swap(this->slots_[i], hn);
+      std::swap(this->dist_[i], d);
+    }
+    i = (i + 1) & mask;
+    // Out of metadata range: grow and start over with the carried entry.
+    if (d == open_hash_table::max_dist) {
+      this->rehash(this->cap_ << 1);
+      this->place(hn, hn.hash_);
+      return;
+    }
+    d++;
+  }
+  this->slots_[i] = hn;
+  this->dist_[i] = d;
+  this->count_++;
+}
+
+template <class K, class V>
+void open_hash_table<K, V>::rehash(size_t capacity)
+{
+  size_t old_cap = this->cap_;
+  hash_node<K, V>* old_slots = this->slots_;
+  unsigned char* old_dist = this->dist_;
+  this->init(capacity, this->hash_);
+  // Stored hash values let entries move without rehashing their keys.
+  for (size_t i = 0; i < old_cap; ++i)
+    if (old_dist[i])
+      this->place(old_slots[i], old_slots[i].hash_);
+  delete[] old_slots;
+  delete[] old_dist;
+}
+
+template <class K, class V>
+std::ostream& operator << (std::ostream& os, const open_hash_table<K, V>& ht)
+{
+  // Compute the number of decimal places needed for table indices.
+  size_t buf = ht.cap_;
+  size_t dec = 1;
+  while (buf >= 10) {
+    dec++;
+    buf = buf / 10;
+  }
+  for (size_t i = 0; i < ht.cap_; ++i) {
+    os << std::setw(dec) << i << ". ";
+    if (!ht.dist_[i])
+      os << "NULL";
+    else
+      os << "(\"" << ht.slots_[i].key_ << "\":" << ht.slots_[i].val_ << ")";
+    if (i < (ht.cap_ - 1))
+      os << std::endl;
+  }
+  return os;
+}
@@ -7,6 +7,8 @@
 #include "dyn_array.h"
 #include "linked_list.h"
 
+template <class K> class hash_fn;
+
 // General-purpose queue that runs a linked_list<T, true> under the hood for
 // O(1) tail access, and is mostly a thin wrapper around it that exposes a
 // clean queue interface.
@@ -21,6 +23,9 @@
 template <class T>
 class queue
 {
+  // Allows hash_fn to digest the underlying list for structural hashing.
+  friend class hash_fn<queue<T> >;
+
   public:
     // Default constructor creates an empty queue. O(1) | O(1)
     queue(): size_(0) {}
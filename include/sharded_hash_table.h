@@ -0,0 +1,119 @@
+#ifndef sharded_hash_table_h_
+#define sharded_hash_table_h_
+
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include "hash_table.h"
+
+// Thread-safe counterpart of hash_table<K, V> for multi-threaded readers and
+// writers. Splits the key space into a power-of-two number of shards, each of
+// which is an independent hash_table<K, V> guarded by its own mutex, so that
+// threads working on different shards never wait on each other. With enough
+// shards, contention stays low even when every thread keeps writing.
+//
+// Each key is hashed once, outside of any lock, with the same hash_fn<K> the
+// shards are constructed with. Its shard is picked with Fibonacci
+// multiplicative hashing of the full hash value, and the same hash value is
+// passed on to the shard, so it is never recomputed while the lock is held.
+// Shards are aligned to cache lines, keeping their mutexes apart.
+//
+// Every method that touches a single key locks only that key's shard, so
+// these methods are linearizable. Methods that walk the whole table, namely
+// count, clear, keys and vals, lock one shard at a time, and only see a
+// consistent snapshot if no other thread is writing concurrently. Since
+// pointers into a shard could be invalidated by another thread at any time,
+// lookups, keys and vals return copies instead of pointers.
+template <class K, class V>
+class sharded_hash_table
+{
+  public:
+    // Default constructor uses 64 shards of 67 buckets each. O(S) | O(S)
+    sharded_hash_table() {this->init(4288, 64, FNV, CLASSIC, 0);}
+    // Constructs with the total number of buckets split over at least the
+    // specified number of shards. O(S+T) | O(S+T)
+    sharded_hash_table(size_t table_size, size_t shard_count)
+        {this->init(table_size, shard_count, FNV, CLASSIC, 0);}
+    // Constructs with table size, shard count and hash function for pointer
+    // keys. O(S+T) | O(S+T)
+    sharded_hash_table(size_t table_size, size_t shard_count, PtrHashType ptr_h)
+        {this->init(table_size, shard_count, ptr_h, CLASSIC, 0);}
+    // Constructs with table size, shard count, hash policy and seed for all
+    // keys. O(S+T) | O(S+T)
+    sharded_hash_table(size_t table_size, size_t shard_count,
+                       HashPolicy policy, unsigned long long seed = 0)
+        {this->init(table_size, shard_count, FNV, policy, seed);}
+    // Shards hold mutexes, which can't be copied.
+    sharded_hash_table(const sharded_hash_table<K, V>& other) = delete;
+    // Destructor deallocates all shards. O(N+S+T) | O(1)
+    ~sharded_hash_table();
+
+    // Shards hold mutexes, which can't be copied.
+    sharded_hash_table<K, V>& operator = (
+        const sharded_hash_table<K, V>& other) = delete;
+    // Returns a copy of key's value. O(1) average, O(N) worst | O(1)
+    V operator [] (const K& key) const;
+    // Copies key's value to val and returns true if key is in the table.
+    // O(1) average, O(N) worst | O(1)
+    bool find(const K& key, V& val) const;
+    // Returns true if key is in the table. O(1) average, O(N) worst | O(1)
+    bool contains(const K& key) const;
+    // Returns the full hash value of key used to place it in the table.
+    // O(1) for fundamental types, O(L) for containers | O(1)
+    unsigned long long hash_code(const K& key) const {return this->hash(key);}
+    // Returns the number of shards, which is fixed. O(1) | O(1)
+    size_t shards() const {return this->shard_count_;}
+    // Returns the number of key-value pairs in all shards. O(S) | O(1)
+    size_t count() const;
+    // Deletes all entries in all shards. O(N+S+T) | O(1)
+    sharded_hash_table<K, V>& clear();
+
+    // Inserts a key-value pair to the table. O(1) average, O(N) worst | O(1)
+    sharded_hash_table<K, V>& insert(const K& key, const V& val);
+    // Deletes the entry with the given key. O(1) average, O(N) worst | O(1)
+    sharded_hash_table<K, V>& remove(const K& key);
+    // Returns copies of all the keys in the table. O(N+S+T) | O(N)
+    dyn_array<K> keys() const;
+    // Returns copies of all the values in the table. O(N+S+T) | O(N)
+    dyn_array<V> vals() const;
+
+  private:
+    // Largest prime below 2^64 (2^32 on 32-bit platforms), used as modulus
+    // for full-range hash values.
+    static const size_t wide = sizeof(size_t) >= 8
+        ? static_cast<size_t>(18446744073709551557ULL) : 4294967291UL;
+
+    // Independently locked hash table, aligned to a cache line of its own so
+    // that threads locking neighboring shards don't share one.
+    struct alignas(64) shard
+    {
+      std::mutex lock_;
+      hash_table<K, V>* table_;
+    };
+
+    // Allocates shards sharing the given hash function. O(S+T) | O(S+T)
+    void init(size_t table_size, size_t shard_count, PtrHashType ptr_h,
+              HashPolicy policy, unsigned long long seed);
+    // Hash function is run through the hash_fn class.
+    // O(1) for fundamental types, O(L) for containers | O(1)
+    unsigned long long hash(const K& key) const {return this->hash_.run(key);}
+    // Maps a hash value to its shard. O(1) | O(1)
+    shard& shard_of(unsigned long long h) const;
+
+    // Number of shards, always a power of two.
+    size_t shard_count_;
+    // Hashing function used to build full-range hash values.
+    hash_fn<K> hash_;
+    // Array of shards, placed at the first cache line boundary of block_.
+    shard* shards_;
+    // Memory holding the shards. Aligned by hand, since new only honors
+    // alignments up to that of std::max_align_t before C++17.
+    char* block_;
+};
+
+// Templated class method implementations need to be accessible at the
+// point of instantiation.
+#include "sharded_hash_table.tpp"
+
+#endif
@@ -0,0 +1,159 @@
+// The header is included primarily to get rid of IntelliSense squigglies.
+// The class should build and run properly without it. Header guard protection
+// prevents the apparent circular inclusion from causing any problems.
+#include "sharded_hash_table.h"
+
+//======================================================================//
+//                                                                      //
+//                  sharded_hash_table<K, V> methods                    //
+//                                                                      //
+//======================================================================//
+
+template <class K, class V>
+sharded_hash_table<K, V>::~sharded_hash_table()
+{
+  for (size_t i = 0; i < this->shard_count_; ++i) {
+    delete this->shards_[i].table_;
+    this->shards_[i].~shard();
+  }
+  delete[] this->block_;
+}
+
+template <class K, class V>
+V sharded_hash_table<K, V>::operator [] (const K& key) const
+{
+  V val = V();
+  if (!this->find(key, val))
+    std::cerr << "ERROR! Key not found: " << key << std::endl;
+  return val;
+}
+
+template <class K, class V>
+bool sharded_hash_table<K, V>::find(const K& key, V& val) const
+{
+  unsigned long long h = this->hash(key);
+  shard& s = this->shard_of(h);
+  std::lock_guard<std::mutex> guard(s.lock_);
+  s.table_->migrate(s.table_->step_);
+  typename hash_table<K, V>::hash_list* entry = s.table_->find(key, h);
+  if (!entry)
+    return false;
+  val = entry->val().val_;
+  return true;
+}
+
+template <class K, class V>
+bool sharded_hash_table<K, V>::contains(const K& key) const
+{
+  unsigned long long h = this->hash(key);
+  shard& s = this->shard_of(h);
+  std::lock_guard<std::mutex> guard(s.lock_);
+  return s.table_->contains(key, h);
+}
+
+template <class K, class V>
+size_t sharded_hash_table<K, V>::count() const
+{
+  size_t total = 0;
+  for (size_t i = 0; i < this->shard_count_; ++i) {
+    std::lock_guard<std::mutex> guard(this->shards_[i].lock_);
+    total += this->shards_[i].table_->count();
+  }
+  return total;
+}
+
+template <class K, class V>
+sharded_hash_table<K, V>& sharded_hash_table<K, V>::clear()
+{
+  for (size_t i = 0; i < this->shard_count_; ++i) {
+    std::lock_guard<std::mutex> guard(this->shards_[i].lock_);
+    this->shards_[i].table_->clear();
+  }
+  return *this;
+}
+
+template <class K, class V>
+sharded_hash_table<K, V>& sharded_hash_table<K, V>::insert(const K& key,
+                                                           const V& val)
+{
+  unsigned long long h = this->hash(key);
+  shard& s = this->shard_of(h);
+  std::lock_guard<std::mutex> guard(s.lock_);
+  s.table_->insert(key, val, h);
+  return *this;
+}
+
+template <class K, class V>
+sharded_hash_table<K, V>& sharded_hash_table<K, V>::remove(const K& key)
+{
+  unsigned long long h = this->hash(key);
+  shard& s = this->shard_of(h);
+  std::lock_guard<std::mutex> guard(s.lock_);
+  s.table_->remove(key, h);
+  return *this;
+}
+
+template <class K, class V>
+dyn_array<K> sharded_hash_table<K, V>::keys() const
+{
+  dyn_array<K> all_keys;
+  for (size_t i = 0; i < this->shard_count_; ++i) {
+    std::lock_guard<std::mutex> guard(this->shards_[i].lock_);
+    dyn_array<K*> shard_keys = this->shards_[i].table_->keys();
+    for (size_t j = 0; j < shard_keys.size(); ++j)
+      all_keys.add(*shard_keys[j]);
+  }
+  return all_keys;
+}
+
+template <class K, class V>
+dyn_array<V> sharded_hash_table<K, V>::vals() const
+{
+  dyn_array<V> all_vals;
+  for (size_t i = 0; i < this->shard_count_; ++i) {
+    std::lock_guard<std::mutex> guard(this->shards_[i].lock_);
+    dyn_array<V*> shard_vals = this->shards_[i].table_->vals();
+    for (size_t j = 0; j < shard_vals.size(); ++j)
+      all_vals.add(*shard_vals[j]);
+  }
+  return all_vals;
+}
+
+template <class K, class V>
+void sharded_hash_table<K, V>::init(size_t table_size, size_t shard_count,
+                                    PtrHashType ptr_h, HashPolicy policy,
+                                    unsigned long long seed)
+{
+  // Round shard count up to a power of two.
+  this->shard_count_ = 1;
+  while (this->shard_count_ < shard_count)
+    this->shard_count_ <<= 1;
+  this->hash_ = hash_fn<K>(sharded_hash_table::wide, ptr_h, policy, seed);
+  this->block_ = new char[this->shard_count_ * sizeof(shard) + alignof(shard)];
+  std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(this->block_);
+  addr = (addr + alignof(shard) - 1) & ~std::uintptr_t(alignof(shard) - 1);
+  this->shards_ = reinterpret_cast<shard*>(addr);
+  for (size_t i = 0; i < this->shard_count_; ++i)
+    new (this->shards_ + i) shard();
+  // Shards are built with the same hash function, so they accept the hash
+  // values computed here.
+  size_t shard_size = table_size / this->shard_count_;
+  shard_size = shard_size > 11 ? shard_size : 11;
+  for (size_t i = 0; i < this->shard_count_; ++i) {
+    if (policy == WIDE)
+      this->shards_[i].table_ = new hash_table<K, V>(shard_size, WIDE, seed);
+    else
+      this->shards_[i].table_ = new hash_table<K, V>(shard_size, ptr_h);
+  }
+}
+
+template <class K, class V>
+typename sharded_hash_table<K, V>::shard&
+sharded_hash_table<K, V>::shard_of(unsigned long long h) const
+{
+  // Multiply by 2^64 divided by the golden ratio and take the index from the
+  // upper half of the product, which every bit of the hash value affects.
+  const unsigned long long fib = 11400714819323198485ULL;
+  size_t i = static_cast<size_t>((h * fib) >> 32) & (this->shard_count_ - 1);
+  return this->shards_[i];
+}
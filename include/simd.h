@@ -0,0 +1,552 @@
+#ifndef simd_h_
+#define simd_h_
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+// Vector kernels are only built for x86-64, where SSE2 is always available
+// and AVX2 is detected at runtime. Defining CPPDATA_NO_SIMD before including
+// any cppdata header forces the scalar fallbacks on every platform.
+#if !defined(CPPDATA_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#define CPPDATA_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CPPDATA_AVX2
+#else
+#define CPPDATA_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// SIMD kernels for linear scans over raw arrays of arithmetic values, used by
+// dyn_array<T> for its search, min, max, equality and unique methods.
+// Each kernel compares a whole vector of elements per instruction instead of
+// one element per call to a comparison helper, which keeps long scans bound
+// by memory bandwidth rather than by branches.
+//
+// Kernels exist for float, double and 32-bit and 64-bit integers. All other
+// types, and all platforms other than x86-64, run equivalent scalar loops.
+// The instruction set is picked at runtime: AVX2 kernels, compiled with a
+// target attribute instead of a global compiler flag, run if the CPU and OS
+// support them, SSE2 kernels run otherwise. limit() caps this choice so that
+// tests and benchmarks can run the narrower kernels on any machine.
+//
+// Results match the scalar loops they replace, with two exceptions for
+// floating-point minimums and maximums: When an array holds both 0.0 and
+// -0.0 as its extreme value, either one may be returned, and arrays holding
+// NaN values fall back to the scalar loop, since NaN can't be ordered.
+namespace simd {
+
+  // Instruction sets in increasing order of vector width.
+  enum Level {SCALAR, SSE2, AVX2};
+
+  // Element kinds that have vector kernels.
+  enum Kind {NONE, F32, F64, I32, U32, I64, U64};
+
+  // Maps an element type to its kind, NONE for types without kernels.
+  template <class T, class U = typename std::remove_cv<T>::type>
+  struct kind : std::integral_constant<int,
+      std::is_same<U, float>::value ? F32 :
+      std::is_same<U, double>::value ? F64 :
+      !std::is_integral<U>::value || std::is_same<U, bool>::value ? NONE :
+      sizeof(U) == 4 ? (std::is_signed<U>::value ? I32 : U32) :
+      sizeof(U) == 8 ? (std::is_signed<U>::value ? I64 : U64) : NONE> {};
+
+  // True for element types that have vector kernels.
+  template <class T>
+  struct supported : std::integral_constant<bool, kind<T>::value != NONE> {};
+
+  // Returns the widest instruction set the CPU and OS support.
+  inline Level detect()
+  {
+#ifdef CPPDATA_SIMD_X86
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+      return SSE2;
+    __cpuid(info, 1);
+    // AVX registers must be enabled by the OS, which XGETBV reports.
+    bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+                  (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return os_avx && (info[1] & (1 << 5)) ? AVX2 : SSE2;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? AVX2 : SSE2;
+#endif
+#else
+    return SCALAR;
+#endif
+  }
+
+  namespace detail {
+    // Instruction set the kernels dispatch to, detected on first use.
+    inline Level& active()
+    {
+      static Level lvl = detect();
+      return lvl;
+    }
+  }
+
+  // Returns the instruction set the kernels currently dispatch to.
+  inline Level level() {return detail::active();}
+
+  // Caps the instruction set at lvl, or at the widest one supported, and
+  // returns the one now in effect. Not thread-safe, and meant for tests and
+  // benchmarks only.
+  inline Level limit(Level lvl)
+  {
+    Level best = detect();
+    detail::active() = lvl < best ? lvl : best;
+    return detail::active();
+  }
+
+  namespace detail {
+    template <int K>
+    using kind_tag = std::integral_constant<int, K>;
+
+    // Scalar loops, used for types without kernels and for array tails.
+    template <class T>
+    size_t find(const T* a, size_t n, const T& v)
+    {
+      for (size_t i = 0; i < n; ++i)
+        if (a[i] == v)
+          return i;
+      return n;
+    }
+
+    template <class T>
+    bool equal(const T* a, const T* b, size_t n)
+    {
+      for (size_t i = 0; i < n; ++i)
+        if (!(a[i] == b[i]))
+          return false;
+      return true;
+    }
+
+    // Keeps the first of equal extremes, the same way dyn_array compares.
+    template <class T>
+    T extreme(const T* a, size_t n, bool inc)
+    {
+      const T* best = a;
+      for (size_t i = 1; i < n; ++i)
+        if (!(*best == a[i]) && !(inc ? *best < a[i] : *best > a[i]))
+          best = a + i;
+      return *best;
+    }
+
+#ifdef CPPDATA_SIMD_X86
+    // Index of the lowest set bit of a non-zero mask.
+    inline unsigned first_bit(unsigned m)
+    {
+#ifdef _MSC_VER
+      unsigned long i;
+      _BitScanForward(&i, m);
+      return static_cast<unsigned>(i);
+#else
+      return static_cast<unsigned>(__builtin_ctz(m));
+#endif
+    }
+
+    // Vector operations per instruction set and element kind. eq returns a
+    // mask with one bit per element, pick returns the lane-wise minimum for
+    // inc=true and the lane-wise maximum otherwise, and nan flags lanes that
+    // are unordered.
+    struct sse2_f32
+    {
+      typedef __m128 vec;
+      static const size_t width = 4;
+      static const bool floating = true;
+      static vec splat(float v) {return _mm_set1_ps(v);}
+      static vec load(const void* p)
+          {return _mm_loadu_ps(static_cast<const float*>(p));}
+      static void store(void* p, vec v)
+          {_mm_storeu_ps(static_cast<float*>(p), v);}
+      static unsigned eq(vec a, vec b)
+          {return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(a, b)));}
+      static vec pick(vec a, vec b, bool inc)
+          {return inc ? _mm_min_ps(a, b) : _mm_max_ps(a, b);}
+      static vec none() {return _mm_setzero_ps();}
+      static vec nan(vec acc, vec a)
+          {return _mm_or_ps(acc, _mm_cmpunord_ps(a, a));}
+      static bool any(vec a) {return _mm_movemask_ps(a) != 0;}
+    };
+
+    struct sse2_f64
+    {
+      typedef __m128d vec;
+      static const size_t width = 2;
+      static const bool floating = true;
+      static vec splat(double v) {return _mm_set1_pd(v);}
+      static vec load(const void* p)
+          {return _mm_loadu_pd(static_cast<const double*>(p));}
+      static void store(void* p, vec v)
+          {_mm_storeu_pd(static_cast<double*>(p), v);}
+      static unsigned eq(vec a, vec b)
+          {return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(a, b)));}
+      static vec pick(vec a, vec b, bool inc)
+          {return inc ? _mm_min_pd(a, b) : _mm_max_pd(a, b);}
+      static vec none() {return _mm_setzero_pd();}
+      static vec nan(vec acc, vec a)
+          {return _mm_or_pd(acc, _mm_cmpunord_pd(a, a));}
+      static bool any(vec a) {return _mm_movemask_pd(a) != 0;}
+    };
+
+    // SSE2 has no 32-bit minimum or maximum, so they are built from signed
+    // comparisons. Unsigned values have their sign bits flipped first.
+    template <bool Signed>
+    struct sse2_i32
+    {
+      typedef __m128i vec;
+      static const size_t width = 4;
+      static const bool floating = false;
+      static vec splat(long long v)
+          {return _mm_set1_epi32(static_cast<int>(v));}
+      static vec load(const void* p)
+          {return _mm_loadu_si128(static_cast<const __m128i*>(p));}
+      static void store(void* p, vec v)
+          {_mm_storeu_si128(static_cast<__m128i*>(p), v);}
+      static unsigned eq(vec a, vec b)
+      {
+        __m128 m = _mm_castsi128_ps(_mm_cmpeq_epi32(a, b));
+        return static_cast<unsigned>(_mm_movemask_ps(m));
+      }
+      static vec pick(vec a, vec b, bool inc)
+      {
+        vec bias = _mm_set1_epi32(Signed ? 0 : static_cast<int>(0x80000000u));
+        vec gt = _mm_cmpgt_epi32(_mm_xor_si128(a, bias),
+                                 _mm_xor_si128(b, bias));
+        vec lo = _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+        vec hi = _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+        return inc ? lo : hi;
+      }
+      static vec none() {return _mm_setzero_si128();}
+      static vec nan(vec acc, vec) {return acc;}
+      static bool any(vec) {return false;}
+    };
+
+    // SSE2 only compares 64-bit integers for equality, as pairs of 32-bit
+    // halves that must both match.
+    struct sse2_i64
+    {
+      typedef __m128i vec;
+      static const size_t width = 2;
+      static vec splat(long long v) {return _mm_set1_epi64x(v);}
+      static vec load(const void* p)
+          {return _mm_loadu_si128(static_cast<const __m128i*>(p));}
+      static unsigned eq(vec a, vec b)
+      {
+        __m128 m = _mm_castsi128_ps(_mm_cmpeq_epi32(a, b));
+        unsigned halves = static_cast<unsigned>(_mm_movemask_ps(m));
+        return ((halves & 3) == 3) | (((halves >> 2) & 3) == 3) << 1;
+      }
+    };
+
+    struct avx2_f32
+    {
+      typedef __m256 vec;
+      static const size_t width = 8;
+      static const bool floating = true;
+      CPPDATA_AVX2 static vec splat(float v) {return _mm256_set1_ps(v);}
+      CPPDATA_AVX2 static vec load(const void* p)
+          {return _mm256_loadu_ps(static_cast<const float*>(p));}
+      CPPDATA_AVX2 static void store(void* p, vec v)
+          {_mm256_storeu_ps(static_cast<float*>(p), v);}
+      CPPDATA_AVX2 static unsigned eq(vec a, vec b)
+      {
+        __m256 m = _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+        return static_cast<unsigned>(_mm256_movemask_ps(m));
+      }
+      CPPDATA_AVX2 static vec pick(vec a, vec b, bool inc)
+          {return inc ? _mm256_min_ps(a, b) : _mm256_max_ps(a, b);}
+      CPPDATA_AVX2 static vec none() {return _mm256_setzero_ps();}
+      CPPDATA_AVX2 static vec nan(vec acc, vec a)
+          {return _mm256_or_ps(acc, _mm256_cmp_ps(a, a, _CMP_UNORD_Q));}
+      CPPDATA_AVX2 static bool any(vec a) {return _mm256_movemask_ps(a) != 0;}
+    };
+
+    struct avx2_f64
+    {
+      typedef __m256d vec;
+      static const size_t width = 4;
+      static const bool floating = true;
+      CPPDATA_AVX2 static vec splat(double v) {return _mm256_set1_pd(v);}
+      CPPDATA_AVX2 static vec load(const void* p)
+          {return _mm256_loadu_pd(static_cast<const double*>(p));}
+      CPPDATA_AVX2 static void store(void* p, vec v)
+          {_mm256_storeu_pd(static_cast<double*>(p), v);}
+      CPPDATA_AVX2 static unsigned eq(vec a, vec b)
+      {
+        __m256d m = _mm256_cmp_pd(a, b, _CMP_EQ_OQ);
+        return static_cast<unsigned>(_mm256_movemask_pd(m));
+      }
+      CPPDATA_AVX2 static vec pick(vec a, vec b, bool inc)
+          {return inc ? _mm256_min_pd(a, b) : _mm256_max_pd(a, b);}
+      CPPDATA_AVX2 static vec none() {return _mm256_setzero_pd();}
+      CPPDATA_AVX2 static vec nan(vec acc, vec a)
+          {return _mm256_or_pd(acc, _mm256_cmp_pd(a, a, _CMP_UNORD_Q));}
+      CPPDATA_AVX2 static bool any(vec a) {return _mm256_movemask_pd(a) != 0;}
+    };
+
+    template <int K>
+    struct avx2_int
+    {
+      typedef __m256i vec;
+      static const bool wide = K == I64 || K == U64;
+      static const size_t width = wide ? 4 : 8;
+      static const bool floating = false;
+      CPPDATA_AVX2 static vec splat(long long v)
+          {return wide ? _mm256_set1_epi64x(v)
+                       : _mm256_set1_epi32(static_cast<int>(v));}
+      CPPDATA_AVX2 static vec load(const void* p)
+          {return _mm256_loadu_si256(static_cast<const __m256i*>(p));}
+      CPPDATA_AVX2 static void store(void* p, vec v)
+          {_mm256_storeu_si256(static_cast<__m256i*>(p), v);}
+      CPPDATA_AVX2 static unsigned eq(vec a, vec b)
+      {
+        if (wide)
+          return static_cast<unsigned>(_mm256_movemask_pd(
+              _mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b))));
+        return static_cast<unsigned>(_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))));
+      }
+      CPPDATA_AVX2 static vec pick(vec a, vec b, bool inc)
+      {
+        if (K == I32)
+          return inc ? _mm256_min_epi32(a, b) : _mm256_max_epi32(a, b);
+        if (K == U32)
+          return inc ? _mm256_min_epu32(a, b) : _mm256_max_epu32(a, b);
+        // 64-bit lanes only have a signed greater-than comparison.
+        long long sign = -0x7fffffffffffffffLL - 1;
+        vec bias = _mm256_set1_epi64x(K == I64 ? 0 : sign);
+        vec gt = _mm256_cmpgt_epi64(_mm256_xor_si256(a, bias),
+                                    _mm256_xor_si256(b, bias));
+        return inc ? _mm256_blendv_epi8(a, b, gt)
+                   : _mm256_blendv_epi8(b, a, gt);
+      }
+      CPPDATA_AVX2 static vec none() {return _mm256_setzero_si256();}
+      CPPDATA_AVX2 static vec nan(vec acc, vec) {return acc;}
+      CPPDATA_AVX2 static bool any(vec) {return false;}
+    };
+
+    // Kernels are written out once per instruction set, since functions
+    // built for AVX2 can't be inlined into functions built for SSE2.
+    template <class Ops, class T>
+    size_t find_sse2(const T* a, size_t n, const T& v)
+    {
+      typename Ops::vec key = Ops::splat(v);
+      size_t i = 0;
+      for (; i + Ops::width <= n; i += Ops::width) {
+        unsigned m = Ops::eq(Ops::load(a + i), key);
+        if (m)
+          return i + first_bit(m);
+      }
+      return i + detail::find(a + i, n - i, v);
+    }
+
+    template <class Ops, class T>
+    CPPDATA_AVX2 size_t find_avx2(const T* a, size_t n, const T& v)
+    {
+      typename Ops::vec key = Ops::splat(v);
+      size_t i = 0;
+      for (; i + Ops::width <= n; i += Ops::width) {
+        unsigned m = Ops::eq(Ops::load(a + i), key);
+        if (m)
+          return i + first_bit(m);
+      }
+      return i + detail::find(a + i, n - i, v);
+    }
+
+    template <class Ops, class T>
+    bool equal_sse2(const T* a, const T* b, size_t n)
+    {
+      const unsigned all = (1u << Ops::width) - 1;
+      size_t i = 0;
+      for (; i + Ops::width <= n; i += Ops::width)
+        if (Ops::eq(Ops::load(a + i), Ops::load(b + i)) != all)
+          return false;
+      return detail::equal(a + i, b + i, n - i);
+    }
+
+    template <class Ops, class T>
+    CPPDATA_AVX2 bool equal_avx2(const T* a, const T* b, size_t n)
+    {
+      const unsigned all = (1u << Ops::width) - 1;
+      size_t i = 0;
+      for (; i + Ops::width <= n; i += Ops::width)
+        if (Ops::eq(Ops::load(a + i), Ops::load(b + i)) != all)
+          return false;
+      return detail::equal(a + i, b + i, n - i);
+    }
+
+    // Reduces two vectors of running extremes, which hides the latency of
+    // the min and max instructions. Returns false if a NaN turns up.
+    template <class Ops, class T>
+    bool extreme_sse2(const T* a, size_t n, bool inc, T& out)
+    {
+      if (n < 2 * Ops::width)
+        return false;
+      typename Ops::vec acc0 = Ops::load(a);
+      typename Ops::vec acc1 = Ops::load(a + Ops::width);
+      typename Ops::vec bad = Ops::nan(Ops::nan(Ops::none(), acc0), acc1);
+      size_t i = 2 * Ops::width;
+      for (; i + 2 * Ops::width <= n; i += 2 * Ops::width) {
+        typename Ops::vec x0 = Ops::load(a + i);
+        typename Ops::vec x1 = Ops::load(a + i + Ops::width);
+        acc0 = Ops::pick(acc0, x0, inc);
+        acc1 = Ops::pick(acc1, x1, inc);
+        if (Ops::floating)
+          bad = Ops::nan(Ops::nan(bad, x0), x1);
+      }
+      if (Ops::any(bad))
+        return false;
+      // Fewer than 2 vectors are left, which join the reduced lanes.
+      T lanes[3 * Ops::width];
+      Ops::store(lanes, Ops::pick(acc0, acc1, inc));
+      size_t k = Ops::width;
+      for (; i < n; ++i) {
+        if (!(a[i] == a[i]))
+          return false;
+        lanes[k++] = a[i];
+      }
+      out = detail::extreme(lanes, k, inc);
+      return true;
+    }
+
+    template <class Ops, class T>
+    CPPDATA_AVX2 bool extreme_avx2(const T* a, size_t n, bool inc, T& out)
+    {
+      if (n < 2 * Ops::width)
+        return false;
+      typename Ops::vec acc0 = Ops::load(a);
+      typename Ops::vec acc1 = Ops::load(a + Ops::width);
+      typename Ops::vec bad = Ops::nan(Ops::nan(Ops::none(), acc0), acc1);
+      size_t i = 2 * Ops::width;
+      for (; i + 2 * Ops::width <= n; i += 2 * Ops::width) {
+        typename Ops::vec x0 = Ops::load(a + i);
+        typename Ops::vec x1 = Ops::load(a + i + Ops::width);
+        acc0 = Ops::pick(acc0, x0, inc);
+        acc1 = Ops::pick(acc1, x1, inc);
+        if (Ops::floating)
+          bad = Ops::nan(Ops::nan(bad, x0), x1);
+      }
+      if (Ops::any(bad))
+        return false;
+      // Fewer than 2 vectors are left, which join the reduced lanes.
+      T lanes[3 * Ops::width];
+      Ops::store(lanes, Ops::pick(acc0, acc1, inc));
+      size_t k = Ops::width;
+      for (; i < n; ++i) {
+        if (!(a[i] == a[i]))
+          return false;
+        lanes[k++] = a[i];
+      }
+      out = detail::extreme(lanes, k, inc);
+      return true;
+    }
+
+    // Vector operations for each element kind.
+    template <int K>
+    struct ops
+    {
+      typedef typename std::conditional<K == F32, sse2_f32,
+              typename std::conditional<K == F64, sse2_f64,
+              typename std::conditional<K == I64 || K == U64, sse2_i64,
+              sse2_i32<K == I32> >::type>::type>::type sse2;
+      typedef typename std::conditional<K == F32, avx2_f32,
+              typename std::conditional<K == F64, avx2_f64,
+              avx2_int<K> >::type>::type avx2;
+    };
+
+    // SSE2 has no 64-bit comparisons to find extremes with.
+    template <int K, class T>
+    bool extreme_sse2(const T* a, size_t n, bool inc, T& out, std::true_type)
+        {return extreme_sse2<typename ops<K>::sse2>(a, n, inc, out);}
+    template <int K, class T>
+    bool extreme_sse2(const T*, size_t, bool, T&, std::false_type)
+        {return false;}
+#endif
+
+    // Dispatch on element kind and instruction set.
+    template <class T>
+    size_t find(const T* a, size_t n, const T& v, kind_tag<NONE>)
+        {return detail::find(a, n, v);}
+    template <class T, int K>
+    size_t find(const T* a, size_t n, const T& v, kind_tag<K>)
+    {
+#ifdef CPPDATA_SIMD_X86
+      if (level() == AVX2)
+        return find_avx2<typename ops<K>::avx2>(a, n, v);
+      if (level() == SSE2)
+        return find_sse2<typename ops<K>::sse2>(a, n, v);
+#endif
+      return detail::find(a, n, v);
+    }
+
+    // Integers are equal if and only if their bytes are, which memcmp checks
+    // with the widest instructions the C library has.
+    template <class T, int K>
+    bool equal(const T* a, const T* b, size_t n, kind_tag<K>)
+        {return n == 0 || std::memcmp(a, b, n * sizeof(T)) == 0;}
+    template <class T>
+    bool equal(const T* a, const T* b, size_t n, kind_tag<NONE>)
+        {return detail::equal(a, b, n);}
+    template <class T, int K>
+    bool equal_fp(const T* a, const T* b, size_t n)
+    {
+#ifdef CPPDATA_SIMD_X86
+      if (level() == AVX2)
+        return equal_avx2<typename ops<K>::avx2>(a, b, n);
+      if (level() == SSE2)
+        return equal_sse2<typename ops<K>::sse2>(a, b, n);
+#endif
+      return detail::equal(a, b, n);
+    }
+    template <class T>
+    bool equal(const T* a, const T* b, size_t n, kind_tag<F32>)
+        {return equal_fp<T, F32>(a, b, n);}
+    template <class T>
+    bool equal(const T* a, const T* b, size_t n, kind_tag<F64>)
+        {return equal_fp<T, F64>(a, b, n);}
+
+    template <class T>
+    T extreme(const T* a, size_t n, bool inc, kind_tag<NONE>)
+        {return detail::extreme(a, n, inc);}
+    template <class T, int K>
+    T extreme(const T* a, size_t n, bool inc, kind_tag<K>)
+    {
+#ifdef CPPDATA_SIMD_X86
+      T out;
+      if (level() == AVX2 &&
+          extreme_avx2<typename ops<K>::avx2>(a, n, inc, out))
+        return out;
+      if (level() == SSE2 &&
+          extreme_sse2<K>(a, n, inc, out,
+                          std::integral_constant<bool, K != I64 && K != U64>()))
+        return out;
+#endif
+      return detail::extreme(a, n, inc);
+    }
+  }
+
+  // Returns the index of the first element of a that equals v, or n if
+  // there is none. O(N) | O(1)
+  template <class T>
+  size_t find(const T* a, size_t n, const T& v)
+      {return detail::find(a, n, v, detail::kind_tag<kind<T>::value>());}
+
+  // Returns true if the first n elements of a and b are equal. O(N) | O(1)
+  template <class T>
+  bool equal(const T* a, const T* b, size_t n)
+      {return detail::equal(a, b, n, detail::kind_tag<kind<T>::value>());}
+
+  // Returns a copy of the minimum element of a for inc=true, or of the
+  // maximum element otherwise. Expects n > 0. O(N) | O(1)
+  template <class T>
+  T extreme(const T* a, size_t n, bool inc)
+      {return detail::extreme(a, n, inc, detail::kind_tag<kind<T>::value>());}
+}
+
+#endif
@@ -7,6 +7,8 @@
 #include "dyn_array.h"
 #include "linked_list.h"
 
+template <class K> class hash_fn;
+
 // General-purpose stack that runs a node<T, false> chain under the hood and is
 // mostly a thin wrapper around it that exposes a clean stack interface.
 // Provides O(1) access to last inserted value. Observes the rule of 3.
@@ -16,6 +18,9 @@
 template <class T>
 class stack
 {
+  // Allows hash_fn to digest the underlying list for structural hashing.
+  friend class hash_fn<stack<T> >;
+
   public:
     // Default constructor creates an empty stack. O(1) | O(1)
     stack(): list_(nullptr), size_(0) {}
@@ -0,0 +1,85 @@
+#ifndef thread_pool_h_
+#define thread_pool_h_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads for data-parallel loops. Runs one batch
+// of tasks at a time: run(tasks, body) calls body(0) through body(tasks - 1)
+// on the workers and the calling thread, which takes tasks like any worker,
+// and returns once every task has finished. Tasks are handed out through a
+// single atomic counter, so there are no per-task allocations or queues.
+//
+// A pool of size P keeps P - 1 workers asleep on a condition variable between
+// batches, since the calling thread is the P-th. Batches submitted by
+// different threads run one after the other. Calling run from inside a task
+// runs the nested batch serially on that thread instead of deadlocking.
+//
+// Parallel algorithms split their input into about as many tasks as the pool
+// has threads and synchronize in between batches, in bulk-synchronous style.
+// Use thread_pool::shared() for a process-wide pool that is sized to the
+// hardware, or construct a dedicated one to cap the number of threads.
+class thread_pool
+{
+  public:
+    // Starts threads - 1 workers, or hardware_concurrency() - 1 if threads
+    // is 0. O(P) | O(P)
+    explicit thread_pool(size_t threads = 0);
+    // Workers hold references to the pool, which can't be copied.
+    thread_pool(const thread_pool& other) = delete;
+    // Wakes up and joins all workers. O(P) | O(1)
+    ~thread_pool();
+
+    // Workers hold references to the pool, which can't be copied.
+    thread_pool& operator = (const thread_pool& other) = delete;
+    // Returns the number of threads, including the calling thread. O(1) | O(1)
+    size_t size() const {return this->workers_.size() + 1;}
+    // Runs body(i) for all i in [0, tasks) and waits for all of them to
+    // finish. O(T/P) per thread | O(1)
+    void run(size_t tasks, const std::function<void(size_t)>& body);
+
+    // Process-wide pool with one thread per hardware thread, started on first
+    // use. O(P) first call, O(1) afterwards | O(P)
+    static thread_pool& shared();
+
+  private:
+    // Loop run by each worker until the pool is destroyed.
+    void work();
+    // Takes and runs tasks of the current batch until none are left.
+    void drain(const std::function<void(size_t)>& body, size_t tasks);
+    // True on threads that are running a task, to detect nested batches.
+    static bool& in_task();
+
+    // Worker threads, excluding the thread that calls run.
+    std::vector<std::thread> workers_;
+    // Serializes batches submitted from different threads.
+    std::mutex run_lock_;
+    // Guards the batch description and the counters below.
+    std::mutex lock_;
+    // Signals workers that a new batch started or that the pool is stopping.
+    std::condition_variable wake_;
+    // Signals the calling thread that the last busy worker is done.
+    std::condition_variable done_;
+    // Current batch body, nullptr between batches.
+    const std::function<void(size_t)>* body_;
+    // Number of tasks in the current batch.
+    size_t tasks_;
+    // Index of the next task to hand out.
+    std::atomic<size_t> next_;
+    // Incremented for every batch, so workers run each batch once.
+    size_t batch_;
+    // Number of workers that are taking tasks of the current batch.
+    size_t busy_;
+    // Set when the pool is being destroyed.
+    bool stop_;
+};
+
+// Class method implementations are included for consistency with the
+// templated classes.
+#include "thread_pool.tpp"
+
+#endif
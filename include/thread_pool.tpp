@@ -0,0 +1,104 @@
+// The header is included primarily to get rid of IntelliSense squigglies.
+// The class should build and run properly without it. Header guard protection
+// prevents the apparent circular inclusion from causing any problems.
+#include "thread_pool.h"
+
+//======================================================================//
+//                                                                      //
+//                         thread_pool methods                          //
+//                                                                      //
+//======================================================================//
+
+inline thread_pool::thread_pool(size_t threads)
+  : body_(nullptr), tasks_(0), next_(0), batch_(0), busy_(0), stop_(false)
+{
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  // hardware_concurrency returns 0 if it can't tell, which leaves the calling
+  // thread to run all tasks.
+  for (size_t i = 1; i < threads; ++i)
+    this->workers_.push_back(std::thread(&thread_pool::work, this));
+}
+
+inline thread_pool::~thread_pool()
+{
+  {
+    std::lock_guard<std::mutex> guard(this->lock_);
+    this->stop_ = true;
+  }
+  this->wake_.notify_all();
+  for (size_t i = 0; i < this->workers_.size(); ++i)
+    this->workers_[i].join();
+}
+
+inline void thread_pool::run(size_t tasks,
+                             const std::function<void(size_t)>& body)
+{
+  // Run small and nested batches right here.
+  if (tasks < 2 || this->workers_.empty() || thread_pool::in_task()) {
+    for (size_t i = 0; i < tasks; ++i)
+      body(i);
+    return;
+  }
+  std::lock_guard<std::mutex> batch_guard(this->run_lock_);
+  {
+    std::lock_guard<std::mutex> guard(this->lock_);
+    this->body_ = &body;
+    this->tasks_ = tasks;
+    this->next_.store(0);
+    this->batch_++;
+  }
+  this->wake_.notify_all();
+  this->drain(body, tasks);
+  // All tasks are handed out, wait for the workers still running theirs.
+  // Workers that wake up after this see no body and go back to sleep.
+  std::unique_lock<std::mutex> lock(this->lock_);
+  this->done_.wait(lock, [this]() {return this->busy_ == 0;});
+  this->body_ = nullptr;
+}
+
+inline thread_pool& thread_pool::shared()
+{
+  static thread_pool pool;
+  return pool;
+}
+
+inline void thread_pool::work()
+{
+  size_t seen = 0;
+  std::unique_lock<std::mutex> lock(this->lock_);
+  while (true) {
+    this->wake_.wait(lock, [this, &seen]() {
+      return this->stop_ || this->batch_ != seen;
+    });
+    if (this->stop_)
+      return;
+    seen = this->batch_;
+    if (!this->body_)
+      continue;
+    const std::function<void(size_t)>* body = this->body_;
+    size_t tasks = this->tasks_;
+    this->busy_++;
+    lock.unlock();
+    this->drain(*body, tasks);
+    lock.lock();
+    if (--this->busy_ == 0)
+      this->done_.notify_one();
+  }
+}
+
+inline void thread_pool::drain(const std::function<void(size_t)>& body,
+                               size_t tasks)
+{
+  bool& nested = thread_pool::in_task();
+  nested = true;
+  for (size_t i = this->next_++; i < tasks; i = this->next_++)
+    body(i);
+  nested = false;
+}
+
+inline bool& thread_pool::in_task()
+{
+  static thread_local bool flag = false;
+  return flag;
+}
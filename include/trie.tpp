@@ -365,4 +365,35 @@ std::ostream& operator << (std::ostream& os, const trie& tr)
   // Since tries tend to be large, sort using O(1) space.
   os << str_arr.heap_sort();
   return os;
-}
\ No newline at end of file
+}
+
+//======================================================================//
+//                                                                      //
+//                         hash_fn<trie> methods                        //
+//                                                                      //
+//======================================================================//
+
+template<>
+unsigned long long hash_fn<trie>::digest(const trie& key)
+{
+  // Each node contributes the digest of its path from the root. These are
+  // summed, since trie equality ignores the order of children.
+  unsigned long long sum = 0;
+  dyn_array<const graph_node<char>*> nodes;
+  dyn_array<unsigned long long> paths;
+  nodes.add(&key);
+  paths.add(hash_fn<char>::digest(key.val()));
+  while (!nodes.is_empty()) {
+    const graph_node<char>* gn = nodes.remove();
+    unsigned long long path = paths.remove();
+    sum += hash_fn<char>::mix(path);
+    for (size_t n = 0; n < gn->capacity(); ++n) {
+      if ((*gn)[n]) {
+        nodes.add((*gn)[n]);
+        paths.add(hash_fn<char>::combine(path,
+                                         hash_fn<char>::digest((*gn)[n]->val())));
+      }
+    }
+  }
+  return sum;
+}
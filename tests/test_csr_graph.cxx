@@ -0,0 +1,195 @@
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include "csr_graph.h"
+#include "graph.h"
+#include "dyn_array.h"
+#include "test_util.h"
+
+int main()
+{
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "CSR GRAPH CONSTRUCTION TESTS" << std::endl << std::endl;
+
+  bool check;
+  dyn_array<size_t> ind_gt;
+  dyn_array<int> val_gt;
+
+  csr_graph<int> empty;
+  std::cout << "Default-constructed CSR graph:" << std::endl;
+  TEST_CHECK(empty.is_empty(), "Graph should be empty");
+  TEST_EQUAL(empty.num_edges(), 0, "Graph should have no edges");
+  TEST_CHECK(empty.kahn().is_empty(), "Kahn should return nothing");
+  TEST_CHECK(empty.weakly_conn_comp().is_empty(), "No components");
+  std::cout << std::endl;
+
+  // Edges are given out of order, with a parallel edge from 1 to 3.
+  dyn_array<int> node_vals = {10, 20, 30, 40, 50};
+  dyn_array<size_t> from = {3, 0, 1, 0, 1, 2, 1};
+  dyn_array<size_t> to   = {4, 2, 3, 1, 2, 3, 3};
+  dyn_array<int> weights = {7, 2, 5, 4, 1, 3, 6};
+  csr_graph<int> g(node_vals, from, to, weights);
+  std::cout << "Built CSR graph from an unsorted edge list:" << std::endl;
+  TEST_EQUAL(g.size(), 5, "Graph should have 5 nodes");
+  TEST_EQUAL(g.num_edges(), 7, "Graph should keep all 7 edges");
+  TEST_EQUAL(g(2), 30, "Node 2 should have value 30");
+  ind_gt = {0, 2, 5, 6, 7, 7};
+  TEST_SEQ(g.offsets(), ind_gt, 6, "Offsets should count edges per node");
+  ind_gt = {1, 2, 2, 3, 3, 3, 4};
+  TEST_SEQ(g.targets(), ind_gt, 7, "Edges should be sorted by target");
+  val_gt = {4, 2, 1, 5, 6, 3, 7};
+  TEST_SEQ(g.weights(), val_gt, 7, "Parallel edges should keep their order");
+  TEST_EQUAL(g.degree(1), 3, "Node 1 should have 3 outgoing edges");
+  ind_gt = {2, 3, 3};
+  TEST_SEQ(g.neighbors(1), ind_gt, 3, "Node 1 neighbors should match gt");
+  TEST_CHECK(g.neighbors(4).is_empty(), "Node 4 should have no neighbors");
+  check = g.has_edge(0, 2) && g.has_edge(3, 4) && !g.has_edge(2, 1);
+  TEST_CHECK(check, "Edge lookups should follow edge directions");
+  TEST_CHECK(!g.has_edge(0, 9), "Out-of-bounds edges should not exist");
+  val_gt = {0, 4, 2, 5, 12};
+  TEST_SEQ(g.shortest_dists(0), val_gt, 5, "Distances should use min weights");
+  std::cout << std::endl;
+
+  dyn_array<size_t> bad_to = {4, 2, 3, 1, 2, 3, 9};
+  std::cout << "Edge list with an out-of-bounds target:" << std::endl;
+  csr_graph<int> bad(node_vals, from, bad_to);
+  TEST_CHECK(bad.is_empty(), "Invalid edge lists should build empty graphs");
+  std::cout << "Edge list with missing weights:" << std::endl;
+  csr_graph<int> bad_w(node_vals, from, to, dyn_array<int>(1, 3));
+  TEST_CHECK(bad_w.is_empty(), "Weight counts should match edge counts");
+
+  csr_graph<int> unw(node_vals, from, to);
+  std::cout << "Built unweighted CSR graph from the same edges:" << std::endl;
+  TEST_CHECK(unw.weights().is_empty(), "Unweighted graph keeps no weights");
+  TEST_EQUAL(unw.weight(3), 1, "Unweighted edges should weigh 1");
+  val_gt = {0, 1, 1, 2, 3};
+  TEST_SEQ(unw.shortest_dists(0), val_gt, 5, "Distances should count hops");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "CSR GRAPH AGAINST GRAPH<T> TESTS" << std::endl << std::endl;
+
+  // Random sparse graphs built from matrices, whose adjacency lists are in
+  // index order like CSR rows. Directed graphs cover every algorithm, while
+  // symmetric ones cover bridges and articulation points.
+  std::mt19937 gen(42);
+  const size_t n = 120;
+  for (int undir = 0; undir < 2; ++undir) {
+    dyn_array<dyn_array<int> > adj(dyn_array<int>(0, n), n);
+    for (size_t e = 0; e < (undir ? n : 2 * n); ++e) {
+      size_t i = gen() % n, j = gen() % n;
+      int w = 1 + static_cast<int>(gen() % 20);
+      adj[i][j] = w;
+      if (undir)
+        adj[j][i] = w;
+    }
+    dyn_array<int> vals(0, n);
+    for (size_t i = 0; i < n; ++i)
+      vals[i] = static_cast<int>(gen() % 30);
+    graph<int> ref(adj);
+    ref = vals;
+    csr_graph<int> csr(ref);
+    std::cout << (undir ? "Undirected" : "Directed") << " random graph with ";
+    std::cout << ref.num_edges() << " edges:" << std::endl;
+    TEST_EQUAL(csr.num_edges(), ref.num_edges(), "Edge counts should match");
+    TEST_CHECK(csr[csr.neighbors(7)] == ref[ref.neighbors(7)],
+               "Neighbor values should match");
+
+    bool dft_eq = true, bft_eq = true, dfs_eq = true, bfs_eq = true;
+    bool dij_eq = true;
+    for (size_t u = 0; u < n; u += 7) {
+      dft_eq = dft_eq && csr.depth_first_traverse(u) ==
+                         ref.depth_first_traverse(u);
+      bft_eq = bft_eq && csr.breadth_first_traverse(u) ==
+                         ref.breadth_first_traverse(u);
+      dfs_eq = dfs_eq && csr.depth_first_search(u, 13) ==
+                         ref.depth_first_search(u, 13);
+      bfs_eq = bfs_eq && csr.breadth_first_search(u, 13) ==
+                         ref.breadth_first_search(u, 13);
+      dij_eq = dij_eq && csr.dijkstra(u) == ref.dijkstra(u);
+    }
+    TEST_CHECK(dft_eq, "Depth-first traversals should match");
+    TEST_CHECK(bft_eq, "Breadth-first traversals should match");
+    TEST_CHECK(dfs_eq, "Depth-first searches should match");
+    TEST_CHECK(bfs_eq, "Breadth-first searches should match");
+    TEST_CHECK(dij_eq, "Dijkstra paths should match");
+    TEST_CHECK(csr.find_roots() == ref.find_roots(), "Roots should match");
+    TEST_CHECK(csr.kahn() == ref.kahn(), "Kahn orders should match");
+    TEST_CHECK(csr.weakly_conn_comp() == ref.weakly_conn_comp(),
+               "Weakly-connected components should match");
+    TEST_CHECK(csr.strongly_conn_comp() == ref.strongly_conn_comp(),
+               "Strongly-connected components should match");
+    if (undir) {
+      TEST_CHECK(csr.bridges() == ref.bridges(), "Bridges should match");
+      TEST_CHECK(csr.articulation_points() == ref.articulation_points(),
+                 "Articulation points should match");
+    }
+    std::cout << std::endl;
+  }
+
+  graph<char> small = {'a', 'b', 'c', 'd', 'e', 'f'};
+  small.add_edge(0, 5);
+  small.add_edge(1, 5);
+  small.add_edge(2, 3);
+  small.add_edge(3, 0);
+  small.add_edge(3, 1);
+  csr_graph<char> csmall(small);
+  std::ostringstream ref_os, csr_os;
+  small.depth_first_search(2, 'b', &ref_os);
+  csmall.depth_first_search(2, 'b', &csr_os);
+  std::cout << "Depth first search for b from c: " << csr_os.str();
+  std::cout << std::endl;
+  TEST_EQUAL(csr_os.str(), ref_os.str(), "DFS printouts should match");
+  ref_os.str("");
+  csr_os.str("");
+  small.breadth_first_traverse(2, &ref_os);
+  csmall.breadth_first_traverse(2, &csr_os);
+  std::cout << "Breadth first traversal from c: " << csr_os.str();
+  std::cout << std::endl;
+  TEST_EQUAL(csr_os.str(), ref_os.str(), "BFT printouts should match");
+
+  // Edge 0-1 is doubled, so only 1-2 is a bridge and only 1 separates nodes.
+  csr_graph<int> multi(dyn_array<int>(0, 3), {0, 1, 0, 1, 1, 2},
+                       {1, 0, 1, 0, 2, 1});
+  std::cout << "Undirected graph with a doubled edge: ";
+  std::cout << multi.bridges() << std::endl;
+  dyn_array<dyn_array<size_t> > multi_br = multi.bridges();
+  TEST_EQUAL(multi_br.size(), 1, "Parallel edges shouldn't be bridges");
+  TEST_CHECK(multi_br.size() == 1 && multi_br[0] == dyn_array<size_t>({1, 2}),
+             "Single edge should be the only bridge");
+  TEST_CHECK(multi.articulation_points() == dyn_array<size_t>({1}),
+             "Node joining both edges should be an articulation point");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "LARGE CSR GRAPH TESTS" << std::endl << std::endl;
+
+  // A path through a million nodes is far too deep for recursive traversals
+  // and far too large for a dense edge matrix.
+  const size_t big = 1000000;
+  dyn_array<size_t> chain_from(0, 2 * (big - 1)), chain_to(0, 2 * (big - 1));
+  for (size_t i = 0; i + 1 < big; ++i) {
+    chain_from[2*i] = i;
+    chain_to[2*i] = i + 1;
+    chain_from[2*i+1] = i + 1;
+    chain_to[2*i+1] = i;
+  }
+  csr_graph<int> chain(dyn_array<int>(0, big), chain_from, chain_to);
+  std::cout << "Undirected path of a million nodes:" << std::endl;
+  TEST_EQUAL(chain.num_edges(), 2 * (big - 1), "Every link goes both ways");
+  dyn_array<size_t> order = chain.depth_first_traverse(0);
+  check = order.size() == big && order[big-1] == big - 1;
+  TEST_CHECK(check, "Depth-first traverse should walk the whole path");
+  order = chain.breadth_first_traverse(big / 2);
+  check = order.size() == big && order[1] == big / 2 - 1;
+  TEST_CHECK(check, "Breadth-first traverse should spread both ways");
+  TEST_EQUAL(chain.shortest_dists(0)[big-1], static_cast<int>(big - 1),
+             "Last node should be a million hops away");
+  TEST_EQUAL(chain.weakly_conn_comp().max(), 0, "Path should be 1 component");
+  TEST_EQUAL(chain.strongly_conn_comp().size(), 1, "Path should be 1 SCC");
+  TEST_EQUAL(chain.bridges().size(), big - 1, "Every link is a bridge");
+  TEST_EQUAL(chain.articulation_points().size(), big - 2,
+             "Every inner node is an articulation point");
+
+  test_util::print_summary();
+  return 0;
+}
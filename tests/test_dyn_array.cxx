@@ -1,8 +1,101 @@
+#include <atomic>
 #include <iostream>
 #include <iomanip>
+#include <limits>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include "dyn_array.h"
+#include "mapped_array.h"
+#include "dyn_view.h"
 #include "test_util.h"
 
+// Element type that counts its constructions, copies and destructions.
+struct tracked
+{
+  static int defaults;
+  static int copies;
+  static int live;
+  tracked(): val_(0) {defaults++; live++;}
+  tracked(int val): val_(val) {live++;}
+  tracked(const tracked& other): val_(other.val_) {copies++; live++;}
+  tracked(tracked&& other): val_(other.val_) {live++;}
+  ~tracked() {live--;}
+  tracked& operator = (const tracked& other)
+      {val_ = other.val_; copies++; return *this;}
+  tracked& operator = (tracked&& other) {val_ = other.val_; return *this;}
+  bool operator == (const tracked& other) const {return val_ == other.val_;}
+  bool operator < (const tracked& other) const {return val_ < other.val_;}
+  bool operator > (const tracked& other) const {return val_ > other.val_;}
+  int val_;
+};
+// Trivially copyable record for file-backed arrays.
+struct record
+{
+  long long id;
+  double score;
+  bool operator == (const record& other) const {return id == other.id;}
+  bool operator < (const record& other) const {return id < other.id;}
+  bool operator > (const record& other) const {return id > other.id;}
+};
+
+std::ostream& operator << (std::ostream& os, const record& r)
+{
+  return os << r.id;
+}
+
+int tracked::defaults = 0;
+int tracked::copies = 0;
+int tracked::live = 0;
+
+// Checks linear search, min, max, equality and unique_cnt of dyn_array<T>
+// against plain loops, on arrays of every size up to 70 so that vector
+// kernels meet every tail length. Values repeat over a range of 13 steps.
+template <class T>
+bool scans_match(T base, T step)
+{
+  for (size_t n = 1; n <= 70; ++n) {
+    dyn_array<T> arr;
+    unsigned x = 12345;
+    for (size_t i = 0; i < n; ++i) {
+      x = x * 1103515245u + 12345u;
+      arr.add(static_cast<T>(base + step * static_cast<T>((x >> 16) % 13)));
+    }
+    T lo = arr[0];
+    T hi = arr[0];
+    size_t hits = 0;
+    for (size_t i = 0; i < n; ++i) {
+      lo = arr[i] < lo ? arr[i] : lo;
+      hi = arr[i] > hi ? arr[i] : hi;
+      hits += arr[i] == arr[n / 2];
+    }
+    dyn_array<size_t> found = arr.search(arr[n / 2]);
+    if (arr.min() != lo || arr.max() != hi || found.size() != hits)
+      return false;
+    for (size_t k = 0; k < found.size(); ++k)
+      if (arr[found[k]] != arr[n / 2] || (k > 0 && found[k] <= found[k-1]))
+        return false;
+    dyn_array<T> other = arr;
+    if (!(other == arr))
+      return false;
+    other[n - 1] = static_cast<T>(other[n - 1] + step);
+    if (other == arr)
+      return false;
+    dyn_array<size_t> cnt = other.unique_cnt();
+    size_t total = 0;
+    for (size_t k = 0; k < other.size(); ++k) {
+      total += cnt[k];
+      if (other.search(other[k]).size() != 1)
+        return false;
+    }
+    if (total != n)
+      return false;
+  }
+  return true;
+}
+
 int main()
 {
   std::cout << "----------------------------------------------" << std::endl;
@@ -662,6 +755,82 @@ int main()
   std::cout << "Output: " << cat_ptr.heap_sort() << std::endl;
   TEST_PTR(cat_ptr, cat_gt, 32, "Ptrs should be in increasing val order");
 
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "INTRO SORT TESTS" << std::endl << std::endl;
+
+  std::cout << "Intro sort on Euler's totient function" << std::endl;
+  std::cout << "Input: " << (eul_tot = euler_totient).shuffle() << std::endl;
+  std::cout << "Output: " << eul_tot.intro_sort() << std::endl;
+  TEST_SEQ(eul_tot, eul_gt, 100, "Vals should be sorted in increasing order");
+  std::cout << std::endl;
+
+  eul_gt.reverse();
+  std::cout << "Intro sort on ptrs to Euler's totient values" << std::endl;
+  std::cout << "Input: " << (eul_ptr = euler_ptr).shuffle() << std::endl;
+  std::cout << "Output: " << eul_ptr.intro_sort(false) << std::endl;
+  TEST_PTR(eul_ptr, eul_gt, 100, "Ptrs should be in decreasing val order");
+  std::cout << std::endl;
+  eul_gt.reverse();
+
+  leib_gt.reverse();
+  std::cout << "Intro sort on terms of Leibniz series for pi" << std::endl;
+  std::cout << "Input: " << (leib_pi = leibniz_pi).shuffle() << std::endl;
+  std::cout << "Output: " << leib_pi.intro_sort(false) << std::endl;
+  TEST_SEQ(leib_pi, leib_gt, 100, "Vals should be sorted in decreasing order");
+  std::cout << std::endl;
+  leib_gt.reverse();
+
+  std::cout << "Intro sort on ptrs to Catalan-Mobius numbers" << std::endl;
+  std::cout << "Input: " << (cat_ptr = catalan_ptr).shuffle() << std::endl;
+  std::cout << "Output: " << cat_ptr.intro_sort() << std::endl;
+  TEST_PTR(cat_ptr, cat_gt, 32, "Ptrs should be in increasing val order");
+  std::cout << std::endl;
+
+  // Inputs that defeat quick_sort's middle pivot or that most quicksorts
+  // handle poorly, each checked against merge sort in both orders.
+  const size_t n_adv = 20000;
+  const char* adv_names[] = {"sorted", "reversed", "all equal", "organ pipe",
+                             "sawtooth", "few distinct", "median-of-3 killer",
+                             "sorted with noise"};
+  bool adv_ok = true;
+  for (int shape = 0; shape < 8; ++shape) {
+    dyn_array<int> adv;
+    unsigned noise = 7;
+    for (size_t i = 0; i < n_adv; ++i) {
+      int k = static_cast<int>(i);
+      int m = static_cast<int>(n_adv);
+      noise = noise * 1103515245u + 12345u;
+      int vals[] = {k, m - k, 5, k < m / 2 ? k : m - k, k % 100,
+                    static_cast<int>((noise >> 16) % 4),
+                    k % 2 ? m / 2 + k - 1 : k + 1,
+                    noise % 50 ? k : static_cast<int>((noise >> 8) % m)};
+      adv.add(vals[shape]);
+    }
+    for (int order = 0; order < 2; ++order) {
+      dyn_array<int> adv_gt = adv;
+      dyn_array<int> adv_in = adv;
+      adv_gt.merge_sort(order == 0);
+      adv_in.intro_sort(order == 0);
+      if (!(adv_in == adv_gt)) {
+        std::cout << "Failed on " << adv_names[shape] << " input" << std::endl;
+        adv_ok = false;
+      }
+    }
+  }
+  std::cout << "Intro sort on 8 adversarial shapes of 20000 ints" << std::endl;
+  TEST_CHECK(adv_ok, "Adversarial inputs should be sorted in both orders");
+
+  dyn_array<std::string> dup_words;
+  for (size_t i = 0; i < 3000; ++i)
+    dup_words.add("w" + std::to_string((i * 7919) % 1000));
+  dyn_array<std::string> dup_words_gt = dup_words;
+  dup_words_gt.merge_sort();
+  dup_words.intro_sort();
+  TEST_CHECK(dup_words == dup_words_gt,
+             "Intro sort should sort duplicate strings");
+  TEST_EQUAL(dup_words.search("w500").size(), 3,
+             "Intro-sorted array should be searchable");
+
   std::cout << "----------------------------------------------" << std::endl;
   std::cout << "COUNTING SORT TESTS" << std::endl << std::endl;
 
@@ -770,6 +939,45 @@ int main()
   std::cout << "Output: " << (land_fn = land_fn.radix_sort()) << std::endl;
   TEST_SEQ(land_fn, landau, 48, "Vals should be sorted in increasing order");
 
+  std::cout << "Radix sort on terms of Leibniz series for pi" << std::endl;
+  std::cout << "Input: " << (leib_pi = leibniz_pi).shuffle() << std::endl;
+  std::cout << "Output: " << (leib_pi = leib_pi.radix_sort()) << std::endl;
+  TEST_SEQ(leib_pi, leib_gt, 100, "Vals should be sorted in increasing order");
+
+  std::cout << "Radix sort on Mobius-signed Catalan numbers" << std::endl;
+  std::cout << "Input: " << (cat_mob = catalan_mobius).shuffle() << std::endl;
+  std::cout << "Output: " << (cat_mob = cat_mob.radix_sort()) << std::endl;
+  TEST_SEQ(cat_mob, cat_gt, 32, "Vals should be sorted in increasing order");
+
+  const float inf = std::numeric_limits<float>::infinity();
+  dyn_array<float> edge_fl = {inf, -0.0f, 1e-40f, -inf, 0.0f, -1.5f, 3.0f,
+                              -1e-40f};
+  dyn_array<float> edge_gt = {-inf, -1.5f, -1e-40f, -0.0f, 0.0f, 1e-40f,
+                              3.0f, inf};
+  std::cout << "Radix sort on infinities, zeros and subnormal floats";
+  std::cout << std::endl;
+  dyn_array<float> edge_inc = edge_fl.radix_sort();
+  TEST_SEQ(edge_inc, edge_gt, 8, "Vals should be sorted in increasing order");
+  TEST_CHECK(std::signbit(edge_inc[3]) && !std::signbit(edge_inc[4]),
+             "Negative zero should precede positive zero");
+  dyn_array<float> edge_dec = edge_fl.radix_sort(false);
+  edge_gt.reverse();
+  TEST_SEQ(edge_dec, edge_gt, 8, "Vals should be sorted in decreasing order");
+
+  dyn_array<long long> wide_ll;
+  unsigned long long wide_x = 88172645463325252ULL;
+  for (size_t i = 0; i < 5000; ++i) {
+    wide_x ^= wide_x << 13;
+    wide_x ^= wide_x >> 7;
+    wide_x ^= wide_x << 17;
+    wide_ll.add(static_cast<long long>(i % 4 ? wide_x : wide_x >> 40));
+  }
+  dyn_array<long long> wide_ll_gt = wide_ll;
+  wide_ll_gt.merge_sort(false);
+  std::cout << "Radix sort on 5000 random 64-bit integers" << std::endl;
+  TEST_CHECK(wide_ll.radix_sort(false) == wide_ll_gt,
+             "Vals should be sorted in decreasing order");
+
   std::cout << "----------------------------------------------" << std::endl;
   std::cout << "BUCKET SORT TESTS" << std::endl << std::endl;
 
@@ -909,6 +1117,630 @@ int main()
   TEST_CHECK(unique_in == unique_out, "Earlier output should match dyn_array");
   TEST_SEQ(counts, gt4, 9, "Unique counts should match expected results");
 
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "MOVE SEMANTICS AND IN-PLACE CONSTRUCTION" << std::endl;
+
+  {
+    dyn_array<tracked> tr;
+    for (int i = 0; i < 100; ++i)
+      tr.emplace(i);
+    std::cout << "Emplaced 100 tracked elements one by one" << std::endl;
+    TEST_EQUAL(tracked::defaults, 0, "Growth shouldn't default-construct");
+    TEST_EQUAL(tracked::copies, 0, "Growth should move instead of copying");
+    TEST_EQUAL(tracked::live, 100, "Only 100 elements should be alive");
+    dyn_array<tracked> tr2 = std::move(tr);
+    TEST_EQUAL(tr.size(), 0, "Moved-from array should be empty");
+    TEST_EQUAL(tr2.size(), 100, "Moved-to array should have all elements");
+    TEST_EQUAL(tracked::copies, 0, "Move construction shouldn't copy");
+    tr2.remove();
+    tr2.resize(50);
+    TEST_EQUAL(tracked::live, 50, "Shrinking should destroy the tail");
+    tr = std::move(tr2);
+    TEST_EQUAL(tr[49].val_, 49, "Move assignment should keep elements");
+    tr.add(tr[0]);
+    TEST_EQUAL(tr.size(), 51, "Adding own element should grow the array");
+    TEST_EQUAL(tr[50].val_, 0, "Added own element should keep its value");
+  }
+  TEST_EQUAL(tracked::live, 0, "Destroyed arrays should leave none alive");
+
+  dyn_array<std::string> words;
+  words.emplace(3, 'z').emplace("emplaced").add(std::string("moved"));
+  std::cout << "Emplaced and moved strings: " << words << std::endl;
+  TEST_EQUAL(words[0], "zzz", "Emplace should forward constructor arguments");
+  dyn_array<std::string> more = {"one", "two"};
+  words.append(std::move(more));
+  TEST_EQUAL(more.size(), 0, "Moved-from appended array should be empty");
+  TEST_EQUAL(words.size(), 5, "Move append should add all elements");
+  TEST_EQUAL(words[4], "two", "Move append should keep the order");
+  words.append(words);
+  TEST_EQUAL(words.size(), 10, "Appending to itself should double the size");
+  TEST_EQUAL(words[9], "two", "Self append should copy all elements");
+
+  dyn_array<dyn_array<int> > nested;
+  dyn_array<int> row = {1, 2, 3};
+  nested.add(std::move(row));
+  nested.add(nested[0]);
+  nested.emplace(0, 4);
+  std::cout << "Built nested arrays: " << nested[0] << " | " << nested[1];
+  std::cout << " | " << nested[2] << std::endl;
+  TEST_EQUAL(row.size(), 0, "Moved-in row should be empty");
+  TEST_CHECK(nested[0] == nested[1], "Copied row should match the original");
+  TEST_EQUAL(nested[2].size(), 4, "Emplaced row should have 4 elements");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "SMALL ARRAY WITH INLINE CAPACITY" << std::endl;
+
+  {
+    int copied = tracked::copies;
+    small_array<tracked, 4> sa;
+    const char* lo = reinterpret_cast<const char*>(&sa);
+    const char* hi = lo + sizeof(sa);
+    for (int i = 0; i < 4; ++i)
+      sa.emplace(i);
+    const char* at = reinterpret_cast<const char*>(&sa[0]);
+    std::cout << "Emplaced 4 tracked elements into small_array<tracked, 4>";
+    std::cout << std::endl;
+    TEST_EQUAL(sa.capacity(), 4, "Inline capacity should be 4");
+    TEST_CHECK(at >= lo && at < hi, "Elements should be stored inline");
+    small_array<tracked, 4> sb = std::move(sa);
+    TEST_EQUAL(sa.size(), 0, "Moved-from inline array should be empty");
+    TEST_EQUAL(sb[3].val_, 3, "Moved-to array should have all elements");
+    TEST_EQUAL(tracked::live, 4, "Inline move shouldn't leave copies alive");
+    sa.emplace(10);
+    TEST_EQUAL(sa.capacity(), 4, "Moved-from array should keep its storage");
+    sb.emplace(4);
+    at = reinterpret_cast<const char*>(&sb[0]);
+    lo = reinterpret_cast<const char*>(&sb);
+    std::cout << "Emplaced a 5th element, spilling over to the heap";
+    std::cout << std::endl;
+    TEST_EQUAL(sb.capacity(), 8, "Spilled array should double its capacity");
+    TEST_CHECK(at < lo || at >= lo + sizeof(sb), "Elements should be on heap");
+    TEST_EQUAL(tracked::copies, copied, "Spilling should move, not copy");
+    dyn_array<tracked> da = std::move(sb);
+    TEST_EQUAL(da.size(), 5, "Heap storage should be handed to dyn_array");
+    TEST_EQUAL(&da[0], reinterpret_cast<const tracked*>(at),
+               "Heap storage should be stolen instead of moved");
+    sb = da;
+    TEST_EQUAL(sb.size(), 5, "Assigning dyn_array should copy its elements");
+    sb.clear();
+    TEST_EQUAL(sb.capacity(), 0, "Cleared spilled array should release heap");
+    sa.clear();
+    TEST_EQUAL(sa.capacity(), 4, "Cleared inline array should keep storage");
+    sa = {tracked(7), tracked(8)};
+    TEST_EQUAL(sa[1].val_, 8, "Initializer list assignment should fit inline");
+  }
+  TEST_EQUAL(tracked::live, 0, "Destroyed small arrays should leave none");
+
+  small_array<std::string, 2> sw(std::string("ab"), 3);
+  std::cout << "Built small_array<std::string, 2> with 3 copies: " << sw;
+  std::cout << std::endl;
+  TEST_EQUAL(sw.size(), 3, "Array should hold 3 strings");
+  sw.resize(2);
+  TEST_EQUAL(sw.capacity(), 2, "Resized array should have capacity 2");
+  small_array<std::string, 2> sw2(sw);
+  sw2.add("cd");
+  TEST_EQUAL(sw.size(), 2, "Copied-from array should be unchanged");
+  TEST_EQUAL(sw2[2], "cd", "Copy should grow independently");
+  sw2.merge_sort();
+  TEST_EQUAL(sw2.search("cd").size(), 1, "Sorted copy should be searchable");
+  TEST_EQUAL(sizeof(small_array<int*, 3>), sizeof(dyn_array<int*>) +
+             3 * sizeof(int*), "Inline storage should only add N elements");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "SIMD KERNELS FOR ARITHMETIC TYPES" << std::endl;
+
+  const char* level_names[] = {"scalar", "SSE2", "AVX2"};
+  simd::Level best = simd::detect();
+  std::cout << "Widest instruction set supported: " << level_names[best];
+  std::cout << std::endl;
+  dyn_array<float> with_nan = {3.0f, 2.0f, 5.0f, 1.0f, 4.0f, 6.0f, 7.0f, 8.0f,
+                               9.0f, 0.5f, 2.5f, 8.5f, 7.5f, 1.5f, 6.5f, 5.5f,
+                               4.5f, 3.5f, 0.0f, 9.5f};
+  with_nan[7] = std::numeric_limits<float>::quiet_NaN();
+  simd::limit(simd::SCALAR);
+  float nan_min = with_nan.min();
+  float nan_max = with_nan.max();
+  for (int lvl = simd::SCALAR; lvl <= best; ++lvl) {
+    simd::limit(static_cast<simd::Level>(lvl));
+    std::string on = std::string(" with ") + level_names[lvl] + " kernels";
+    TEST_CHECK(scans_match<float>(-3.5f, 0.5f), "float scans" + on);
+    TEST_CHECK(scans_match<double>(1e10, -0.25), "double scans" + on);
+    TEST_CHECK(scans_match<int>(-6, 1), "int scans" + on);
+    TEST_CHECK(scans_match<unsigned>(2147483600u, 7u), "unsigned scans" + on);
+    TEST_CHECK(scans_match<long long>(-(1LL << 40), 1LL << 33),
+               "long long scans" + on);
+    TEST_CHECK(scans_match<unsigned long long>((1ULL << 63) - 40, 7),
+               "unsigned long long scans" + on);
+    TEST_CHECK(scans_match<short>(-6, 1), "short scans" + on);
+    TEST_CHECK(with_nan.min() == nan_min && with_nan.max() == nan_max,
+               "NaN should give the same min and max" + on);
+  }
+  simd::limit(best);
+  TEST_EQUAL(simd::level(), best, "Kernels should be restored to the widest");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "PARALLEL SORTS ON A THREAD POOL" << std::endl;
+
+  thread_pool pool(4);
+  TEST_EQUAL(pool.size(), 4, "Pool should have 4 threads");
+  int runs[1000] = {0};
+  pool.run(1000, [&](size_t i) {
+    runs[i]++;
+    // Nested batches run serially on the same thread.
+    pool.run(3, [&](size_t j) {runs[i] += static_cast<int>(j);});
+  });
+  bool ran_once = true;
+  for (size_t i = 0; i < 1000; ++i)
+    ran_once = ran_once && runs[i] == 4;
+  TEST_CHECK(ran_once, "Every task and nested task should run exactly once");
+
+  // 100000 values in [-2500, 2500) with many duplicates, and pointers to
+  // them whose addresses give their original order.
+  const size_t n_par = 100000;
+  dyn_array<int> par_vals;
+  unsigned lcg = 2024;
+  for (size_t i = 0; i < n_par; ++i) {
+    lcg = lcg * 1103515245u + 12345u;
+    par_vals.add(static_cast<int>((lcg >> 8) % 5000) - 2500);
+  }
+  dyn_array<int*> par_ptrs;
+  for (size_t i = 0; i < n_par; ++i)
+    par_ptrs.add(&par_vals[i]);
+  dyn_array<int> inc_gt = par_vals;
+  dyn_array<int> dec_gt = par_vals;
+  inc_gt.merge_sort();
+  dec_gt.merge_sort(false);
+  dyn_array<int*> ptr_gt = par_ptrs;
+  ptr_gt.merge_sort(false);
+  std::cout << "Sorting 100000 ints and pointers to them on 4 threads";
+  std::cout << std::endl;
+
+  dyn_array<int> par = par_vals;
+  TEST_CHECK(par.par_merge_sort(true, &pool) == inc_gt,
+             "Parallel merge sort should sort in increasing order");
+  par = par_vals;
+  TEST_CHECK(par.par_merge_sort(false, &pool) == dec_gt,
+             "Parallel merge sort should sort in decreasing order");
+  dyn_array<int*> par_p = par_ptrs;
+  par_p.par_merge_sort(false, &pool);
+  bool same_ptrs = true;
+  for (size_t i = 0; i < n_par; ++i)
+    same_ptrs = same_ptrs && par_p[i] == ptr_gt[i];
+  TEST_CHECK(same_ptrs, "Parallel merge sort should be stable");
+  // Moving strings leaves them empty, so split points that are searched
+  // while other pieces merge would land in the wrong place.
+  dyn_array<std::string> par_strs;
+  for (size_t i = 0; i < 40000; ++i)
+    par_strs.add("s" + std::to_string(par_vals[i] + 2500));
+  dyn_array<std::string> str_gt = par_strs;
+  str_gt.merge_sort();
+  std::cout << "Sorting 40000 strings on 4 threads, 10 times" << std::endl;
+  bool strs_sorted = true;
+  for (int rep = 0; rep < 10 && strs_sorted; ++rep) {
+    dyn_array<std::string> strs = par_strs;
+    strs_sorted = strs.par_merge_sort(true, &pool) == str_gt;
+  }
+  TEST_CHECK(strs_sorted, "Parallel merge sort should sort strings");
+
+  par = par_vals;
+  TEST_CHECK(par.sample_sort(true, &pool) == inc_gt,
+             "Sample sort should sort in increasing order");
+  par = par_vals;
+  TEST_CHECK(par.sample_sort(false, &pool) == dec_gt,
+             "Sample sort should sort in decreasing order");
+  par_p = par_ptrs;
+  par_p.sample_sort(false, &pool);
+  same_ptrs = true;
+  for (size_t i = 0; i < n_par; ++i)
+    same_ptrs = same_ptrs && par_p[i] == ptr_gt[i];
+  TEST_CHECK(same_ptrs, "Sample sort should be stable");
+  dyn_array<int> few(7, n_par);
+  for (size_t i = 0; i < n_par; i += 1000)
+    few[i] = static_cast<int>(i % 3);
+  dyn_array<int> few_gt = few;
+  few_gt.merge_sort();
+  TEST_CHECK(few.sample_sort(true, &pool) == few_gt,
+             "Sample sort should handle repeated splitters");
+  TEST_EQUAL(few.search(7).size(), n_par - n_par / 1000,
+             "Sample-sorted array should be searchable");
+
+  par = par_vals;
+  TEST_CHECK(par.par_radix_sort(true, &pool) == inc_gt,
+             "Parallel radix sort should sort negative values");
+  TEST_CHECK(par_vals.par_radix_sort(false, &pool) == dec_gt,
+             "Parallel radix sort should sort in decreasing order");
+  dyn_array<unsigned long long> wide_vals;
+  for (size_t i = 0; i < n_par; ++i)
+    wide_vals.add(static_cast<unsigned long long>(par_vals[i]) << 40 ^ i);
+  dyn_array<unsigned long long> wide_gt = wide_vals;
+  wide_gt.merge_sort();
+  TEST_CHECK(wide_vals.par_radix_sort(true, &pool) == wide_gt,
+             "Parallel radix sort should sort all 8 bytes");
+  dyn_array<double> par_dbl;
+  for (size_t i = 0; i < n_par; ++i)
+    par_dbl.add(par_vals[i] / 7.0);
+  dyn_array<double> par_dbl_gt = par_dbl;
+  par_dbl_gt.merge_sort(false);
+  TEST_CHECK(par_dbl.par_radix_sort(false, &pool) == par_dbl_gt,
+             "Parallel radix sort should sort doubles");
+  dyn_array<char> chars = {'q', 'a', -5, 'z', 0, 'a', -128, 127};
+  dyn_array<char> chars_gt = chars;
+  chars_gt.merge_sort(false);
+  TEST_CHECK(chars.par_radix_sort(false) == chars_gt,
+             "Radix sort on the shared pool should sort small arrays");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "HASH-BASED UNIQUE VALUES" << std::endl;
+
+  // 1000 distinct values with multiplicative hashes spread over 100000 ids,
+  // checked against the counts of a direct lookup table.
+  const size_t n_ids = 100000;
+  dyn_array<long long> ids;
+  for (size_t i = 0; i < n_ids; ++i)
+    ids.add(static_cast<long long>((i * 7919) % 1000) * 1000003 - 500000000);
+  int id_cnt[1000] = {0};
+  dyn_array<long long> id_gt;
+  for (size_t i = 0; i < n_ids; ++i) {
+    size_t key = (i * 7919) % 1000;
+    if (id_cnt[key]++ == 0)
+      id_gt.add(ids[i]);
+  }
+  std::cout << "Deduplicating 100000 ids with 1000 distinct values";
+  std::cout << std::endl;
+  TEST_CHECK(ids.unique() == id_gt,
+             "Hashed unique values should be in order of first appearance");
+  dyn_array<long long> id_rep = ids;
+  dyn_array<size_t> id_counts = id_rep.unique_cnt();
+  TEST_CHECK(id_rep == id_gt, "Hashed unique_cnt should keep unique values");
+  bool counts_match = id_counts.size() == 1000;
+  for (size_t i = 0; counts_match && i < id_rep.size(); ++i) {
+    size_t key = static_cast<size_t>((id_rep[i] + 500000000) / 1000003);
+    counts_match = id_counts[i] == static_cast<size_t>(id_cnt[key]);
+  }
+  TEST_CHECK(counts_match, "Hashed counts should match the lookup table");
+
+  ids = ids.radix_sort();
+  dyn_array<long long> sorted_gt = id_gt;
+  sorted_gt.merge_sort();
+  std::cout << "Deduplicating the same ids after sorting them" << std::endl;
+  TEST_CHECK(ids.unique() == sorted_gt,
+             "Sorted unique values should be sorted");
+  dyn_array<size_t> sorted_counts = ids.unique_cnt();
+  TEST_CHECK(ids == sorted_gt, "Sorted unique_cnt should keep unique values");
+  TEST_EQUAL(sorted_counts[0] + sorted_counts[999], 200,
+             "Sorted counts should count runs of equal values");
+  TEST_EQUAL(ids.search(sorted_gt[500]).size(), 1,
+             "Unique values of a sorted array should stay searchable");
+
+  dyn_array<std::string> tags = {"red", "green", "red", "blue", "", "green",
+                                 "", "red"};
+  dyn_array<size_t> tag_counts = tags.unique_cnt();
+  std::cout << "Unique strings: " << tags << std::endl;
+  std::string tag_gt[4] = {"red", "green", "blue", ""};
+  size_t tag_cnt_gt[4] = {3, 2, 1, 2};
+  TEST_SEQ(tags, tag_gt, 4, "Hashed strings should be deduplicated");
+  TEST_SEQ(tag_counts, tag_cnt_gt, 4, "Hashed string counts should match");
+
+  // Pointers to equal values at different addresses are the same value.
+  int twins[6] = {4, 8, 4, 15, 8, 4};
+  dyn_array<int*> twin_ptrs;
+  for (int i = 0; i < 6; ++i)
+    twin_ptrs.add(&twins[i]);
+  twin_ptrs.add(nullptr).add(nullptr);
+  dyn_array<size_t> twin_counts = twin_ptrs.unique_cnt();
+  size_t twin_cnt_gt[4] = {3, 2, 1, 2};
+  TEST_EQUAL(twin_ptrs.size(), 4, "Pointers should be compared by value");
+  TEST_CHECK(twin_ptrs[0] == &twins[0] && twin_ptrs[1] == &twins[1],
+             "First pointer to every value should be kept");
+  TEST_CHECK(twin_ptrs[3] == nullptr, "Null pointers should be one value");
+  TEST_SEQ(twin_counts, twin_cnt_gt, 4, "Pointer counts should match");
+
+  // Types without std::hash fall back to comparing against unique values.
+  dyn_array<tracked> marks;
+  for (int i = 0; i < 20; ++i)
+    marks.add(tracked(i % 3));
+  dyn_array<size_t> mark_counts = marks.unique_cnt();
+  size_t mark_cnt_gt[3] = {7, 7, 6};
+  TEST_EQUAL(marks.size(), 3, "Values without hashes should be deduplicated");
+  TEST_EQUAL(marks[2].val_, 2, "Values without hashes should keep order");
+  TEST_SEQ(mark_counts, mark_cnt_gt, 3, "Counts without hashes should match");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "MEMORY-MAPPED FILE STORAGE" << std::endl;
+
+  const char* rec_path = "test_dyn_array_records.bin";
+  const size_t n_recs = 50000;
+  std::remove(rec_path);
+  {
+    mapped_array<record> recs(rec_path);
+    TEST_CHECK(recs.is_open(), "New file should be mapped");
+    TEST_EQUAL(recs.size(), 0, "New file should hold no records");
+    for (size_t i = 0; i < n_recs; ++i)
+      recs.add(record{static_cast<long long>((i * 7919) % n_recs), i * 0.5});
+    std::cout << "Added 50000 records to " << recs.path() << std::endl;
+    TEST_EQUAL(recs.size(), n_recs, "Growing should remap the file");
+    TEST_CHECK(recs.capacity() >= n_recs, "Capacity should cover all records");
+    TEST_EQUAL(recs[1].id, 7919, "Records should survive remapping");
+    recs.advise(file_map::RANDOM).intro_sort();
+    TEST_EQUAL(recs.search(record{4321, 0.0}).size(), 1,
+               "Sorted records should be searchable");
+  }
+  // The header holds the size at byte 16 and the sorted flag at byte 24.
+  std::ifstream rec_file(rec_path, std::ios::binary);
+  char rec_head[64];
+  rec_file.read(rec_head, 64);
+  rec_file.seekg(0, std::ios::end);
+  TEST_EQUAL(static_cast<size_t>(rec_file.tellg()), 64 + n_recs * 16,
+             "Closed file should be trimmed to its records");
+  rec_file.close();
+  std::uint64_t saved_size;
+  std::int32_t saved_sorted;
+  std::memcpy(&saved_size, rec_head + 16, 8);
+  std::memcpy(&saved_sorted, rec_head + 24, 4);
+  TEST_EQUAL(saved_size, n_recs, "Header should hold the size");
+  TEST_EQUAL(saved_sorted, 1, "Header should hold the sorted flag");
+  {
+    mapped_array<record> recs(rec_path);
+    std::cout << "Reopened " << recs.path() << std::endl;
+    TEST_EQUAL(recs.size(), n_recs, "Reopened file should hold all records");
+    const mapped_array<record>& crecs = recs;
+    bool in_order = true;
+    for (size_t i = 0; i < crecs.size() && in_order; ++i)
+      in_order = crecs[i].id == static_cast<long long>(i);
+    TEST_CHECK(in_order, "Reopened records should stay sorted");
+    dyn_array<size_t> hits = recs.search(record{777, 0.0});
+    TEST_CHECK(hits.size() == 1 && hits[0] == 777,
+               "Reopened file should be searchable");
+    dyn_array<record> heap_recs = recs;
+    heap_recs.resize(10);
+    recs = std::move(heap_recs);
+    recs.sync();
+    TEST_EQUAL(recs.size(), 10, "Moving into the file should replace records");
+    TEST_CHECK(recs.is_open(), "Moved records should stay in the file");
+    recs.clear();
+    TEST_CHECK(recs.is_open(), "Cleared file should stay mapped");
+    recs.add(record{3, 1.5}).add(record{1, 2.5});
+  }
+  {
+    mapped_array<record> recs(rec_path);
+    TEST_EQUAL(recs.size(), 2, "Reopened file should hold the new records");
+    TEST_EQUAL(recs[1].score, 2.5, "Record fields should be saved");
+    std::cout << "Trying to open the file as an array of ints" << std::endl;
+    mapped_array<int> ints(rec_path);
+    TEST_CHECK(!ints.is_open(), "Files of other record types should fail");
+    ints.add(5);
+    TEST_EQUAL(ints.size(), 1, "Failed opens should fall back to the heap");
+  }
+  std::remove(rec_path);
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "BINARY SERIALIZATION AND ZERO-COPY VIEWS" << std::endl;
+
+  dyn_array<int> bin_src;
+  for (int i = 0; i < 1000; ++i)
+    bin_src.add((i * 37) % 1000 - 500);
+  bin_src.merge_sort();
+  std::stringstream bin_stream;
+  TEST_CHECK(bin_src.serialize(bin_stream), "Serializing ints should succeed");
+  std::string bin_bytes = bin_stream.str();
+  TEST_EQUAL(bin_bytes.size(), 32 + 1000 * sizeof(int),
+             "Ints should be written as a header and raw bytes");
+  dyn_array<int> bin_dst(7, 3);
+  TEST_CHECK(bin_dst.deserialize(bin_stream), "Deserializing should succeed");
+  TEST_CHECK(bin_dst == bin_src, "Deserialized ints should match");
+  TEST_EQUAL(bin_dst.search(-123).size(), 1,
+             "Deserialized array should stay searchable");
+
+  // Views need aligned buffers, which an array of 64-bit words provides.
+  dyn_array<std::uint64_t> bin_buf(0, bin_bytes.size() / 8 + 1);
+  std::memcpy(&bin_buf[0], bin_bytes.data(), bin_bytes.size());
+  dyn_view<int> bin_view;
+  TEST_CHECK(bin_view.load(&bin_buf[0], bin_bytes.size()),
+             "Viewing serialized ints should succeed");
+  TEST_EQUAL(bin_view.size(), 1000, "View should see all ints");
+  TEST_CHECK(bin_view.data() == reinterpret_cast<const int*>(
+                 reinterpret_cast<const char*>(&bin_buf[0]) + 32),
+             "View should reference the buffer in place");
+  TEST_EQUAL(bin_view[0], -500, "View should see the first int");
+  TEST_EQUAL(bin_view.find(-123), 377, "Sorted view should binary search");
+  TEST_EQUAL(bin_view.find(1000), 1000, "Missing ints should not be found");
+  TEST_CHECK(bin_view.to_array() == bin_src, "Copied view should match");
+
+  std::cout << "Loading ints from truncated and misaligned buffers";
+  std::cout << std::endl;
+  TEST_CHECK(!bin_view.load(&bin_buf[0], bin_bytes.size() - 1),
+             "Truncated buffers should fail");
+  TEST_CHECK(bin_view.is_empty(), "Failed loads should leave views empty");
+  char* bin_odd = reinterpret_cast<char*>(&bin_buf[0]) + 1;
+  std::memcpy(bin_odd, bin_bytes.data(), bin_bytes.size());
+  TEST_CHECK(!bin_view.load(bin_odd, bin_bytes.size()),
+             "Misaligned buffers should fail");
+  std::cout << "Reading ints as doubles" << std::endl;
+  std::stringstream bin_ints(bin_bytes);
+  dyn_array<double> bin_dbl;
+  TEST_CHECK(!bin_dbl.deserialize(bin_ints), "Other types should fail");
+
+  dyn_array<double> bin_dec;
+  for (int i = 0; i < 100; ++i)
+    bin_dec.add(i * 0.25);
+  bin_dec.merge_sort(false);
+  std::stringstream dec_stream;
+  bin_dec.serialize(dec_stream);
+  std::string dec_bytes = dec_stream.str();
+  dyn_array<std::uint64_t> dec_buf(0, dec_bytes.size() / 8 + 1);
+  std::memcpy(&dec_buf[0], dec_bytes.data(), dec_bytes.size());
+  dyn_view<double> dec_view;
+  dec_view.load(&dec_buf[0], dec_bytes.size());
+  TEST_EQUAL(dec_view.find(20.0), 19, "Decreasing view should binary search");
+
+  dyn_array<dyn_array<int> > bin_rows;
+  for (int r = 0; r < 50; ++r) {
+    dyn_array<int> row;
+    for (int c = 0; c < r % 7; ++c)
+      row.add(r * 100 + c);
+    bin_rows.add(row);
+  }
+  std::stringstream rows_stream;
+  TEST_CHECK(bin_rows.serialize(rows_stream),
+             "Serializing nested arrays should succeed");
+  std::string rows_bytes = rows_stream.str();
+  dyn_array<dyn_array<int> > rows_dst;
+  TEST_CHECK(rows_dst.deserialize(rows_stream),
+             "Deserializing nested arrays should succeed");
+  TEST_CHECK(rows_dst == bin_rows, "Deserialized rows should match");
+  dyn_array<std::uint64_t> rows_buf(0, rows_bytes.size() / 8 + 1);
+  std::memcpy(&rows_buf[0], rows_bytes.data(), rows_bytes.size());
+  dyn_view<dyn_array<int> > rows_view;
+  TEST_CHECK(rows_view.load(&rows_buf[0], rows_bytes.size()),
+             "Viewing nested arrays should succeed");
+  TEST_EQUAL(rows_view.size(), 50, "View should see all rows");
+  TEST_EQUAL(rows_view[7].size(), 0, "Empty rows should stay empty");
+  TEST_EQUAL(rows_view[48].size(), 6, "Rows should keep their sizes");
+  TEST_EQUAL(rows_view[48][5], 4805, "Rows should keep their values");
+  TEST_CHECK(rows_view.to_array() == bin_rows, "Copied rows should match");
+  std::cout << "Viewing ints as nested arrays" << std::endl;
+  std::memcpy(&bin_buf[0], bin_bytes.data(), bin_bytes.size());
+  TEST_CHECK(!rows_view.load(&bin_buf[0], bin_bytes.size()),
+             "Flat arrays should not load as nested ones");
+  // Sizes are read from the input, so corrupt ones have to fail cleanly
+  // rather than allocate what they claim.
+  std::cout << "Reading arrays with corrupt sizes and offsets" << std::endl;
+  std::string bad_bytes = bin_bytes;
+  const std::uint64_t huge = ~std::uint64_t(0) / 2;
+  std::memcpy(&bad_bytes[24], &huge, sizeof(huge));
+  std::stringstream bad_stream(bad_bytes);
+  TEST_CHECK(!bin_dst.deserialize(bad_stream) && bin_dst.is_empty(),
+             "Oversized flat arrays should fail");
+  std::uint64_t bad_size = 5000;
+  std::memcpy(&bad_bytes[24], &bad_size, sizeof(bad_size));
+  bad_stream.str(bad_bytes);
+  bad_stream.clear();
+  TEST_CHECK(!bin_dst.deserialize(bad_stream) && bin_dst.is_empty(),
+             "Flat arrays past the end of input should fail");
+  std::string bad_rows = rows_bytes;
+  std::memcpy(&bad_rows[24], &huge, sizeof(huge));
+  bad_stream.str(bad_rows);
+  bad_stream.clear();
+  TEST_CHECK(!rows_dst.deserialize(bad_stream) && rows_dst.is_empty(),
+             "Oversized nested arrays should fail");
+  bad_rows = rows_bytes;
+  std::memcpy(&bad_rows[32 + 8], &bad_size, sizeof(bad_size));
+  bad_stream.str(bad_rows);
+  bad_stream.clear();
+  TEST_CHECK(!rows_dst.deserialize(bad_stream),
+             "Decreasing row offsets should fail");
+  bad_rows = rows_bytes;
+  const std::uint64_t tera = std::uint64_t(1) << 40;
+  std::memcpy(&bad_rows[32 + 50 * 8], &tera, sizeof(tera));
+  bad_stream.str(bad_rows);
+  bad_stream.clear();
+  TEST_CHECK(!rows_dst.deserialize(bad_stream),
+             "Rows past the end of input should fail");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "LAZY AND PARALLEL PERMUTATIONS" << std::endl;
+
+  perm_gen<int> gen(perm_input);
+  size_t gen_cnt = 0;
+  bool gen_order = true;
+  while (gen.next())
+    gen_order = gen_order && gen.current() == perms[gen_cnt++];
+  TEST_EQUAL(gen_cnt, 24, "Generator should produce 24 permutations");
+  TEST_CHECK(gen_order, "Generator should follow the order of permutations");
+  TEST_CHECK(!gen.next(), "Finished generator should stay finished");
+
+  dyn_array<int> twin_vals = {1, 1, 2};
+  perm_gen<int> twin_gen(twin_vals);
+  gen_cnt = 0;
+  while (twin_gen.next())
+    gen_cnt++;
+  TEST_EQUAL(gen_cnt, 6, "Equal elements should be permuted as distinct");
+
+  dyn_array<int> tens = {10, 20, 30, 40, 50};
+  perm_gen<int> pre_gen(tens, dyn_array<size_t>({3, 1}));
+  int pre_gt[6][5] = {{40, 20, 10, 30, 50}, {40, 20, 10, 50, 30},
+                      {40, 20, 30, 10, 50}, {40, 20, 30, 50, 10},
+                      {40, 20, 50, 10, 30}, {40, 20, 50, 30, 10}};
+  gen_cnt = 0;
+  while (pre_gen.next()) {
+    TEST_SEQ(pre_gen.current(), pre_gt[gen_cnt], 5,
+             "Prefixed permutations should keep their prefix");
+    gen_cnt++;
+  }
+  TEST_EQUAL(gen_cnt, 6, "Prefix of 2 out of 5 should leave 6 permutations");
+  size_t pos_gt[5] = {3, 1, 4, 2, 0};
+  TEST_SEQ(pre_gen.positions(), pos_gt, 5,
+           "Positions should follow the last permutation");
+  std::cout << "Generating permutations with a repeated prefix position";
+  std::cout << std::endl;
+  perm_gen<int> bad_gen(tens, dyn_array<size_t>({2, 2}));
+  TEST_CHECK(!bad_gen.next(), "Invalid prefixes should generate nothing");
+
+  dyn_array<int> ten_vals;
+  for (int i = 0; i < 10; ++i)
+    ten_vals.add(i);
+  perm_gen<int> ten_gen(ten_vals);
+  gen_cnt = 0;
+  while (ten_gen.next())
+    gen_cnt++;
+  std::cout << "Generated all permutations of 10 elements one at a time";
+  std::cout << std::endl;
+  TEST_EQUAL(gen_cnt, 3628800, "There should be 10! permutations");
+  int rev_gt[10] = {9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+  TEST_SEQ(ten_gen.current(), rev_gt, 10, "Last permutation should be reversed");
+
+  // Each permutation of 8 distinct values is counted at its rank.
+  const size_t n_perm = 40320;
+  std::atomic<int>* perm_seen = new std::atomic<int>[n_perm]();
+  dyn_array<int> eight_vals = {0, 1, 2, 3, 4, 5, 6, 7};
+  auto perm_rank = [](const dyn_array<int>& perm) {
+    size_t rank = 0;
+    for (size_t i = 0; i < perm.size(); ++i) {
+      size_t smaller = 0;
+      for (size_t j = i + 1; j < perm.size(); ++j)
+        smaller += perm[j] < perm[i];
+      rank = rank * (perm.size() - i) + smaller;
+    }
+    return rank;
+  };
+  thread_pool perm_pool(4);
+  bool perm_all = eight_vals.par_permutations(
+    [&](const dyn_array<int>& perm) {
+      perm_seen[perm_rank(perm)]++;
+      return true;
+    }, &perm_pool);
+  std::cout << "Visited all permutations of 8 elements on 4 threads";
+  std::cout << std::endl;
+  bool seen_once = true;
+  for (size_t i = 0; i < n_perm; ++i)
+    seen_once = seen_once && perm_seen[i] == 1;
+  TEST_CHECK(perm_all, "Full enumeration should not report an early stop");
+  TEST_CHECK(seen_once, "Every permutation should be visited exactly once");
+
+  // Stop as soon as the permutation of rank 20000 shows up.
+  std::atomic<size_t> perm_visits(0);
+  std::atomic<bool> perm_found(false);
+  bool perm_done = eight_vals.par_permutations(
+    [&](const dyn_array<int>& perm) {
+      perm_visits++;
+      if (perm_rank(perm) != 20000)
+        return true;
+      perm_found = true;
+      return false;
+    }, &perm_pool);
+  TEST_CHECK(!perm_done && perm_found, "Enumeration should stop when asked");
+  TEST_CHECK(perm_visits < n_perm, "Stopped enumeration should skip the rest");
+  delete[] perm_seen;
+
+  dyn_array<int> no_vals;
+  size_t no_visits = 0;
+  TEST_CHECK(no_vals.par_permutations([&](const dyn_array<int>&) {
+    no_visits++;
+    return true;
+  }) && no_visits == 0, "Empty arrays should have nothing to visit");
+  TEST_EQUAL(no_vals.permutations().size(), 0,
+             "Empty arrays should have no permutations");
+
   test_util::print_summary();
   return 0;
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <random>
+#include <sstream>
 #include <string>
 #include "graph.h"
 #include "dyn_array.h"
@@ -679,6 +681,189 @@ int main()
   TEST_CHECK(gval_sorted == hval_sorted, "Sorted node vals should be equal");
   TEST_CHECK(g != h, "Graphs should not be equal");
 
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "PARALLEL BREADTH-FIRST TESTS" << std::endl << std::endl;
+
+  // Hop distances are checked against shortest_dists, which weighs every
+  // unweighted edge 1. Parents vary with thread timing, so they are checked
+  // to be one hop closer to the source over an existing edge.
+  auto bfs_ok = [](const graph<int>& gr, size_t src, thread_pool& tp) {
+    dyn_array<dyn_array<int> > res = gr.par_breadth_first(src, &tp);
+    dyn_array<int> dists = gr.shortest_dists(src);
+    if (res.size() != 2 || !(res[0] == dists))
+      return false;
+    for (size_t v = 0; v < gr.size(); ++v) {
+      int p = res[1][v];
+      if (dists[v] < 0 ? p != -1 : p < 0)
+        return false;
+      if (v == src ? p != static_cast<int>(src) :
+          p >= 0 && (dists[p] != dists[v] - 1 || !gr.weight(p, v)))
+        return false;
+    }
+    return true;
+  };
+
+  thread_pool pool(4);
+  thread_pool single(1);
+  std::mt19937 gen(7);
+  const size_t n = 300;
+  // Sparse random graphs stay top-down, while the dense one is expanded
+  // bottom-up once the frontier has most edges ahead of it.
+  const size_t edge_counts[] = {2 * n, 2 * n, 20 * n};
+  for (int r = 0; r < 3; ++r) {
+    bool undir = r == 1;
+    dyn_array<dyn_array<int> > adj(dyn_array<int>(0, n), n);
+    for (size_t e = 0; e < edge_counts[r]; ++e) {
+      size_t i = gen() % n, j = gen() % n;
+      adj[i][j] = 1;
+      if (undir)
+        adj[j][i] = 1;
+    }
+    graph<int> dense(adj), sparse(adj, EdgeStorage::SPARSE);
+    std::cout << (undir ? "Undirected" : "Directed") << " random graph with ";
+    std::cout << dense.num_edges() << " edges:" << std::endl;
+    check = true;
+    for (size_t src = 0; src < n; src += 37)
+      check = check && bfs_ok(dense, src, pool);
+    TEST_CHECK(check, "Distances and parents should be valid on 4 threads");
+    check = true;
+    for (size_t src = 0; src < n; src += 37)
+      check = check && bfs_ok(sparse, src, pool);
+    TEST_CHECK(check, "Sparse storage mode should give valid results");
+    check = true;
+    for (size_t src = 0; src < n; src += 37)
+      check = check && bfs_ok(dense, src, single);
+    TEST_CHECK(check, "Distances and parents should be valid on 1 thread");
+    std::cout << std::endl;
+  }
+
+  graph<int> chain = {0, 1, 2, 3, 4, 5};
+  chain.add_edge(0, 1);
+  chain.add_edge(1, 2);
+  chain.add_edge(2, 3);
+  chain.add_edge(4, 3);
+  dyn_array<dyn_array<int> > levels = chain.par_breadth_first(0, &pool);
+  std::cout << "Breadth-first levels of a chain with unreachable nodes: ";
+  std::cout << levels[0] << std::endl;
+  labels = {0, 1, 2, 3, -1, -1};
+  TEST_SEQ(levels[0], labels, 6, "Distances should count hops or be -1");
+  labels = {0, 0, 1, 2, -1, -1};
+  TEST_SEQ(levels[1], labels, 6, "Parents should follow the chain");
+  levels = chain.par_breadth_first(5);
+  TEST_EQUAL(levels[0][5], 0, "Isolated source should be at distance 0");
+  TEST_EQUAL(levels[0].max(), 0, "Nothing else should be reachable");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "INDEX-BASED TRAVERSAL TESTS" << std::endl << std::endl;
+
+  // Traversals of graph<T> run on index arrays, and should visit, print and
+  // return the same nodes as the hashed graph_node<T> engines of its nodes.
+  auto to_inds = [](const cgn_ptrs<int>& p) {
+    dyn_array<size_t> ret(0, p.size());
+    for (size_t i = 0; i < p.size(); ++i)
+      ret[i] = p[i]->ind();
+    return ret;
+  };
+  for (int undir = 0; undir < 2; ++undir) {
+    graph<int> rg(EdgeStorage::SPARSE);
+    for (size_t i = 0; i < 200; ++i)
+      rg.add_node(static_cast<int>(gen() % 50));
+    for (size_t e = 0; e < 300; ++e) {
+      size_t i = gen() % rg.size(), j = gen() % rg.size();
+      if (undir)
+        rg.add_edge_undir(i, j);
+      else
+        rg.add_edge(i, j);
+    }
+    std::cout << (undir ? "Undirected" : "Directed") << " random graph with ";
+    std::cout << rg.num_edges() << " edges:" << std::endl;
+    bool dft_eq = true, bft_eq = true, dfs_eq = true, bfs_eq = true;
+    bool bds_eq = true, out_eq = true;
+    for (size_t u = 0; u < rg.size(); u += 9) {
+      const graph_node<int>& node = rg[u];
+      std::ostringstream gr_os, gn_os;
+      dft_eq = dft_eq && rg.depth_first_traverse(u, &gr_os) ==
+                         to_inds(node.depth_first_traverse(&gn_os));
+      bft_eq = bft_eq && rg.breadth_first_traverse(u, &gr_os) ==
+                         to_inds(node.breadth_first_traverse(&gn_os));
+      dfs_eq = dfs_eq && rg.depth_first_search(u, 7, &gr_os) ==
+                         to_inds(node.depth_first_search(7, &gn_os));
+      bfs_eq = bfs_eq && rg.breadth_first_search(u, 7, &gr_os) ==
+                         to_inds(node.breadth_first_search(7, &gn_os));
+      if (undir) {
+        size_t v = (u * 31 + 5) % rg.size();
+        bds_eq = bds_eq && rg.bidirectional_search(u, v, &gr_os) ==
+                           to_inds(node.bidirectional_search(&rg[v], &gn_os));
+      }
+      out_eq = out_eq && gr_os.str() == gn_os.str();
+    }
+    TEST_CHECK(dft_eq, "Depth-first traversals should match");
+    TEST_CHECK(bft_eq, "Breadth-first traversals should match");
+    TEST_CHECK(dfs_eq, "Depth-first searches should match");
+    TEST_CHECK(bfs_eq, "Breadth-first searches should match");
+    if (undir)
+      TEST_CHECK(bds_eq, "Bidirectional searches should match");
+    TEST_CHECK(out_eq, "Printouts should match");
+    check = rg.has_cycle() == (rg.kahn().size() != rg.size());
+    TEST_CHECK(check, "Cycle detection should agree with Kahn's algorithm");
+    std::cout << std::endl;
+  }
+
+  // Acyclic graph where node i links to the next few nodes, so that
+  // topological orders have to respect index order.
+  graph<int> dag(EdgeStorage::SPARSE);
+  for (size_t i = 0; i < 100; ++i)
+    dag.add_node(static_cast<int>(i));
+  for (size_t i = 0; i < 100; ++i)
+    for (size_t j = i + 1; j < 100 && j < i + 4; ++j)
+      if (gen() % 2)
+        dag.add_edge(i, j);
+  std::cout << "Random acyclic graph with " << dag.num_edges() << " edges:";
+  std::cout << std::endl;
+  TEST_CHECK(!dag.has_cycle(), "Graph should have no cycles");
+  dyn_array<int> topo = dag.topological_sort();
+  check = topo.size() == dag.size();
+  for (size_t i = 0; check && i < topo.size(); ++i)
+    for (size_t n = 0; n < dag[topo[i]].degree(); ++n)
+      check = check && dag.weight(topo[i], dag[topo[i]](n)->ind()) &&
+              topo.search(dag[topo[i]](n)->val())[0] < i;
+  TEST_CHECK(check, "Post-order sort should finish nodes after successors");
+  dag.add_edge(60, 20);
+  TEST_CHECK(dag.has_cycle() == (dag.kahn().size() != dag.size()),
+             "Back edge should be caught like Kahn's algorithm does");
+  std::cout << std::endl;
+
+  // Explicit stacks keep long paths from overflowing the call stack.
+  const size_t big = 200000;
+  graph<int> path_g(EdgeStorage::SPARSE);
+  for (size_t i = 0; i < big; ++i)
+    path_g.add_node(static_cast<int>(i));
+  for (size_t i = 0; i + 1 < big; ++i)
+    path_g.add_edge(i, i + 1);
+  std::cout << "Directed path of " << big << " nodes:" << std::endl;
+  indices = path_g.depth_first_traverse(0);
+  check = indices.size() == big && indices[big-1] == big - 1;
+  TEST_CHECK(check, "Depth-first traverse should walk the whole path");
+  indices = path_g.depth_first_search(0, static_cast<int>(big - 1));
+  TEST_EQUAL(indices.size(), big, "Search should return the whole path");
+  TEST_CHECK(!path_g.has_cycle(), "Path should have no cycles");
+  TEST_EQUAL(path_g.topological_sort().size(), big, "Path should be sorted");
+  TEST_EQUAL(path_g.weakly_conn_comp().max(), 0, "Path should be 1 component");
+  TEST_EQUAL(path_g.strongly_conn_comp().size(), big,
+             "Every node of a directed path should be its own SCC");
+  path_g.add_edge(big - 1, 0);
+  TEST_CHECK(path_g.has_cycle(), "Closing the path should create a cycle");
+  TEST_EQUAL(path_g.strongly_conn_comp().size(), 1, "Cycle should be 1 SCC");
+  graph<int> und_path(EdgeStorage::SPARSE);
+  for (size_t i = 0; i < big; ++i)
+    und_path.add_node(static_cast<int>(i));
+  for (size_t i = 0; i + 1 < big; ++i)
+    und_path.add_edge_undir(i, i + 1);
+  std::cout << "Undirected path of " << big << " nodes:" << std::endl;
+  TEST_EQUAL(und_path.bridges().size(), big - 1, "Every link is a bridge");
+  TEST_EQUAL(und_path.articulation_points().size(), big - 2,
+             "Every inner node is an articulation point");
+
   test_util::print_summary();
   return 0;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <sstream>
 #include <string>
 #include "graph.h"
 #include "dyn_array.h"
@@ -921,6 +922,102 @@ int main()
   check = (inds.search(CHILE)[0] > inds.search(ARGENTINA)[0]);
   TEST_CHECK(check, "Chile should come after Argentina");
 
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "SPARSE EDGE STORAGE TESTS" << std::endl << std::endl;
+
+  // Same map in both storage modes, built from the same edge sequence so that
+  // adjacency lists match and every algorithm should return the same results.
+  graph<int> dense_map(stabilities);
+  graph<int> sparse_map(stabilities, EdgeStorage::SPARSE);
+  for (size_t i = 0; i < sym.size(); ++i) {
+    dense_map.add_edgew_undir(sym[i][0], sym[i][1], sym[i][2]);
+    sparse_map.add_edgew_undir(sym[i][0], sym[i][1], sym[i][2]);
+  }
+  for (size_t i = 0; i < asym.size(); ++i) {
+    dense_map.add_edgew(asym[i][0], asym[i][1], asym[i][2]);
+    sparse_map.add_edgew(asym[i][0], asym[i][1], asym[i][2]);
+  }
+
+  std::cout << "Twilight Struggle map without the edge matrix:" << std::endl;
+  check = dense_map.is_dense() && !sparse_map.is_dense();
+  TEST_CHECK(check, "Maps should report their storage modes");
+  graph<int> single(7);
+  TEST_EQUAL(single.size(), 1, "Single value should build a 1-node graph");
+  TEST_CHECK(single.is_dense(), "Single value graph should be dense");
+  TEST_EQUAL(sparse_map.num_edges(), dense_map.num_edges(),
+             "Edge counts should match");
+  TEST_CHECK(sparse_map.adj_mat() == dense_map.adj_mat(),
+             "Sparse map should rebuild the same weight matrix");
+  check = (sparse_map.weight(ECUADOR, COLOMBIA) == 1) &&
+          (sparse_map.weight(COLOMBIA, ECUADOR) == 2) &&
+          (sparse_map.weight(USSR, CANADA) == 0);
+  TEST_CHECK(check, "Edge weights should be looked up per direction");
+  TEST_CHECK(sparse_map == dense_map, "Maps should compare equal");
+
+  bool dij_eq = true, trav_eq = true, nbr_eq = true;
+  for (size_t u = 0; u < dense_map.size(); ++u) {
+    dij_eq = dij_eq && sparse_map.dijkstra(u) == dense_map.dijkstra(u);
+    trav_eq = trav_eq && sparse_map.depth_first_traverse(u) ==
+                         dense_map.depth_first_traverse(u);
+    nbr_eq = nbr_eq && sparse_map.neighbors(u) == dense_map.neighbors(u);
+  }
+  TEST_CHECK(dij_eq, "Dijkstra paths from every state should match");
+  TEST_CHECK(trav_eq, "Depth-first traversals should match");
+  TEST_CHECK(nbr_eq, "Neighbors should be listed in index order");
+  check = (sparse_map.find_roots() == dense_map.find_roots()) &&
+          (sparse_map.weakly_conn_comp() == dense_map.weakly_conn_comp()) &&
+          (sparse_map.strongly_conn_comp() == dense_map.strongly_conn_comp());
+  TEST_CHECK(check, "Roots and connected components should match");
+  check = (sparse_map.bridges() == dense_map.bridges()) &&
+          (sparse_map.articulation_points() ==
+           dense_map.articulation_points());
+  TEST_CHECK(check, "Bridges and articulation points should match");
+  TEST_EQUAL(sparse_map.kahn().size(), 2, "Kahn should stop after the roots");
+  std::ostringstream dense_os, sparse_os;
+  dense_map.print_adj_matrix(dense_os);
+  sparse_map.print_adj_matrix(sparse_os);
+  TEST_EQUAL(sparse_os.str(), dense_os.str(), "Matrix printouts should match");
+  std::cout << std::endl;
+
+  graph<int> dense_copy(dense_map), sparse_copy(sparse_map);
+  std::cout << "Copied maps in both storage modes:" << std::endl;
+  TEST_CHECK(!sparse_copy.is_dense(), "Copies should keep the storage mode");
+  check = (sparse_copy.adj_mat() == sparse_map.adj_mat()) &&
+          (dense_copy.adj_mat() == dense_map.adj_mat());
+  TEST_CHECK(check, "Copies should keep edge weights");
+  dense_copy = sparse_map;
+  TEST_CHECK(!dense_copy.is_dense(), "Assignment should take the source mode");
+  std::cout << std::endl;
+
+  std::cout << "Added, removed and reweighted states and links:" << std::endl;
+  size_t dense_ind = dense_map.add_node(2);
+  size_t sparse_ind = sparse_map.add_node(2);
+  TEST_EQUAL(sparse_ind, dense_ind, "Added states should get the same index");
+  dense_map.add_edgew_undir(dense_ind, USA, 4);
+  sparse_map.add_edgew_undir(sparse_ind, USA, 4);
+  dense_map.add_edgew(EAST_GERMANY, POLAND, 1);
+  sparse_map.add_edgew(EAST_GERMANY, POLAND, 1);
+  TEST_EQUAL(sparse_map.weight(EAST_GERMANY, POLAND), 1,
+             "Existing links should be reweighted");
+  TEST_EQUAL(sparse_map.num_edges(), dense_map.num_edges(),
+             "Reweighting should not duplicate links");
+  check = dense_map.remove_edge_undir(HUNGARY, AUSTRIA) &&
+          sparse_map.remove_edge_undir(HUNGARY, AUSTRIA) &&
+          !sparse_map.remove_edge(HUNGARY, AUSTRIA);
+  TEST_CHECK(check, "Links should only be removed once");
+  check = dense_map.remove_node(POLAND) && sparse_map.remove_node(POLAND);
+  TEST_CHECK(check, "Poland should be removed in both modes");
+  TEST_EQUAL(sparse_map.size(), 86, "Map should have 86 states again");
+  TEST_CHECK(sparse_map.adj_mat() == dense_map.adj_mat(),
+             "Weight matrices should match after the changes");
+  check = (sparse_map.dijkstra(USSR) == dense_map.dijkstra(USSR)) &&
+          (sparse_map.dijkstra(USA) == dense_map.dijkstra(USA));
+  TEST_CHECK(check, "Dijkstra paths from the players should match");
+  sparse_map.clear_edges();
+  check = (sparse_map.num_edges() == 0) && (sparse_map.find_roots().size() ==
+                                             sparse_map.size());
+  TEST_CHECK(check, "Cleared map should only hold roots");
+
   test_util::print_summary();
   return 0;
 }
\ No newline at end of file
@@ -217,6 +217,239 @@ int main()
   }
   TEST_CHECK(contains_all, "Hash should contain characters [49-255)");
 
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "HASH TABLE WITH INCREMENTAL GROWTH" << std::endl;
+
+  hash_table<int, int> ht7(11);
+  for (int i = 0; i < 12; ++i)
+    ht7.insert(i * 3, i);
+  std::cout << "Inserted 12 keys to a table of size 11" << std::endl;
+  TEST_EQUAL(ht7.size(), 23, "Table should have grown to size 23");
+  TEST_EQUAL(ht7.count(), 12, "Table should have 12 keys");
+  contains_all = true;
+  for (int i = 0; i < 12; ++i) {
+    if (!ht7.contains(i * 3) || ht7[i * 3] != i) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "Keys should be found while migrating buckets");
+  for (int i = 12; i < 20000; ++i)
+    ht7.insert(i * 3, i);
+  ht7.insert(0, -1).remove(3).remove(6);
+  std::cout << "Inserted 19988 more keys, updated one and removed two";
+  std::cout << std::endl;
+  TEST_EQUAL(ht7.count(), 19998, "Table should have 19998 keys");
+  TEST_CHECK(ht7.load_factor() <= 1.0f, "Load factor should stay below 1");
+  TEST_EQUAL(ht7[0], -1, "Updated key should have its new value");
+  contains_all = true;
+  for (int i = 3; i < 20000; ++i) {
+    if (!ht7.contains(i * 3) || ht7[i * 3] != i) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "Table should contain all the remaining keys");
+  TEST_EQUAL(ht7.contains(3), 0, "Removed key 3 should be gone");
+  TEST_EQUAL(ht7.contains(1), 0, "Table shouldn't have key 1");
+  TEST_EQUAL(ht7.keys().size(), 19998, "Table should have 19998 keys");
+
+  hash_table<int, int> ht8(11);
+  ht8.set_max_load(0);
+  for (int i = 0; i < 100; ++i)
+    ht8.insert(i, i);
+  std::cout << "Inserted 100 keys with growth disabled" << std::endl;
+  TEST_EQUAL(ht8.size(), 11, "Table shouldn't grow with max load 0");
+  TEST_EQUAL(ht8.count(), 100, "Table should have 100 keys");
+  ht8.clear();
+  TEST_EQUAL(ht8.count(), 0, "Cleared table should have no keys");
+
+  hash_table<int, int> ht8s(11);
+  ht8s.set_max_load(0.05f);
+  for (int i = 0; i < 5000; ++i)
+    ht8s.insert(i, i);
+  std::cout << "Inserted 5000 keys with max load 0.05" << std::endl;
+  TEST_CHECK(ht8s.load_factor() <= 0.05f, "Load factor should stay low");
+  contains_all = true;
+  for (int i = 0; i < 5000; ++i) {
+    if (!ht8s.contains(i) || ht8s[i] != i) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "Low max load table should contain all keys");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "HASH TABLE WITH WIDE HASH POLICY" << std::endl;
+
+  hash_table<int, int> ht9(11, WIDE, 1);
+  hash_table<int, int> ht10(11, WIDE, 2);
+  for (int i = 0; i < 10000; ++i) {
+    ht9.insert(i, -i);
+    ht10.insert(i, -i);
+  }
+  std::cout << "Inserted 10000 sequential keys to tables with seeds 1 and 2";
+  std::cout << std::endl;
+  TEST_EQUAL(ht9.count(), 10000, "Table should have 10000 keys");
+  contains_all = true;
+  for (int i = 0; i < 10000; ++i) {
+    if (!ht9.contains(i) || ht10[i] != -i) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "Seeded tables should contain all keys");
+  TEST_EQUAL(ht9.contains(10000), 0, "Table shouldn't have key 10000");
+  TEST_CHECK(ht9.hash_code(42) != ht10.hash_code(42),
+             "Different seeds should give different hashes");
+  hash_table<int, int> ht9_same(11, WIDE, 1);
+  TEST_EQUAL(ht9_same.hash_code(42), ht9.hash_code(42),
+             "Same seed should give the same hash");
+
+  // Cover the short, medium and long code paths of the string hash.
+  hash_table<std::string, size_t> ht11(101, WIDE, 7);
+  std::string letters;
+  for (size_t i = 0; i < 200; ++i) {
+    ht11.insert(letters, i);
+    letters += static_cast<char>('a' + (i % 26));
+  }
+  std::cout << "Inserted 200 strings of lengths 0 to 199" << std::endl;
+  TEST_EQUAL(ht11.count(), 200, "Table should have 200 string keys");
+  contains_all = true;
+  letters.clear();
+  for (size_t i = 0; i < 200; ++i) {
+    if (!ht11.contains(letters) || ht11[letters] != i) {
+      contains_all = false;
+      break;
+    }
+    letters += static_cast<char>('a' + (i % 26));
+  }
+  TEST_CHECK(contains_all, "Every string length should hash consistently");
+  letters[150] = 'Z';
+  TEST_EQUAL(ht11.contains(letters), 0, "Changed string shouldn't be found");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "HASH TABLE WITH POOLED ENTRIES" << std::endl;
+
+  hash_table<int, int> ht12(11);
+  ht12.use_pool(true);
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 5000; ++i)
+      ht12.insert(i, i + round);
+    for (int i = 0; i < 5000; i += 2)
+      ht12.remove(i);
+  }
+  std::cout << "Inserted 5000 keys and removed half of them three times";
+  std::cout << std::endl;
+  TEST_EQUAL(ht12.count(), 2500, "Pooled table should have 2500 keys");
+  contains_all = true;
+  for (int i = 0; i < 5000; ++i) {
+    if (ht12.contains(i) != (i % 2 == 1) || (i % 2 && ht12[i] != i + 2)) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "Pooled table should keep the odd keys");
+  std::cout << "Trying to disable the pool of a non-empty table" << std::endl;
+  ht12.use_pool(false);
+  ht12.clear();
+  TEST_EQUAL(ht12.count(), 0, "Cleared pooled table should be empty");
+  ht12.insert(7, 7);
+  TEST_EQUAL(ht12[7], 7, "Cleared pooled table should accept new keys");
+
+  hash_table<std::string, std::string> ht13;
+  ht13.use_pool(true);
+  for (int i = 0; i < 1000; ++i)
+    ht13.insert("key " + std::to_string(i), std::string(100, 'v'));
+  for (int i = 0; i < 1000; i += 3)
+    ht13.remove("key " + std::to_string(i));
+  std::cout << "Churned 1000 pooled std::string entries" << std::endl;
+  TEST_EQUAL(ht13.count(), 666, "Pooled string table should have 666 keys");
+  TEST_CHECK(ht13.contains("key 1") && !ht13.contains("key 0"),
+             "Pooled string table should have the right keys");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "HASH TABLE WITH BATCH LOOKUPS" << std::endl;
+
+  hash_table<int, int> ht14(11);
+  for (int i = 0; i < 1000; ++i)
+    ht14.insert(i * 3, i);
+  dyn_array<int> batch(0, 100);
+  for (size_t i = 0; i < batch.size(); ++i)
+    batch[i] = static_cast<int>(i) * 5;
+  std::cout << "Looking up 100 multiples of 5 among 1000 multiples of 3";
+  std::cout << std::endl;
+  dyn_array<int*> batch_vals;
+  TEST_EQUAL(ht14.find_many(batch, batch_vals), 34,
+             "find_many should find 34 multiples of 15");
+  TEST_EQUAL(batch_vals.size(), 100, "find_many should size its output");
+  bool batch_ok = true;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    bool present = batch[i] % 3 == 0;
+    if ((batch_vals[i] != nullptr) != present ||
+        (present && *batch_vals[i] != batch[i] / 3)) {
+      batch_ok = false;
+      break;
+    }
+  }
+  TEST_CHECK(batch_ok, "find_many should point to the right values");
+  *batch_vals[3] = -1;
+  TEST_EQUAL(ht14[15], -1, "find_many pointers should refer to the table");
+  dyn_array<bool> batch_found(false, 100);
+  TEST_EQUAL(ht14.contains_many(batch, batch_found), 34,
+             "contains_many should find 34 multiples of 15");
+  batch_ok = true;
+  for (size_t i = 0; i < batch.size(); ++i)
+    batch_ok = batch_ok && batch_found[i] == (batch[i] % 3 == 0);
+  TEST_CHECK(batch_ok, "contains_many should flag the right keys");
+  dyn_array<int> no_keys;
+  TEST_EQUAL(ht14.contains_many(no_keys, batch_found), 0,
+             "Empty batch should find nothing");
+  TEST_EQUAL(batch_found.size(), 0, "Empty batch should empty the output");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "HASH TABLE ITERATION" << std::endl;
+
+  hash_table<int, int> ht15(11);
+  TEST_CHECK(ht15.begin() == ht15.end(), "Empty table should have no entries");
+  for (int i = 0; i < 1000; ++i)
+    ht15.insert(i, 2 * i);
+  std::cout << "Inserted 1000 keys to a growing table of size 11" << std::endl;
+  size_t visited = 0;
+  long long key_sum = 0;
+  bool iter_ok = true;
+  for (const hash_node<int, int>& hn : ht15) {
+    visited++;
+    key_sum += hn.key_;
+    iter_ok = iter_ok && hn.val_ == 2 * hn.key_;
+  }
+  TEST_EQUAL(visited, 1000, "Range-for should visit every entry once");
+  TEST_EQUAL(key_sum, 499500, "Range-for should visit every key");
+  TEST_CHECK(iter_ok, "Range-for should pair keys with their values");
+  for (hash_table<int, int>::iterator it = ht15.begin(); it != ht15.end(); ++it)
+    it->val_ += 1;
+  TEST_EQUAL(ht15[10], 21, "Values should be writable through iterators");
+  const hash_table<int, int>& cht15 = ht15;
+  visited = 0;
+  for (hash_table<int, int>::const_iterator it = cht15.begin();
+       it != cht15.end(); it++) {
+    if (ht15.contains(it->key_))
+      visited++;
+  }
+  TEST_EQUAL(visited, 1000, "Lookups shouldn't disturb const iteration");
+  long long val_sum = 0;
+  ht15.visit([&val_sum](const int& key, int& val) {
+    val -= 1;
+    val_sum += val - key;
+  });
+  TEST_EQUAL(val_sum, 499500, "visit should pass every key and value");
+  visited = 0;
+  cht15.visit([&visited](const int& key, const int& val) {
+    if (val == 2 * key)
+      visited++;
+  });
+  TEST_EQUAL(visited, 1000, "visit should see values updated by visit");
+
   test_util::print_summary();
   return 0;
 }
\ No newline at end of file
@@ -41,6 +41,72 @@ int main()
   std::cout << "Removed the same key marked with value 'x'" << std::endl;
   TEST_EQUAL(ht4.contains(perms[0]), 0, "Removed key should be gone");
 
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "HASH TABLE WITH NESTED AND POINTER dyn_array KEYS" << std::endl;
+
+  hash_table<dyn_array<dyn_array<int> >, size_t> ht4n(11);
+  for (size_t i = 0; i + 1 < perms.size(); ++i) {
+    dyn_array<dyn_array<int> > pair = {perms[i], perms[i + 1]};
+    ht4n.insert(pair, i);
+  }
+  std::cout << "Hashed pairs of consecutive permutations" << std::endl;
+  TEST_EQUAL(ht4n.count(), 119, "Hash should have 119 nested keys");
+  dyn_array<dyn_array<int> > pair_copy = {perms[5], perms[6]};
+  TEST_EQUAL(ht4n[pair_copy], 5, "Rebuilt nested key should map to 5");
+  dyn_array<dyn_array<int> > pair_swap = {perms[6], perms[5]};
+  TEST_EQUAL(ht4n.contains(pair_swap), 0, "Swapped nested key is different");
+
+  int vals_a[3] = {4, 8, 15};
+  int vals_b[3] = {4, 8, 15};
+  dyn_array<int*> ptrs_a = {&vals_a[0], &vals_a[1], &vals_a[2]};
+  dyn_array<int*> ptrs_b = {&vals_b[0], &vals_b[1], &vals_b[2]};
+  hash_table<dyn_array<int*>, char> ht4p;
+  ht4p.insert(ptrs_a, 'a');
+  std::cout << "Hashed pointers to " << vals_a[0] << ", " << vals_a[1];
+  std::cout << ", " << vals_a[2] << std::endl;
+  TEST_CHECK(ht4p.contains(ptrs_b), "Pointers to equal values are equal keys");
+  vals_b[2] = 16;
+  TEST_EQUAL(ht4p.contains(ptrs_b), 0, "Pointers to other values aren't");
+
+  dyn_array<unsigned long long> codes(0ULL, perms.size());
+  for (size_t i = 0; i < perms.size(); ++i)
+    codes[i] = ht4.hash_code(perms[i]);
+  hash_table<dyn_array<int>, size_t> ht4h(7);
+  for (size_t i = 0; i < perms.size(); ++i)
+    ht4h.insert(perms[i], i, codes[i]);
+  std::cout << "Hashed all permutations with precomputed hash codes";
+  std::cout << std::endl;
+  TEST_EQUAL(ht4h.count(), 120, "Hash should have 120 keys");
+  contains_all = true;
+  for (size_t i = 0; i < perms.size(); ++i) {
+    if (!ht4h.contains(perms[i], codes[i]) || ht4h[perms[i]] != i) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "Precomputed hashes should find all keys");
+  TEST_EQUAL(ht4h.hash_code(perms[7]), codes[7], "Hash codes should agree");
+  ht4h.remove(perms[7]);
+  TEST_EQUAL(ht4h.contains(perms[7], codes[7]), 0, "Removed key is gone");
+  TEST_EQUAL(ht4h.count(), 119, "Hash should have 119 keys left");
+  ht4h.remove(perms[8], codes[8]);
+  TEST_EQUAL(ht4h.contains(perms[8]), 0, "Removed by hash code is gone too");
+  TEST_EQUAL(ht4h.count(), 118, "Hash should have 118 keys left");
+
+  hash_table<dyn_array<int>, size_t> ht4w(7, WIDE, 12345);
+  for (size_t i = 0; i < perms.size(); ++i)
+    ht4w.insert(perms[i], i);
+  std::cout << "Hashed all permutations with the seeded WIDE policy";
+  std::cout << std::endl;
+  contains_all = ht4w.count() == perms.size();
+  for (size_t i = 0; i < perms.size(); ++i) {
+    if (ht4w[perms[i]] != i) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "WIDE policy should find all container keys");
+
   std::cout << "----------------------------------------------" << std::endl;
   std::cout << "HASH TABLE WITH node<int, false> KEYS" << std::endl;
 
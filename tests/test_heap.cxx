@@ -478,6 +478,72 @@ int main()
   TEST_CHECK(max_hp.is_empty(), "Max heap should now be empty");
   TEST_SEQ(rem2, max_gt, 70, "Removals should be sorted in decreasing order");
 
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "INDEXED 4-ARY HEAP TESTS" << std::endl << std::endl;
+
+  index_heap<int> ih(10);
+  std::cout << "Created an empty indexed min heap for 10 ids" << std::endl;
+  TEST_CHECK(ih.is_empty(), "Indexed heap should initially be empty");
+  TEST_EQUAL(ih.capacity(), 10, "Indexed heap should hold 10 ids");
+  int ih_keys[] = {50, 20, 70, 20, 90, 40, 30};
+  for (size_t id = 0; id < 7; ++id)
+    ih.insert(id, ih_keys[id]);
+  std::cout << "Inserted ids 0-6 with keys 50 20 70 20 90 40 30" << std::endl;
+  TEST_EQUAL(ih.size(), 7, "Indexed heap should hold 7 ids");
+  TEST_EQUAL(ih.peek(), 1, "Smaller id should win a tie for the root");
+  TEST_CHECK(!ih.insert(3, 10), "Queued ids should not be inserted twice");
+  TEST_CHECK(!ih.insert(10, 10), "Out-of-range ids should not be inserted");
+  TEST_CHECK(ih.decrease_key(4, 10), "Key of id 4 should decrease to 10");
+  TEST_EQUAL(ih.peek(), 4, "Decreased id should move up to the root");
+  TEST_CHECK(!ih.decrease_key(2, 80), "Larger keys should not be accepted");
+  TEST_CHECK(!ih.decrease_key(8, 5), "Ids that aren't queued can't decrease");
+  std::cout << "Removed: ";
+  dyn_array<size_t> ih_rem, ih_gt = {4, 1, 3, 6, 5, 0, 2};
+  while (!ih.is_empty()) {
+    ih_rem.add(ih.remove());
+    std::cout << ih_rem.last() << "(" << ih.key(ih_rem.last()) << ") ";
+  }
+  std::cout << std::endl;
+  TEST_SEQ(ih_rem, ih_gt, 7, "Ids should be removed in key order");
+  TEST_CHECK(!ih.contains(4), "Removed ids should not be queued");
+  TEST_CHECK(ih.push(4, 60) && ih.contains(4), "Push should queue id 4 again");
+  TEST_CHECK(ih.push(4, 15) && ih.key(4) == 15, "Push should decrease keys");
+  std::cout << std::endl;
+
+  index_heap<int> ih_max(10, true);
+  for (size_t id = 0; id < 7; ++id)
+    ih_max.insert(id, ih_keys[id]);
+  std::cout << "Inserted the same ids into an indexed max heap" << std::endl;
+  TEST_EQUAL(ih_max.peek(), 4, "Largest key should be at the root");
+  TEST_CHECK(ih_max.decrease_key(1, 95), "Max heaps should accept larger keys");
+  TEST_EQUAL(ih_max.remove(), 1, "Increased id should be removed first");
+
+  // Random pushes on a large heap, checked against a brute-force minimum.
+  std::mt19937 ih_gen(7);
+  const size_t ih_n = 2000;
+  index_heap<int> ih_big(ih_n);
+  dyn_array<int> best(-1, ih_n);
+  for (size_t i = 0; i < 4 * ih_n; ++i) {
+    size_t id = ih_gen() % ih_n;
+    int key = static_cast<int>(ih_gen() % 100000);
+    if (best[id] == -1 || key < best[id]) {
+      best[id] = key;
+      ih_big.push(id, key);
+    }
+  }
+  bool ih_ok = true;
+  int prev = -1;
+  size_t popped = 0;
+  while (!ih_big.is_empty()) {
+    size_t id = ih_big.remove();
+    ih_ok = ih_ok && ih_big.key(id) == best[id] && ih_big.key(id) >= prev;
+    prev = ih_big.key(id);
+    popped++;
+  }
+  std::cout << "Pushed random keys for 2000 ids" << std::endl;
+  TEST_EQUAL(popped, ih_n - best.search(-1).size(), "Each id pops once");
+  TEST_CHECK(ih_ok, "Ids should pop in key order with their minimum keys");
+
   std::cout << "----------------------------------------------" << std::endl;
   std::cout << "HEAP TREE ASSIGNMENT TESTS" << std::endl << std::endl;
 
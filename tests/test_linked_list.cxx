@@ -1066,6 +1066,31 @@ int main()
   gtit.selection_sort(false);
   TEST_LIST_SEQ(it, gtit, 7, "Should match dyn_array result");
 
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "NODE POOL" << std::endl;
+
+  node_pool<std::string, true> pool;
+  node<std::string, true>* pooled = pool.create("zero");
+  for (int i = 1; i < 100; ++i)
+    pooled->prepend_node(pool.create(std::to_string(i)));
+  pooled = pooled->find_head();
+  std::cout << "Created a chain of 100 pooled nodes" << std::endl;
+  TEST_EQUAL(pool.live(), 100, "Pool should have 100 nodes in use");
+  TEST_EQUAL(pooled->size(), 100, "Pooled chain should have 100 nodes");
+  TEST_EQUAL(pooled->val(), "99", "Pooled chain head should be 99");
+  node<std::string, true>* second = pooled->next();
+  second->prev() = nullptr;
+  pool.destroy(pooled);
+  std::cout << "Destroyed the head of the chain" << std::endl;
+  TEST_EQUAL(pool.live(), 99, "Pool should have 99 nodes in use");
+  node<std::string, true>* recycled = pool.create("recycled");
+  TEST_CHECK(recycled == pooled, "Destroyed node's memory should be reused");
+  pool.destroy_chain(second);
+  pool.destroy(recycled);
+  std::cout << "Destroyed the rest of the chain" << std::endl;
+  TEST_EQUAL(pool.live(), 0, "Pool should have no nodes in use");
+  pool.release();
+
   test_util::print_summary();
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <cstring>
+#include "test_util.h"
+#include "open_hash_table.h"
+
+int main()
+{
+  bool contains_all;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "OPEN HASH TABLE WITH std::string KEYS" << std::endl << std::endl;
+
+  std::string borges[6];
+  borges[0] = "The universe (which others call the Library) is composed of ";
+  borges[1] = "an indefinite and perhaps infinite number of hexagonal ";
+  borges[2] = "galleries, with vast air shafts between, surrounded by very ";
+  borges[3] = "low railings. From any of the hexagons one can see, ";
+  borges[4] = "interminably, the upper and lower floors. The distribution ";
+  borges[5] = "of the galleries is invariable.";
+
+  open_hash_table<std::string, int> ht1;
+  std::string str;
+  for (unsigned i = 0; i < 6; ++i) {
+    std::cout << borges[i] << std::endl;
+    std::stringstream ss(borges[i].c_str());
+    int v = 0;
+    while (ss >> str)
+      ht1.insert(str, (1000*i) + (v++));
+  }
+  std::cout << std::endl << "Hash contents: " << std::endl << ht1 << std::endl;
+  TEST_CHECK(ht1.contains("hexagonal"), "Hash should contain \"hexagonal\"");
+  TEST_EQUAL(ht1["hexagonal"], 1007, "Key \"hexagonal\" should be 1007");
+  TEST_EQUAL(ht1["the"], 5001, "Duplicate key \"the\" should be 5001");
+  TEST_EQUAL(ht1.contains("Babel"), 0, "Shouldn't have key \"Babel\"");
+  TEST_EQUAL(ht1.count(), 41, "Hash should have 41 std::string keys");
+  TEST_EQUAL(ht1.keys().size(), 41, "Hash should have 41 std::string keys");
+  TEST_EQUAL(ht1.vals().size(), 41, "Hash should have 41 int values");
+  TEST_EQUAL(ht1.size(), 64, "Hash should have grown to 64 slots");
+
+  ht1.remove("hexagonal").remove("the").remove("of").remove("Library)");
+  std::cout << "Removed \"hexagonal\", \"the\", \"of\" and \"Library)\"";
+  std::cout << std::endl;
+  TEST_EQUAL(ht1.contains("hexagonal"), 0, "Shouldn't have key \"hexagonal\"");
+  TEST_EQUAL(ht1.contains("the"), 0, "Hash shouldn't have key \"the\"");
+  TEST_EQUAL(ht1.count(), 37, "There should be 37 keys left");
+  TEST_EQUAL(ht1.keys().size(), 37, "There should be 37 keys left");
+  contains_all = true;
+  for (unsigned i = 0; i < 6; ++i) {
+    std::stringstream ss(borges[i].c_str());
+    while (ss >> str) {
+      bool removed = str == "hexagonal" || str == "the" || str == "of" ||
+                     str == "Library)";
+      if (ht1.contains(str) == removed)
+        contains_all = false;
+    }
+  }
+  TEST_CHECK(contains_all, "Remaining keys should survive backward shifts");
+
+  std::cout << "Trying to remove \"the\" and \"mirror\"" << std::endl;
+  ht1.remove("the").remove("mirror");
+  TEST_EQUAL(ht1.count(), 37, "There should still be 37 keys");
+
+  open_hash_table<std::string, int> ht1_copy(ht1);
+  ht1.clear();
+  std::cout << "Copied the table, then cleared the original" << std::endl;
+  TEST_EQUAL(ht1.count(), 0, "Cleared table should be empty");
+  TEST_EQUAL(ht1.size(), 64, "Cleared table should keep its capacity");
+  TEST_EQUAL(ht1.contains("galleries,"), 0, "Cleared table has no keys");
+  TEST_EQUAL(ht1_copy.count(), 37, "Copy should have 37 keys");
+  TEST_EQUAL(ht1_copy["galleries,"], 2000, "Copy should keep the values");
+  ht1 = ht1_copy;
+  TEST_EQUAL(ht1.count(), 37, "Assigned table should have 37 keys");
+  TEST_EQUAL(ht1["invariable."], 5004, "Assigned table should have values");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "OPEN HASH TABLE WITH int KEYS" << std::endl;
+
+  open_hash_table<int, int> ht2;
+  for (int i = -50000; i < 50000; ++i)
+    ht2.insert(i * 7, i);
+  std::cout << "Inserted 100000 multiples of 7 with their factors" << std::endl;
+  TEST_EQUAL(ht2.count(), 100000, "Hash should have 100000 keys");
+  TEST_EQUAL(ht2.size(), 131072, "Hash should have grown to 131072 slots");
+  contains_all = true;
+  for (int i = -50000; i < 50000; ++i) {
+    if (!ht2.contains(i * 7) || ht2[i * 7] != i) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "Hash should map every key to its factor");
+  TEST_EQUAL(ht2.contains(12), 0, "Shouldn't have key 12");
+  TEST_EQUAL(ht2.contains(350000), 0, "Shouldn't have key 350000");
+
+  for (int i = -50000; i < 50000; i += 2)
+    ht2.remove(i * 7);
+  std::cout << "Removed every other key" << std::endl;
+  TEST_EQUAL(ht2.count(), 50000, "Hash should have 50000 keys left");
+  contains_all = true;
+  for (int i = -50000; i < 50000; ++i) {
+    if (ht2.contains(i * 7) != ((i % 2) != 0)) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "Hash should contain exactly the odd factors");
+
+  open_hash_table<int, int> ht3(1000);
+  TEST_EQUAL(ht3.size(), 1024, "Capacity should round up to 1024");
+  ht3.reserve(1000);
+  TEST_EQUAL(ht3.size(), 2048, "Reserving 1000 entries should need 2048");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "OPEN HASH TABLE WITH uintptr_t POINTER KEYS" << std::endl;
+
+  dyn_array<node<int, false>*> nodes(nullptr, 500);
+  for (size_t i = 0; i < nodes.size(); ++i)
+    nodes[i] = node<int, false>::create(static_cast<int>(i));
+  open_hash_table<uintptr_t, int> ht4(16, MURMUR);
+  for (size_t i = 0; i < nodes.size(); ++i)
+    ht4.insert(reinterpret_cast<uintptr_t>(nodes[i]), nodes[i]->val());
+  std::cout << "Hashed 500 nodes by pointer" << std::endl;
+  TEST_EQUAL(ht4.count(), 500, "Hash should have 500 node pointers");
+  contains_all = true;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (ht4[reinterpret_cast<uintptr_t>(nodes[i])] != static_cast<int>(i)) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "Hash should map node pointers to their values");
+  for (size_t i = 0; i < nodes.size(); ++i)
+    delete nodes[i];
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "OPEN HASH TABLE WITH double KEYS" << std::endl;
+
+  open_hash_table<double, uint64_t> ht5;
+  uint64_t dval;
+  for (double i = 0; i < 200; ++i) {
+    double key = i*1e-15;
+    std::memcpy(&dval, &key, sizeof(key));
+    ht5.insert(key, dval);
+  }
+  std::cout << "Hashed 200 multiples of 1e-15 with bit patterns" << std::endl;
+  TEST_EQUAL(ht5.count(), 200, "Hash should have 200 double keys");
+  contains_all = true;
+  for (double i = 0; i < 200; ++i) {
+    if (!ht5.contains(i*1e-15)) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "Hash should contain each distinct double inserted");
+  TEST_EQUAL(ht5.contains(2e-13), 0, "Hash shouldn't contain 2e-13");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "OPEN HASH TABLE WITH dyn_array<int> KEYS" << std::endl;
+
+  dyn_array<int> primes = {2, 3, 5, 7, 11};
+  dyn_array<dyn_array<int> > perms = primes.permutations();
+  open_hash_table<dyn_array<int>, size_t> ht6;
+  for (size_t i = 0; i < perms.size(); ++i)
+    ht6.insert(perms[i], i);
+  std::cout << "Hashed all permutations of: " << primes << std::endl;
+  TEST_EQUAL(ht6.count(), 120, "Hash should have 120 keys");
+  contains_all = true;
+  for (size_t i = 0; i < perms.size(); ++i) {
+    if (ht6[perms[i]] != i) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "Hash should map all permutations to indices");
+  ht6.remove(perms[0]);
+  TEST_EQUAL(ht6.contains(perms[0]), 0, "Removed key should be gone");
+  TEST_EQUAL(ht6.count(), 119, "Hash should have 119 keys left");
+  unsigned long long code = ht6.hash_code(perms[1]);
+  TEST_CHECK(ht6.contains(perms[1], code), "Precomputed hash should find key");
+  ht6.insert(perms[0], 0, ht6.hash_code(perms[0]));
+  TEST_EQUAL(ht6[perms[0]], 0, "Precomputed hash insert should add key");
+  dyn_array<dyn_array<int> > batch(perms[0], 3);
+  batch[1] = primes;
+  batch[2] = {2, 3, 5};
+  dyn_array<size_t*> batch_vals;
+  TEST_EQUAL(ht6.find_many(batch, batch_vals), 2,
+             "find_many should find two of three keys");
+  TEST_CHECK(batch_vals[0] && *batch_vals[0] == 0 && batch_vals[1] &&
+             *batch_vals[1] == ht6[primes] && !batch_vals[2],
+             "find_many should point to the right values");
+  dyn_array<bool> batch_found;
+  TEST_EQUAL(ht6.contains_many(batch, batch_found), 2,
+             "contains_many should find two of three keys");
+  TEST_CHECK(batch_found[0] && batch_found[1] && !batch_found[2],
+             "contains_many should flag the right keys");
+
+  test_util::print_summary();
+  return 0;
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "test_util.h"
+#include "sharded_hash_table.h"
+
+int main()
+{
+  bool contains_all;
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "SHARDED HASH TABLE WITH std::string KEYS" << std::endl;
+
+  sharded_hash_table<std::string, int> ht1(100, 6);
+  TEST_EQUAL(ht1.shards(), 8, "Shard count should round up to 8");
+  ht1.insert("alpha", 1).insert("beta", 2).insert("gamma", 3);
+  ht1.insert("beta", 20);
+  std::cout << "Inserted \"alpha\", \"beta\" and \"gamma\", updated \"beta\"";
+  std::cout << std::endl;
+  TEST_EQUAL(ht1.count(), 3, "Table should have 3 keys");
+  TEST_EQUAL(ht1["beta"], 20, "Updated key should have the new value");
+  int val = 0;
+  TEST_CHECK(ht1.find("gamma", val) && val == 3, "find should copy the value");
+  TEST_CHECK(!ht1.find("delta", val), "find shouldn't find a missing key");
+  ht1.remove("alpha");
+  TEST_EQUAL(ht1.contains("alpha"), 0, "Removed key should be gone");
+  std::cout << "Trying to remove \"alpha\" again" << std::endl;
+  ht1.remove("alpha");
+  dyn_array<std::string> keys = ht1.keys();
+  dyn_array<int> vals = ht1.vals();
+  TEST_EQUAL(keys.size(), 2, "keys should return 2 keys");
+  TEST_EQUAL(vals.size(), 2, "vals should return 2 values");
+  TEST_CHECK(vals[0] + vals[1] == 23, "vals should return the right values");
+  ht1.clear();
+  TEST_EQUAL(ht1.count(), 0, "Cleared table should be empty");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "SHARDED HASH TABLE WITH CONCURRENT WRITERS" << std::endl;
+
+  const int n_threads = 8;
+  const int per_thread = 20000;
+  sharded_hash_table<int, int> ht2;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < n_threads; ++t) {
+    workers.push_back(std::thread([&ht2, t, per_thread]() {
+      for (int i = t * per_thread; i < (t + 1) * per_thread; ++i)
+        ht2.insert(i, -i);
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); ++t)
+    workers[t].join();
+  std::cout << "8 threads inserted 20000 disjoint keys each" << std::endl;
+  TEST_EQUAL(ht2.count(), n_threads * per_thread, "Table should have all keys");
+  contains_all = true;
+  for (int i = 0; i < n_threads * per_thread; ++i) {
+    if (ht2[i] != -i) {
+      contains_all = false;
+      break;
+    }
+  }
+  TEST_CHECK(contains_all, "All inserted keys should have their values");
+
+  // Half of the threads remove their even keys while the other half keep
+  // reading their odd keys, which nobody removes.
+  workers.clear();
+  std::vector<int> misses(n_threads, 0);
+  for (int t = 0; t < n_threads; ++t) {
+    workers.push_back(std::thread([&ht2, &misses, t, per_thread]() {
+      for (int i = t * per_thread; i < (t + 1) * per_thread; ++i) {
+        if (t % 2 == 0 && i % 2 == 0)
+          ht2.remove(i);
+        else if (i % 2 == 1 && !ht2.contains(i))
+          misses[t]++;
+      }
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); ++t)
+    workers[t].join();
+  std::cout << "4 threads removed even keys while 8 threads read odd keys";
+  std::cout << std::endl;
+  int total_misses = 0;
+  for (int t = 0; t < n_threads; ++t)
+    total_misses += misses[t];
+  TEST_EQUAL(total_misses, 0, "Readers should find every odd key");
+  TEST_EQUAL(ht2.count(), n_threads * per_thread * 3 / 4,
+             "Table should have 3/4 of the keys left");
+  TEST_EQUAL(ht2.contains(2), 0, "Removed key should be gone");
+  TEST_EQUAL(ht2.contains(per_thread + 2), 1, "Kept key should be found");
+
+  std::cout << "----------------------------------------------" << std::endl;
+  std::cout << "SHARDED HASH TABLE WITH WIDE HASH POLICY" << std::endl;
+
+  sharded_hash_table<int, int> ht3(1000, 16, WIDE, 42);
+  workers.clear();
+  for (int t = 0; t < 4; ++t) {
+    workers.push_back(std::thread([&ht3, t]() {
+      for (int i = 0; i < 5000; ++i)
+        ht3.insert((i << 10) + t, t);
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); ++t)
+    workers[t].join();
+  std::cout << "4 threads inserted 5000 keys with a stride of 1024 each";
+  std::cout << std::endl;
+  TEST_EQUAL(ht3.count(), 20000, "Table should have 20000 keys");
+  TEST_EQUAL(ht3.keys().size(), 20000, "keys should return 20000 keys");
+  TEST_EQUAL(ht3[(1234 << 10) + 3], 3, "Strided key should have its value");
+
+  test_util::print_summary();
+  return 0;
+}